@@ -0,0 +1,135 @@
+/*! ***************************************************************************
+ *
+ * \brief     ADC0 configuration shared by the analog sensors
+ * \file      adc.h
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef ADC_H
+#define ADC_H
+
+#include <MKL25Z4.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "ring.h"
+
+/*!
+ * \brief Definition for the counter clock of the scan timer in Hz
+ *
+ * The scan timer (TPM1) starts the conversions of the channels that are due.
+ * It counts at 48 MHz / 128 and the period of every channel must be a whole
+ * number of counts, so the rate of every channel must divide this clock.
+ */
+#define ADC_SCAN_CLOCK (48000000 / 128)
+
+/*!
+ * \brief Definition for the maximum number of channels in the scan list
+ */
+#define ADC_SCAN_MAX   (4)
+
+/*!
+ * \brief Definition for the magic number of the cached calibration
+ */
+#define ADC_CALIBRATION_MAGIC (0x41444330) // "ADC0"
+
+/*!
+ * \brief Definition for the number of calibration values of one side, CLx0
+ * to CLx4 and CLxS
+ */
+#define ADC_GAIN_VALUES (6)
+
+/// Result of the self-calibration of ADC0
+typedef struct
+{
+    uint16_t pg;   ///< Plus-side gain (PG)
+    uint16_t mg;   ///< Minus-side gain (MG)
+    uint16_t ofs;  ///< Offset correction (OFS)
+    bool cached;   ///< True if restored after a warm restart
+} adc_calibration_t;
+
+/// Number of conversions that the hardware averages into one result
+typedef enum
+{
+    ADC_AVERAGE_1 = 0, ///< Hardware averaging disabled
+    ADC_AVERAGE_4,     ///< 4 conversions per result
+    ADC_AVERAGE_8,     ///< 8 conversions per result
+    ADC_AVERAGE_16,    ///< 16 conversions per result
+    ADC_AVERAGE_32,    ///< 32 conversions per result
+} adc_average_t;
+
+/// Condition of the compare function for a conversion to complete
+typedef enum
+{
+    ADC_COMPARE_OFF = 0,       ///< Compare function disabled
+    ADC_COMPARE_LESS,          ///< Result is less than the compare value
+    ADC_COMPARE_GREATER_EQUAL, ///< Result is greater than or equal to the
+                               ///< compare value
+} adc_compare_t;
+
+/*!
+ * \brief Channel in the scan list
+ *
+ * The descriptor must remain valid while the scan is running.
+ */
+typedef struct
+{
+    uint8_t channel;        ///< Input channel (ADCH)
+    uint16_t rate;          ///< Conversions per second, divides ADC_SCAN_CLOCK
+    adc_average_t average;  ///< Hardware averaging of the conversions
+    ring_t *ring;           ///< Ring for the uint16_t results, or NULL
+
+    /// Called from the interrupt with every result, or NULL
+    void (*callback)(const uint16_t result, const TickType_t timestamp,
+                     BaseType_t *pxHigherPriorityTaskWoken);
+} adc_channel_t;
+
+/*!
+ * \brief Conversion complete handler of a driver that has claimed ADC0
+ *
+ * ADC0 is either used by the scan or claimed by a single driver, never both.
+ * In this example nothing claims ADC0, vIrTask() converts the TCRT5000
+ * through the scan.
+ */
+typedef void (*adc_handler_t)(BaseType_t *pxHigherPriorityTaskWoken);
+
+// Function prototypes
+void adc_init(void);
+bool adc_calibrate(void);
+bool adc_calibration(adc_calibration_t *calibration);
+uint16_t adc_gain(const uint16_t cl[ADC_GAIN_VALUES]);
+void adc_average(const adc_average_t average);
+void adc_compare(const adc_compare_t compare, const uint16_t value);
+
+bool adc_claim(adc_handler_t handler);
+
+bool adc_scan_add(const adc_channel_t *channel);
+bool adc_scan_start(void);
+uint32_t adc_scan_overruns(void);
+
+#endif // ADC_H
@@ -0,0 +1,323 @@
+/*! ***************************************************************************
+ *
+ * \brief     Flash sector erase and program driver
+ * \file      flash.c
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include "flash.h"
+
+#include <string.h>
+
+/// Flash commands written to FCCOB0
+#define FLASH_CMD_PROGRAM_LONGWORD (0x06)
+#define FLASH_CMD_ERASE_SECTOR     (0x09)
+
+// Local function prototypes
+static flash_status_t flash_command(const uint8_t command,
+                                    const uint32_t address,
+                                    const uint32_t data);
+static uint8_t flash_launch(void)
+    __attribute__((section(".ramfunc"), noinline, long_call));
+static const void *flash_ftfa_read(const uint32_t address);
+
+/*!
+ * \brief Program flash of the KL25Z, see flash_erase() and flash_program()
+ */
+const flash_t flash_ftfa =
+{
+    .erase = flash_erase,
+    .program = flash_program,
+    .read = flash_ftfa_read,
+};
+
+/*!
+ * \brief Erases a flash sector
+ *
+ * Interrupts are disabled until the erase has completed, which typically
+ * takes 14 ms and 114 ms at most. Call this only when the application can
+ * afford to miss interrupts for this long, e.g. when storing calibration
+ * data on request.
+ *
+ * \param[in]  address  Start address of the sector, aligned to
+ *                      FLASH_SECTOR_SIZE
+ *
+ * \return Result of the command
+ */
+flash_status_t flash_erase(const uint32_t address)
+{
+    if((address % FLASH_SECTOR_SIZE) != 0)
+    {
+        return FLASH_ALIGNMENT;
+    }
+
+    return flash_command(FLASH_CMD_ERASE_SECTOR, address, 0);
+}
+
+/*!
+ * \brief Programs longwords into erased flash
+ *
+ * Interrupts are disabled while each longword is programmed, which takes
+ * approximately 65 us.
+ *
+ * \param[in]  address  Destination address, aligned to 4 bytes
+ * \param[in]  data     Longwords to program
+ * \param[in]  n        Number of longwords
+ *
+ * \return Result of the first command that failed, or FLASH_OK
+ */
+flash_status_t flash_program(const uint32_t address, const uint32_t data[],
+                             const uint32_t n)
+{
+    if((address % 4) != 0)
+    {
+        return FLASH_ALIGNMENT;
+    }
+
+    for(uint32_t i=0; i<n; i++)
+    {
+        flash_status_t status = flash_command(FLASH_CMD_PROGRAM_LONGWORD,
+                                              address + (i * 4), data[i]);
+
+        if(status != FLASH_OK)
+        {
+            return status;
+        }
+    }
+
+    return FLASH_OK;
+}
+
+/*!
+ * \brief Calculates the CRC-32 (IEEE 802.3) of a block of data
+ *
+ * Used to validate records stored in flash. An erased sector reads as all
+ * 0xFF bytes, which does not match the CRC of any valid record.
+ *
+ * \param[in]  data  Data
+ * \param[in]  n     Number of bytes
+ *
+ * \return CRC-32 of the data
+ */
+uint32_t flash_crc32(const void *data, const uint32_t n)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t crc = 0xFFFFFFFF;
+
+    for(uint32_t i=0; i<n; i++)
+    {
+        crc ^= p[i];
+
+        for(uint32_t bit=0; bit<8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+
+    return ~crc;
+}
+
+/*!
+ * \brief Replaces the record in a flash sector
+ *
+ * Sets the size and the CRC of the record, erases the sector and programs
+ * the record. If the programming is interrupted, e.g. by a reset, the CRC
+ * of the partially programmed record doesn't match and
+ * flash_record_read() rejects it.
+ *
+ * \param[in]  flash    Flash memory
+ * \param[in]  address  Start address of the sector
+ * \param[in]  record   Record starting with a flash_record_t with the magic
+ *                      and the version set
+ * \param[in]  size     Size of the record, a multiple of 4 bytes
+ *
+ * \return Result of the first command that failed, or FLASH_OK
+ */
+flash_status_t flash_record_write(const flash_t *flash, const uint32_t address,
+                                  void *record, const uint32_t size)
+{
+    uint8_t *p = (uint8_t *)record;
+
+    if(((size % 4) != 0) || (size < (sizeof(flash_record_t) + 4)) ||
+       (size > FLASH_SECTOR_SIZE))
+    {
+        return FLASH_ALIGNMENT;
+    }
+
+    ((flash_record_t *)record)->size = (uint16_t)size;
+
+    uint32_t crc = flash_crc32(record, size - 4);
+    memcpy(&p[size - 4], &crc, 4);
+
+    flash_status_t status = flash->erase(address);
+
+    // The record doesn't need to be aligned, so it is programmed one
+    // longword at a time
+    for(uint32_t i=0; (i<size) && (status == FLASH_OK); i+=4)
+    {
+        uint32_t word;
+        memcpy(&word, &p[i], 4);
+
+        status = flash->program(address + i, &word, 1);
+    }
+
+    return status;
+}
+
+/*!
+ * \brief Reads a record from flash
+ *
+ * The stored record is only copied if its magic, version and size match the
+ * expected ones and its CRC is valid. An erased sector reads as all 0xFF
+ * bytes and is rejected.
+ *
+ * \param[in]     flash    Flash memory
+ * \param[in]     address  Start address of the sector
+ * \param[in,out] record   Record starting with a flash_record_t with the
+ *                         expected magic and version set
+ * \param[in]     size     Size of the record
+ *
+ * \return False if there is no valid record, the record is then not
+ * changed
+ */
+bool flash_record_read(const flash_t *flash, const uint32_t address,
+                       void *record, const uint32_t size)
+{
+    const flash_record_t *expected = (const flash_record_t *)record;
+    const uint8_t *stored = (const uint8_t *)flash->read(address);
+
+    flash_record_t header;
+    uint32_t crc;
+
+    if((size < (sizeof(flash_record_t) + 4)) || (size > FLASH_SECTOR_SIZE))
+    {
+        return false;
+    }
+
+    memcpy(&header, stored, sizeof(header));
+    memcpy(&crc, &stored[size - 4], 4);
+
+    if((header.magic != expected->magic) ||
+       (header.version != expected->version) ||
+       (header.size != size) ||
+       (crc != flash_crc32(stored, size - 4)))
+    {
+        return false;
+    }
+
+    memcpy(record, stored, size);
+
+    return true;
+}
+
+/*!
+ * \brief Returns a pointer to the program flash at an address
+ *
+ * The program flash is memory mapped, so it is read directly.
+ */
+static const void *flash_ftfa_read(const uint32_t address)
+{
+    return (const void *)(uintptr_t)address;
+}
+
+/*!
+ * \brief Executes a flash command
+ *
+ * \param[in]  command  Command for FCCOB0
+ * \param[in]  address  Flash address for FCCOB1..3
+ * \param[in]  data     Longword for FCCOB4..7, if used by the command
+ *
+ * \return Result of the command
+ */
+static flash_status_t flash_command(const uint8_t command,
+                                    const uint32_t address,
+                                    const uint32_t data)
+{
+    // Wait for a previous command to complete
+    while((FTFA->FSTAT & FTFA_FSTAT_CCIF_MASK) == 0)
+    {}
+
+    // Clear the error flags of a previous command
+    FTFA->FSTAT = FTFA_FSTAT_RDCOLERR_MASK | FTFA_FSTAT_ACCERR_MASK |
+        FTFA_FSTAT_FPVIOL_MASK;
+
+    FTFA->FCCOB0 = command;
+    FTFA->FCCOB1 = (uint8_t)(address >> 16);
+    FTFA->FCCOB2 = (uint8_t)(address >> 8);
+    FTFA->FCCOB3 = (uint8_t)(address);
+    FTFA->FCCOB4 = (uint8_t)(data >> 24);
+    FTFA->FCCOB5 = (uint8_t)(data >> 16);
+    FTFA->FCCOB6 = (uint8_t)(data >> 8);
+    FTFA->FCCOB7 = (uint8_t)(data);
+
+    // The flash can't be read while the command executes. Interrupts are
+    // disabled so that no vector or handler is fetched from flash, and the
+    // command is launched from RAM.
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    uint8_t fstat = flash_launch();
+
+    // The flash controller cache may hold the old contents
+    MCM->PLACR |= MCM_PLACR_CFCC_MASK;
+
+    __set_PRIMASK(primask);
+
+    if(fstat & FTFA_FSTAT_ACCERR_MASK)
+    {
+        return FLASH_ACCESS;
+    }
+
+    if(fstat & FTFA_FSTAT_FPVIOL_MASK)
+    {
+        return FLASH_PROTECTION;
+    }
+
+    if(fstat & FTFA_FSTAT_MGSTAT0_MASK)
+    {
+        return FLASH_VERIFY;
+    }
+
+    return FLASH_OK;
+}
+
+/*!
+ * \brief Launches the command in the FCCOB registers and waits for it to
+ * complete
+ *
+ * This function is placed in the .ramfunc section, which the startup code
+ * copies to RAM together with .data.
+ *
+ * \return The FSTAT register after the command has completed
+ */
+static uint8_t flash_launch(void)
+{
+    FTFA->FSTAT = FTFA_FSTAT_CCIF_MASK;
+
+    while((FTFA->FSTAT & FTFA_FSTAT_CCIF_MASK) == 0)
+    {}
+
+    return FTFA->FSTAT;
+}
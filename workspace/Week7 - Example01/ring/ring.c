@@ -0,0 +1,309 @@
+/*! ***************************************************************************
+ *
+ * \brief     Single-producer single-consumer ring
+ * \file      ring.c
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include "ring.h"
+
+#include <MKL25Z4.h>
+#include <string.h>
+
+// Local function prototypes
+static bool ring_put(ring_t *ring, const void *element,
+                     const TickType_t timestamp);
+
+/*!
+ * \brief Initialises a ring
+ *
+ * \param[out] ring          Ring
+ * \param[in]  elements      Storage for length elements
+ * \param[in]  timestamps    Storage for length timestamps
+ * \param[in]  element_size  Size of an element in bytes
+ * \param[in]  length        Number of elements, a power of two
+ *
+ * \return False if length is not a power of two
+ */
+bool ring_init(ring_t *ring, void *elements, TickType_t timestamps[],
+               const size_t element_size, const uint32_t length)
+{
+    if((length == 0) || ((length & (length - 1)) != 0))
+    {
+        return false;
+    }
+
+    ring->elements = (uint8_t *)elements;
+    ring->timestamps = timestamps;
+    ring->element_size = element_size;
+    ring->mask = length - 1;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->overruns = 0;
+    ring->policy = RING_DROP_NEWEST;
+    ring->task = NULL;
+    ring->bits = 0;
+    ring->watermark = 0;
+
+    return true;
+}
+
+/*!
+ * \brief Configures the notification of the consumer
+ *
+ * The bits are set in the notification value (index 0) of the task when
+ * a push makes the number of elements equal to the watermark. The consumer
+ * must drain the ring until ring_pop() returns fewer elements than
+ * requested, otherwise the watermark is not reached again. Call this
+ * function before the producer is started.
+ *
+ * \param[in]  ring       Ring
+ * \param[in]  task       Consumer task, or NULL for no notifications
+ * \param[in]  bits       Notification bits
+ * \param[in]  watermark  Number of elements, 1 to length
+ */
+void ring_notify(ring_t *ring, TaskHandle_t task, const uint32_t bits,
+                 const uint32_t watermark)
+{
+    ring->bits = bits;
+    ring->watermark = watermark;
+    ring->task = task;
+}
+
+/*!
+ * \brief Selects what a push does when the ring is full
+ *
+ * The default is RING_DROP_NEWEST. With RING_DROP_OLDEST the producer also
+ * moves the tail, so ring_pop() copies the elements with interrupts
+ * disabled and ring_push() adds an element with interrupts disabled. A ring
+ * with length 1 and RING_DROP_OLDEST holds the latest element only. Call
+ * this function before the producer is started.
+ *
+ * \param[in]  ring    Ring
+ * \param[in]  policy  Overrun policy
+ */
+void ring_policy(ring_t *ring, const ring_policy_t policy)
+{
+    ring->policy = policy;
+}
+
+/*!
+ * \brief Adds an element from an interrupt handler
+ *
+ * If the ring is full, an element is dropped according to the overrun
+ * policy and the overrun counter is incremented.
+ *
+ * \param[in]  ring                       Ring
+ * \param[in]  element                    Element to copy into the ring
+ * \param[in]  timestamp                  Timestamp of the element
+ * \param[out] pxHigherPriorityTaskWoken  Set to pdTRUE if the notified task
+ *                                        has a higher priority than the
+ *                                        interrupted task
+ *
+ * \return False if an element was dropped
+ */
+bool ring_push_from_isr(ring_t *ring, const void *element,
+                        const TickType_t timestamp,
+                        BaseType_t *pxHigherPriorityTaskWoken)
+{
+    bool stored = ring_put(ring, element, timestamp);
+
+    if((ring->task != NULL) && (ring_count(ring) == ring->watermark) &&
+       (stored || (ring->policy == RING_DROP_OLDEST)))
+    {
+        xTaskNotifyFromISR(ring->task, ring->bits, eSetBits,
+                           pxHigherPriorityTaskWoken);
+    }
+
+    return stored;
+}
+
+/*!
+ * \brief Adds an element from a task
+ *
+ * Same as ring_push_from_isr(), for a producer that is a task. With
+ * RING_DROP_OLDEST the element is added in a critical section, because the
+ * consumer can preempt the producer while it moves the tail.
+ *
+ * \param[in]  ring       Ring
+ * \param[in]  element    Element to copy into the ring
+ * \param[in]  timestamp  Timestamp of the element
+ *
+ * \return False if an element was dropped
+ */
+bool ring_push(ring_t *ring, const void *element, const TickType_t timestamp)
+{
+    bool stored;
+
+    // The tail that is moved by a RING_DROP_OLDEST push must not be written
+    // by the consumer in the meantime. An interrupt handler can't be
+    // preempted by the consumer, so ring_push_from_isr() doesn't need this.
+    if(ring->policy == RING_DROP_OLDEST)
+    {
+        taskENTER_CRITICAL();
+        stored = ring_put(ring, element, timestamp);
+        taskEXIT_CRITICAL();
+    }
+    else
+    {
+        stored = ring_put(ring, element, timestamp);
+    }
+
+    if((ring->task != NULL) && (ring_count(ring) == ring->watermark) &&
+       (stored || (ring->policy == RING_DROP_OLDEST)))
+    {
+        xTaskNotify(ring->task, ring->bits, eSetBits);
+    }
+
+    return stored;
+}
+
+/*!
+ * \brief Removes a batch of elements, oldest first
+ *
+ * \param[in]  ring        Ring
+ * \param[out] elements    Storage for n elements
+ * \param[out] timestamps  Storage for n timestamps, or NULL
+ * \param[in]  n           Maximum number of elements
+ *
+ * \return Number of elements removed
+ */
+uint32_t ring_pop(ring_t *ring, void *elements, TickType_t timestamps[],
+                  const uint32_t n)
+{
+    uint8_t *dst = (uint8_t *)elements;
+
+    // With RING_DROP_OLDEST the producer can move the tail and overwrite the
+    // oldest elements while they are copied
+    const bool locked = (ring->policy == RING_DROP_OLDEST);
+
+    if(locked)
+    {
+        taskENTER_CRITICAL();
+    }
+
+    uint32_t tail = ring->tail;
+    uint32_t count = ring->head - tail;
+
+    if(count > n)
+    {
+        count = n;
+    }
+
+    // Read head before the elements it publishes, see ring_put()
+    __DMB();
+
+    for(uint32_t i=0; i<count; i++)
+    {
+        uint32_t index = (tail + i) & ring->mask;
+
+        memcpy(&dst[i * ring->element_size],
+               &ring->elements[index * ring->element_size],
+               ring->element_size);
+
+        if(timestamps != NULL)
+        {
+            timestamps[i] = ring->timestamps[index];
+        }
+    }
+
+    // Release the slots after the elements have been copied
+    __DMB();
+    ring->tail = tail + count;
+
+    if(locked)
+    {
+        taskEXIT_CRITICAL();
+    }
+
+    return count;
+}
+
+/*!
+ * \brief Returns the number of elements in the ring
+ *
+ * \param[in]  ring  Ring
+ *
+ * \return Number of elements
+ */
+uint32_t ring_count(const ring_t *ring)
+{
+    return ring->head - ring->tail;
+}
+
+/*!
+ * \brief Returns the number of elements dropped because the ring was full,
+ * either new or old elements depending on the overrun policy
+ *
+ * \param[in]  ring  Ring
+ *
+ * \return Number of elements dropped since ring_init()
+ */
+uint32_t ring_overruns(const ring_t *ring)
+{
+    return ring->overruns;
+}
+
+/*!
+ * \brief Copies an element into the ring and publishes it
+ *
+ * \param[in]  ring       Ring
+ * \param[in]  element    Element to copy into the ring
+ * \param[in]  timestamp  Timestamp of the element
+ *
+ * \return False if the ring was full and an element was dropped
+ */
+static bool ring_put(ring_t *ring, const void *element,
+                     const TickType_t timestamp)
+{
+    uint32_t head = ring->head;
+    bool stored = true;
+
+    if((head - ring->tail) > ring->mask)
+    {
+        ring->overruns++;
+        stored = false;
+
+        if(ring->policy == RING_DROP_NEWEST)
+        {
+            return false;
+        }
+
+        // Drop the oldest element. Its slot is the one that is written next.
+        ring->tail = ring->tail + 1;
+    }
+
+    uint32_t index = head & ring->mask;
+
+    memcpy(&ring->elements[index * ring->element_size], element,
+           ring->element_size);
+    ring->timestamps[index] = timestamp;
+
+    // The element must be written before the consumer can see the new head
+    __DMB();
+    ring->head = head + 1;
+
+    return stored;
+}
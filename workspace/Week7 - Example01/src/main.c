@@ -41,6 +41,7 @@
 #include "task.h"
 #include "timers.h"
 
+#include "adc.h"
 #include "leds.h"
 #include "rgb.h"
 #include "rtc.h"
@@ -48,6 +49,7 @@
 #include "serial.h"
 #include "switches.h"
 #include "tcrt5000.h"
+#include "tsi.h"
 
 /*----------------------------------------------------------------------------*/
 // Local defines
@@ -56,6 +58,10 @@
 #define mainN_SLOTS        (20)
 #define mainSLOT_MS        (mainTOTAL_CYCLE_MS / mainN_SLOTS)
 
+// Conversions per second of the TCRT5000 in the ADC scan. vIrTask() waits at
+// most one period for the next conversion.
+#define mainIR_SCAN_RATE   (1000)
+
 /*----------------------------------------------------------------------------*/
 // Local type definitions
 /*----------------------------------------------------------------------------*/
@@ -72,6 +78,9 @@ static void vLedOnTask(void *parameters);
 static void vLedOffTask(void *parameters);
 static void vOledTask(void *parameters);
 static void vIrTask(void *parameters);
+static void vIrConversion(const uint16_t result, const TickType_t timestamp,
+                          BaseType_t *pxHigherPriorityTaskWoken);
+static uint16_t usIrConvert(void);
 static void vDtTask(void *parameters);
 static void vSwTask(void *parameters);
 static void vTsiTask(void *parameters);
@@ -95,6 +104,16 @@ static TaskHandle_t vCmdTaskHandle;
 
 static volatile uint32_t ulRunningTaskNum = 0;
 
+// TCRT5000 output (channel 8) in the scan of the ADC library
+static const adc_channel_t xIrChannel =
+{
+    .channel = 8,
+    .rate = mainIR_SCAN_RATE,
+    .average = ADC_AVERAGE_1,
+    .ring = NULL,
+    .callback = vIrConversion,
+};
+
 extern uint8_t FreeRTOSDebugConfig[];
 
 /*----------------------------------------------------------------------------*/
@@ -114,6 +133,7 @@ int main(void)
     tcrt5000_init();
     rtc_init();
     sw_init();
+    tsi_init(mainSLOT_MS);
     xSerialPortInit(921600, 128);
 
     rtc_datetime_t datetime;
@@ -143,6 +163,11 @@ int main(void)
     xTaskCreate(vTsiTask,    "vTsiTask",      configMINIMAL_STACK_SIZE, NULL, 1, &vTsiTaskHandle);
     xTaskCreate(vCmdTask,    "vCmdTask",      configMINIMAL_STACK_SIZE, NULL, 1, &vCmdTaskHandle);
 
+    // The conversions are passed to vIrTask(), so start the scan after the
+    // task is created
+    adc_scan_add(&xIrChannel);
+    adc_scan_start();
+
     xOledMutex = xSemaphoreCreateMutex();
     xRtcOneSecondSemaphore = xSemaphoreCreateBinary();
     xRtcAlarmSemaphore = xSemaphoreCreateBinary();
@@ -296,18 +321,8 @@ static void vIrTask(void *parameters)
 
         // Do work
 
-        // - AIEN = 0     : Conversion complete interrupt is disabled
-        // - DIFF = 0     : Single-ended conversions and input channels are
-        //                  selected
-        // - ADCH = 01000 : Channel 8
-        ADC0->SC1[0] = ADC_SC1_ADCH(8);
-
-        // Wait for conversion to complete
-        while(!(ADC0->SC1[0] & ADC_SC1_COCO_MASK))
-        {;}
-
         // Read the result and complement
-        uint16_t off_brightness = 0xFFFF - ADC0->R[0];
+        uint16_t off_brightness = 0xFFFF - usIrConvert();
 
         // IR LED on
         PTA->PCOR = (1<<16);
@@ -315,18 +330,8 @@ static void vIrTask(void *parameters)
         // Delay to settle down the signal
         vTaskDelay(pdMS_TO_TICKS(1));
 
-        // - AIEN = 0     : Conversion complete interrupt is disabled
-        // - DIFF = 0     : Single-ended conversions and input channels are
-        //                  selected
-        // - ADCH = 01000 : Channel 8
-        ADC0->SC1[0] = ADC_SC1_ADCH(8);
-
-        // Wait for conversion to complete
-        while(!(ADC0->SC1[0] & ADC_SC1_COCO_MASK))
-        {;}
-
         // Read the result and complement
-        uint16_t on_brightness = 0xFFFF - ADC0->R[0];
+        uint16_t on_brightness = 0xFFFF - usIrConvert();
 
         // IR LED off
         PTA->PSOR = (1<<16);
@@ -346,6 +351,31 @@ static void vIrTask(void *parameters)
 
 /*----------------------------------------------------------------------------*/
 
+// Called from the ADC0 interrupt with every conversion of the scan
+static void vIrConversion(const uint16_t result, const TickType_t timestamp,
+                          BaseType_t *pxHigherPriorityTaskWoken)
+{
+    xTaskNotifyFromISR(vIrTaskHandle, result, eSetValueWithOverwrite,
+                       pxHigherPriorityTaskWoken);
+}
+
+/*----------------------------------------------------------------------------*/
+
+// Blocks until the next conversion of the TCRT5000, at most one scan period.
+// A conversion that completed before the call is discarded, so the result
+// reflects the current state of the IR LED.
+static uint16_t usIrConvert(void)
+{
+    uint32_t result;
+
+    xTaskNotifyStateClear(NULL);
+    xTaskNotifyWait(0, 0, &result, portMAX_DELAY);
+
+    return (uint16_t)result;
+}
+
+/*----------------------------------------------------------------------------*/
+
 static void vDtTask(void *pvParameters)
 {
     rtc_datetime_t datetime;
@@ -432,125 +462,49 @@ static void vTsiTask(void *parameters)
     const command_t command_up = UP;
     const command_t command_down = DOWN;
 
-    TickType_t xLastWakeTime = xTaskGetTickCount();
-    vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(8 * mainSLOT_MS));
-
-    // Enable PTB clock
-    SIM->SCGC5 |= SIM_SCGC5_PORTB_MASK;
-
-    // Set pin to FTM
-    // PTB16: TSI0_CH9, Mux Alt 0 (default)
-    // PTB17: TSI0_CH10, Mux Alt 0 (default)
-    PORTB->PCR[16] &= ~PORT_PCR_MUX_MASK;
-    PORTB->PCR[16] |= PORT_PCR_MUX(0);
-    PORTB->PCR[17] &= ~PORT_PCR_MUX_MASK;
-    PORTB->PCR[17] |= PORT_PCR_MUX(0);
-
-    // Enable TSI Clock
-    SIM->SCGC5 |= SIM_SCGC5_TSI_MASK;
-
-    // Setup general control and status register
-    // - OUTRGF : 1 - Clear Out-of-range flag
-    // - ESOR   : 0 - Out-of-range interrupt is allowed (default)
-    // - MODE   : 0000 - Set TSI in capacitive sensing(non-noise detection) mode
-    //                   (default)
-    // - REFCHRG: 000 - 500 nA reference oscillator charge and discharge current
-    //                  value (default)
-    // - DVOLT  : 00 - DV = 1.03 V; V P = 1.33 V; V m = 0.30 V oscillator's
-    //                 voltage rails (default)
-    // - EXTCHRG: 000 - 500 nA electrode oscillator charge and discharge current
-    //                  (default)
-    // - PS     : 0 - Electrode Oscillator Frequency divided by 1 prescaler
-    //                (default)
-    // - NSCN   : 11111 - 32 scans for each electrode
-    // - TSIEN  : 1 - TSI module enabled
-    // - TSIIEN : 0 - TSI interrupt is disabled (default)
-    // - STPE   : 1 - Allow TSI to continue running in all low power modes
-    // - STM    : 0 - Software trigger scan (default)
-    // - SCNIP  : n/a
-    // - EOSF   : 1 - Clear scan complete flag
-    // - CURSW  : 0 - The current source pair are not swapped (default)
-    TSI0->GENCS =
-        TSI_GENCS_OUTRGF(1) |
-        TSI_GENCS_NSCN(31) |
-        TSI_GENCS_TSIEN(1) |
-        TSI_GENCS_STPE(1) |
-        TSI_GENCS_EOSF(1);
-
-    uint32_t channel09_result;
-    uint32_t channel10_result;
+    tsi_event_t event;
+
+    // Position of the previous touch or move event
+    int16_t position = 0;
 
     /* As per most tasks, this task is implemented in an infinite loop. */
     for( ;; )
     {
+        // Wait for the next slider event. The TSI driver measures the slider
+        // every mainSLOT_MS ms and tracks the baseline and thresholds, so
+        // this task only wakes up when the slider is touched, moved or
+        // released.
+        if(!tsi_event(&event, portMAX_DELAY))
+        {
+            continue;
+        }
+
         // For debugging: show info
-        sprintf(str, "% 7u | %s\r\n", xLastWakeTime, __func__);
+        sprintf(str, "% 7u | %s\r\n", event.timestamp, __func__);
         vSerialPutString(str);
 
-        // ------------------------------------------------------------------------
-        // Scan channel 9
-        // ------------------------------------------------------------------------
-
-        // Select channel 9
-        TSI0->DATA = TSI_DATA_TSICH(9);
-
-        // Start a scan
-        TSI0->DATA |= TSI_DATA_SWTS_MASK;
-
-        // Wait for scan complete
-        while(!(TSI0->GENCS & TSI_GENCS_EOSF_MASK))
-        {;}
-
-        // Read TSI Conversion Counter Value, masking all other bits
-        channel09_result = TSI0->DATA & TSI_DATA_TSICNT_MASK;
-
-        // Clear scan complete flag
-        TSI0->GENCS |= TSI_GENCS_EOSF_MASK;
-
-        // Wait some time before sampling the next channel
-        vTaskDelay(pdMS_TO_TICKS(1));
-
-        // ------------------------------------------------------------------------
-        // Scan channel 10
-        // ------------------------------------------------------------------------
-
-        // Select channel 10
-        TSI0->DATA = TSI_DATA_TSICH(10);
-
-        // Start a scan
-        TSI0->DATA |= TSI_DATA_SWTS_MASK;
-
-        // Wait for scan complete
-        while(!(TSI0->GENCS & TSI_GENCS_EOSF_MASK))
-        {;}
-
-        // Read TSI Conversion Counter Value, masking all other bits
-        channel10_result = TSI0->DATA & TSI_DATA_TSICNT_MASK;
-
-        // Clear scan complete flag
-        TSI0->GENCS |= TSI_GENCS_EOSF_MASK;
-
-        // ------------------------------------------------------------------------
-        // Calculate the scan results
-        // ------------------------------------------------------------------------
-        // The variables channel09_result and channel10_result now hold the
-        // accumulated scan counter values (32 scans as set by TSI_GENCS_NSCN).
-        // The following threshold value is determined by using the debugger.
-        const uint32_t threshold = 0x00000380;
-
-        // Send command according the scan results
-        if(channel09_result > threshold)
+        // Touching the lower half of the slider is down, the upper half is
+        // up. Sliding sends a command in the direction of the movement
+        // since the previous event. The velocity is not used for this,
+        // because it is averaged and can still have the sign of an earlier
+        // movement after the direction is reversed.
+        if(event.type == TSI_EVENT_TOUCH)
         {
-            xQueueSend(xCmdQueue, &command_down, pdMS_TO_TICKS(10));
-        }
+            xQueueSend(xCmdQueue,
+                       (event.position < TSI_SLIDER_MAX / 2) ? &command_down : &command_up,
+                       pdMS_TO_TICKS(10));
 
-        if(channel10_result > threshold)
+            position = event.position;
+        }
+        else if(event.type == TSI_EVENT_MOVE)
         {
-            xQueueSend(xCmdQueue, &command_up, pdMS_TO_TICKS(10));
+            xQueueSend(xCmdQueue,
+                       (event.position < position) ? &command_down : &command_up,
+                       pdMS_TO_TICKS(10));
+
+            position = event.position;
         }
 
-        // Go into Blocking state for one cycle total time
-        vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(mainTOTAL_CYCLE_MS / 2));
         ulRunningTaskNum = 9;
     }
 }
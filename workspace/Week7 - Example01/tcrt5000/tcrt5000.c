@@ -40,7 +40,9 @@ TaskHandle_t xADCTaskHandle;
  * This functions initializes the TCRT5000 on the shield.
  * - PTA16 is configured as an output pin
  * - PTB0 is configured as an analog input (ADC channel 8)
- * - TPM1 is configured to trigger an ADC conversion every 50 ms
+ *
+ * ADC0 is configured by the ADC library. The application adds channel 8 to
+ * the scan, see adc_scan_add().
  */
 void tcrt5000_init(void)
 {
@@ -61,25 +63,4 @@ void tcrt5000_init(void)
     // The output of the transistor is connected to PTB0. Configure the pin as
     // ADC input pin (channel 8).
     PORTB->PCR[0] &= ~0x7FF;
-
-    // ------------------------------------------------------------------------
-
-    // Enable clock to ADC0
-    SIM->SCGC6 |= SIM_SCGC6_ADC0(1);
-
-    // Configure ADC
-    // - ADLPC = 1        : Low-power configuration. The power is reduced at
-    //                      the expense of maximum clock speed.
-    // - ADIV[1:0] = 00   : The divide ratio is 1 and the clock rate is input
-    //                      clock.
-    // - ADLSMP = 1       : Long sample time.
-    // - MODE[1:0] = 11   : Single-ended 16-bit conversion
-    // - ADICLK[1:0] = 01 : (Bus clock)/2
-    ADC0->CFG1 = 0x9D;
-
-    // - ADTRG = 0   : Software trigger selected
-    // - ACFE  = 0   : Compare function disabled
-    // - DMAEN = 0   : DMA is disabled
-    // - REFSEL = 00 : Default voltage reference pin pair
-    ADC0->SC2 = 0;
 }
@@ -0,0 +1,464 @@
+/*! ***************************************************************************
+ *
+ * \brief     Interrupt driven touch sensing input (TSI) driver
+ * \file      tsi.c
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include "tsi.h"
+
+/*----------------------------------------------------------------------------*/
+// Local variables
+/*----------------------------------------------------------------------------*/
+
+// PTB16: TSI0_CH9, PTB17: TSI0_CH10
+static const uint8_t channel_mapping[N_TSI_CHANNELS] = {9, 10};
+static const uint8_t pin_mapping[N_TSI_CHANNELS]     = {16, 17};
+
+// Holds the latest measurement, written by the interrupt handler
+static QueueHandle_t xTsiQueue;
+
+// Slider events, written by the interrupt handler
+static QueueHandle_t xTsiEventQueue;
+
+// Baseline and average noise of every electrode in counts with 4 fractional
+// bits, so the slow filters don't lose the small differences
+static int32_t baseline[N_TSI_CHANNELS];
+static int32_t noise[N_TSI_CHANNELS];
+static uint32_t baseline_samples = 0;
+
+// State of the slider
+static bool touched = false;
+static int32_t position = 0;
+static int32_t reported_position = 0;
+static int32_t velocity = 0;
+static TickType_t last_timestamp = 0;
+
+// Measurement that is in progress
+static tsi_result_t result;
+static uint32_t current = 0;
+static bool periodic = false;
+
+// Local function prototypes
+static void tsi_process(const tsi_result_t *r, BaseType_t *pxHigherPriorityTaskWoken);
+static int32_t tsi_threshold_q4(const uint32_t channel);
+static void tsi_publish(const tsi_event_type_t type, const TickType_t timestamp,
+                        BaseType_t *pxHigherPriorityTaskWoken);
+
+/*!
+ * \brief Initialises the TSI
+ *
+ * This functions initializes the TSI for the slider on the FRDM-KL25Z. The
+ * end-of-scan interrupt handles the electrodes one after the other, so the
+ * CPU doesn't wait for a scan to complete.
+ *
+ * If period_ms is not 0, the scans are triggered by the hardware. LPTMR0
+ * triggers a scan of the next electrode every period_ms / N_TSI_CHANNELS
+ * ms, so every electrode is measured once per period_ms ms without any
+ * software involvement. If period_ms is 0, a measurement is started by
+ * calling tsi_scan().
+ *
+ * Every completed measurement replaces the previous one, which is read with
+ * tsi_read(). The measurements are also processed in the interrupt handler
+ * into slider events, which are read with tsi_event(). The first
+ * TSI_BASELINE_INIT measurements determine the baseline, so the slider must
+ * not be touched at that time.
+ *
+ * \param[in]  period_ms  Period of the measurements in ms, a multiple of
+ *                        N_TSI_CHANNELS, or 0 for software triggered scans
+ */
+void tsi_init(const uint32_t period_ms)
+{
+    xTsiQueue = xQueueCreate(1, sizeof(tsi_result_t));
+    vQueueAddToRegistry(xTsiQueue, "xTsiQueue");
+
+    xTsiEventQueue = xQueueCreate(TSI_EVENT_QUEUE_LENGTH, sizeof(tsi_event_t));
+    vQueueAddToRegistry(xTsiEventQueue, "xTsiEventQueue");
+
+    for(int i=0; i<N_TSI_CHANNELS; i++)
+    {
+        baseline[i] = 0;
+        noise[i] = 0;
+    }
+
+    baseline_samples = 0;
+    touched = false;
+
+    periodic = (period_ms > 0);
+    current = 0;
+
+    // Enable PTB clock
+    SIM->SCGC5 |= SIM_SCGC5_PORTB_MASK;
+
+    // Set pins to TSI, Mux Alt 0 (default)
+    for(int i=0; i<N_TSI_CHANNELS; i++)
+    {
+        PORTB->PCR[pin_mapping[i]] &= ~PORT_PCR_MUX_MASK;
+        PORTB->PCR[pin_mapping[i]] |= PORT_PCR_MUX(0);
+    }
+
+    // Enable TSI Clock
+    SIM->SCGC5 |= SIM_SCGC5_TSI_MASK;
+
+    // Setup general control and status register
+    // - OUTRGF : 1 - Clear Out-of-range flag
+    // - ESOR   : 1 - End-of-scan interrupt is allowed
+    // - MODE   : 0000 - Set TSI in capacitive sensing(non-noise detection) mode
+    //                   (default)
+    // - REFCHRG: 000 - 500 nA reference oscillator charge and discharge current
+    //                  value (default)
+    // - DVOLT  : 00 - DV = 1.03 V; V P = 1.33 V; V m = 0.30 V oscillator's
+    //                 voltage rails (default)
+    // - EXTCHRG: 000 - 500 nA electrode oscillator charge and discharge current
+    //                  (default)
+    // - PS     : 0 - Electrode Oscillator Frequency divided by 1 prescaler
+    //                (default)
+    // - NSCN   : TSI_SCANS - 1 scans for each electrode
+    // - TSIEN  : 1 - TSI module enabled
+    // - TSIIEN : 1 - TSI interrupt is enabled
+    // - STPE   : 1 - Allow TSI to continue running in all low power modes
+    // - STM    : 0 - Software trigger scan, 1 - Hardware trigger scan
+    // - SCNIP  : n/a
+    // - EOSF   : 1 - Clear scan complete flag
+    // - CURSW  : 0 - The current source pair are not swapped (default)
+    TSI0->GENCS =
+        TSI_GENCS_OUTRGF(1) |
+        TSI_GENCS_ESOR(1) |
+        TSI_GENCS_NSCN(TSI_SCANS - 1) |
+        TSI_GENCS_TSIEN(1) |
+        TSI_GENCS_TSIIEN(1) |
+        TSI_GENCS_STPE(1) |
+        TSI_GENCS_STM(periodic ? 1 : 0) |
+        TSI_GENCS_EOSF(1);
+
+    // Select the first electrode
+    TSI0->DATA = TSI_DATA_TSICH(channel_mapping[0]);
+
+    // Enable the interrupt in the NVIC
+    NVIC_SetPriority(TSI0_IRQn, 128);
+    NVIC_ClearPendingIRQ(TSI0_IRQn);
+    NVIC_EnableIRQ(TSI0_IRQn);
+
+    if(periodic)
+    {
+        // The LPTMR0 compare event is the hardware trigger of the TSI
+
+        // Clock to LPTMR0 on
+        SIM->SCGC5 |= SIM_SCGC5_LPTMR_MASK;
+
+        // Disable the timer while it is configured
+        LPTMR0->CSR = 0;
+
+        // - PCS  : 01 - LPO 1 kHz clock
+        // - PBYP : 1  - Prescaler bypassed, the counter increments every ms
+        LPTMR0->PSR = LPTMR_PSR_PCS(1) | LPTMR_PSR_PBYP(1);
+
+        // One scan per electrode per period
+        LPTMR0->CMR = (period_ms / N_TSI_CHANNELS) - 1;
+
+        // - TMS = 0 : Time counter mode
+        // - TFC = 0 : Counter is reset when TCF is set
+        // - TIE = 0 : Timer interrupt disabled
+        // - TEN = 1 : Timer enabled
+        LPTMR0->CSR = LPTMR_CSR_TEN(1);
+    }
+}
+
+/*!
+ * \brief Starts a measurement of all electrodes
+ *
+ * Only used if the TSI is initialised without a period. The function returns
+ * immediately, the result is read with tsi_read(). A call while a
+ * measurement is in progress is ignored.
+ */
+void tsi_scan(void)
+{
+    if(periodic || (TSI0->GENCS & TSI_GENCS_SCNIP_MASK) || (current != 0))
+    {
+        return;
+    }
+
+    // Start a scan of the first electrode
+    TSI0->DATA = TSI_DATA_TSICH(channel_mapping[0]) | TSI_DATA_SWTS(1);
+}
+
+/*!
+ * \brief Reads the latest measurement
+ *
+ * Blocks the calling task until a measurement is available or the timeout
+ * expires. A measurement is read only once.
+ *
+ * \param[out] result   Measurement
+ * \param[in]  timeout  Maximum time to wait in ticks
+ *
+ * \return True if a measurement was read, false if the timeout expired
+ */
+bool tsi_read(tsi_result_t *result, const TickType_t timeout)
+{
+    return (xQueueReceive(xTsiQueue, result, timeout) == pdPASS);
+}
+
+/*!
+ * \brief Reads the next slider event
+ *
+ * Blocks the calling task until an event is available or the timeout
+ * expires. If the task doesn't keep up, new events are dropped when the
+ * queue is full.
+ *
+ * \param[out] event    Event
+ * \param[in]  timeout  Maximum time to wait in ticks
+ *
+ * \return True if an event was read, false if the timeout expired
+ */
+bool tsi_event(tsi_event_t *event, const TickType_t timeout)
+{
+    return (xQueueReceive(xTsiEventQueue, event, timeout) == pdPASS);
+}
+
+/*!
+ * \brief Returns the baseline of an electrode
+ *
+ * \param[in]  channel  Electrode, 0 to N_TSI_CHANNELS - 1
+ *
+ * \return Baseline in counts, 0 until the initial baseline is determined
+ */
+uint16_t tsi_baseline(const uint32_t channel)
+{
+    if((channel >= N_TSI_CHANNELS) || (baseline_samples < TSI_BASELINE_INIT))
+    {
+        return 0;
+    }
+
+    return (uint16_t)(baseline[channel] >> 4);
+}
+
+/*!
+ * \brief Returns the touch threshold of an electrode
+ *
+ * \param[in]  channel  Electrode, 0 to N_TSI_CHANNELS - 1
+ *
+ * \return Difference from the baseline in counts that is a touch
+ */
+uint16_t tsi_threshold(const uint32_t channel)
+{
+    if(channel >= N_TSI_CHANNELS)
+    {
+        return 0;
+    }
+
+    return (uint16_t)(tsi_threshold_q4(channel) >> 4);
+}
+
+/*!
+ * \brief Returns the touch threshold of an electrode, with 4 fractional bits
+ */
+static int32_t tsi_threshold_q4(const uint32_t channel)
+{
+    int32_t threshold = noise[channel] * TSI_NOISE_FACTOR;
+
+    return (threshold > (TSI_DELTA_MIN << 4)) ? threshold : (TSI_DELTA_MIN << 4);
+}
+
+/*!
+ * \brief Sends a slider event with the current position and velocity
+ */
+static void tsi_publish(const tsi_event_type_t type, const TickType_t timestamp,
+                        BaseType_t *pxHigherPriorityTaskWoken)
+{
+    tsi_event_t event =
+    {
+        .type = type,
+        .position = (int16_t)position,
+        .velocity = (int16_t)velocity,
+        .timestamp = timestamp,
+    };
+
+    xQueueSendFromISR(xTsiEventQueue, &event, pxHigherPriorityTaskWoken);
+}
+
+/*!
+ * \brief Processes a measurement into slider events
+ *
+ * Called from the interrupt handler after every measurement.
+ *
+ * - The difference of every electrode from its baseline is compared with
+ *   its threshold. The slider is touched when an electrode exceeds its
+ *   threshold and released when all electrodes are below half of it.
+ * - While the slider is not touched, the baseline follows the measurements
+ *   slowly and the threshold adapts to the average noise. A measurement
+ *   below the baseline, e.g. after a touch during the initial baseline,
+ *   is followed faster.
+ * - While the slider is touched, the position is the centroid of the
+ *   differences and the velocity is derived from consecutive positions.
+ *
+ * \param[in]  r                          Measurement
+ * \param[out] pxHigherPriorityTaskWoken  Set if a task must be yielded to
+ */
+static void tsi_process(const tsi_result_t *r, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    // Initial baseline
+    if(baseline_samples < TSI_BASELINE_INIT)
+    {
+        for(uint32_t i=0; i<N_TSI_CHANNELS; i++)
+        {
+            baseline[i] += r->counts[i];
+        }
+
+        if(++baseline_samples == TSI_BASELINE_INIT)
+        {
+            for(uint32_t i=0; i<N_TSI_CHANNELS; i++)
+            {
+                baseline[i] = (baseline[i] << 4) / TSI_BASELINE_INIT;
+                noise[i] = 0;
+            }
+        }
+
+        return;
+    }
+
+    int32_t delta[N_TSI_CHANNELS];
+    bool above = false;
+    bool below_half = true;
+
+    for(uint32_t i=0; i<N_TSI_CHANNELS; i++)
+    {
+        const int32_t threshold = tsi_threshold_q4(i);
+
+        delta[i] = ((int32_t)r->counts[i] << 4) - baseline[i];
+
+        above |= (delta[i] > threshold);
+        below_half &= (delta[i] < (threshold / 2));
+    }
+
+    const bool was_touched = touched;
+    touched = was_touched ? !below_half : above;
+
+    if(!touched)
+    {
+        for(uint32_t i=0; i<N_TSI_CHANNELS; i++)
+        {
+            const int32_t shift = (delta[i] < 0) ? 2 : TSI_BASELINE_SHIFT;
+            const int32_t magnitude = (delta[i] < 0) ? -delta[i] : delta[i];
+
+            baseline[i] += delta[i] >> shift;
+            noise[i] += (magnitude - noise[i]) >> 4;
+        }
+
+        if(was_touched)
+        {
+            velocity = 0;
+            tsi_publish(TSI_EVENT_RELEASE, r->timestamp, pxHigherPriorityTaskWoken);
+        }
+
+        return;
+    }
+
+    // Centroid of the positive differences. Electrode i is at position
+    // i * TSI_SLIDER_MAX / (N_TSI_CHANNELS - 1).
+    int32_t sum = 0;
+    int32_t weighted = 0;
+
+    for(uint32_t i=0; i<N_TSI_CHANNELS; i++)
+    {
+        if(delta[i] > 0)
+        {
+            sum += delta[i];
+            weighted += delta[i] * (int32_t)i;
+        }
+    }
+
+    const int32_t new_position = (weighted * TSI_SLIDER_MAX) /
+                                 (sum * (N_TSI_CHANNELS - 1));
+
+    if(!was_touched)
+    {
+        position = new_position;
+        reported_position = new_position;
+        velocity = 0;
+        tsi_publish(TSI_EVENT_TOUCH, r->timestamp, pxHigherPriorityTaskWoken);
+    }
+    else
+    {
+        // Velocity in position units per second, smoothed over two
+        // measurements
+        const TickType_t ticks = r->timestamp - last_timestamp;
+
+        if(ticks > 0)
+        {
+            const int32_t v = ((new_position - position) * (int32_t)configTICK_RATE_HZ) /
+                              (int32_t)ticks;
+            velocity = (velocity + v) / 2;
+        }
+
+        position = new_position;
+
+        const int32_t moved = position - reported_position;
+
+        if((moved >= TSI_MOVE_STEP) || (moved <= -TSI_MOVE_STEP))
+        {
+            reported_position = position;
+            tsi_publish(TSI_EVENT_MOVE, r->timestamp, pxHigherPriorityTaskWoken);
+        }
+    }
+
+    last_timestamp = r->timestamp;
+}
+
+void TSI0_IRQHandler(void)
+{
+    // Clear pending interrupt
+    NVIC_ClearPendingIRQ(TSI0_IRQn);
+
+    // Clear scan complete flag
+    TSI0->GENCS |= TSI_GENCS_EOSF_MASK;
+
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    // Read TSI Conversion Counter Value, masking all other bits
+    result.counts[current] = (uint16_t)(TSI0->DATA & TSI_DATA_TSICNT_MASK);
+
+    if(++current < N_TSI_CHANNELS)
+    {
+        // Select the next electrode. In software trigger mode the scan is
+        // started immediately, otherwise at the next hardware trigger.
+        TSI0->DATA = TSI_DATA_TSICH(channel_mapping[current]) |
+                     TSI_DATA_SWTS(periodic ? 0 : 1);
+    }
+    else
+    {
+        current = 0;
+
+        // Select the first electrode for the next measurement
+        TSI0->DATA = TSI_DATA_TSICH(channel_mapping[0]);
+
+        // Replace the previous measurement, if it hasn't been read
+        result.timestamp = xTaskGetTickCountFromISR();
+        xQueueOverwriteFromISR(xTsiQueue, &result, &xHigherPriorityTaskWoken);
+
+        tsi_process(&result, &xHigherPriorityTaskWoken);
+    }
+
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
@@ -0,0 +1,104 @@
+/*! ***************************************************************************
+ *
+ * \brief     Interrupt driven touch sensing input (TSI) driver
+ * \file      tsi.h
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef TSI_H
+#define TSI_H
+
+#include <MKL25Z4.h>
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+#include "queue.h"
+
+/// The number of electrodes of the slider on the FRDM-KL25Z
+#define N_TSI_CHANNELS (2)
+
+/// Number of scans that are accumulated in a measurement, 1 to 32
+#define TSI_SCANS      (32)
+
+/// Number of measurements that are averaged into the initial baseline. The
+/// slider must not be touched during these measurements.
+#define TSI_BASELINE_INIT   (8)
+
+/// Weight of a measurement in the baseline is 1 / 2^TSI_BASELINE_SHIFT, so
+/// the baseline follows slow drift caused by temperature and humidity
+#define TSI_BASELINE_SHIFT  (6)
+
+/// Minimum difference from the baseline in counts for a touch
+#define TSI_DELTA_MIN       (64)
+
+/// The touch threshold is at least TSI_NOISE_FACTOR times the average
+/// noise of an electrode
+#define TSI_NOISE_FACTOR    (4)
+
+/// Position of the slider at electrode N_TSI_CHANNELS - 1. The position at
+/// the first electrode (channel 9) is 0.
+#define TSI_SLIDER_MAX      (100)
+
+/// Minimum change of the position for a TSI_EVENT_MOVE
+#define TSI_MOVE_STEP       (2)
+
+/// Number of events the event queue can hold
+#define TSI_EVENT_QUEUE_LENGTH (8)
+
+/// Types of slider events
+typedef enum
+{
+    TSI_EVENT_TOUCH = 0, ///< Slider is touched
+    TSI_EVENT_MOVE,      ///< Touch position changed
+    TSI_EVENT_RELEASE,   ///< Slider is released
+} tsi_event_type_t;
+
+/// Slider event
+typedef struct
+{
+    tsi_event_type_t type; ///< Type of the event
+    int16_t position;      ///< Position, 0 to TSI_SLIDER_MAX
+    int16_t velocity;      ///< Position units per second, positive towards
+                           ///< TSI_SLIDER_MAX
+    TickType_t timestamp;  ///< Tick count of the measurement
+} tsi_event_t;
+
+/// Measurement of all electrodes
+typedef struct
+{
+    uint16_t counts[N_TSI_CHANNELS]; ///< Accumulated scan counts, TSICNT
+    TickType_t timestamp;            ///< Tick count when the last electrode
+                                     ///< was measured
+} tsi_result_t;
+
+// Function prototypes
+void tsi_init(const uint32_t period_ms);
+void tsi_scan(void);
+bool tsi_read(tsi_result_t *result, const TickType_t timeout);
+bool tsi_event(tsi_event_t *event, const TickType_t timeout);
+uint16_t tsi_baseline(const uint32_t channel);
+uint16_t tsi_threshold(const uint32_t channel);
+
+#endif // TSI_H
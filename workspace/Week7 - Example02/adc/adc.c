@@ -0,0 +1,613 @@
+/*! ***************************************************************************
+ *
+ * \brief     ADC0 configuration shared by the analog sensors
+ * \file      adc.c
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include "adc.h"
+#include "flash.h"
+
+#include <stddef.h>
+
+// Calibration that survives a warm restart. The section is not initialised
+// by the startup code (see .uninit_RESERVED in the linker script).
+typedef struct
+{
+    uint32_t magic;  // ADC_CALIBRATION_MAGIC
+    uint32_t cfg1;   // Clock configuration the calibration is valid for
+    uint16_t pg;
+    uint16_t mg;
+    uint16_t ofs;
+    uint16_t reserved;
+    uint32_t crc;    // CRC-32 of the preceding members
+} adc_record_t;
+
+static adc_record_t record __attribute__((section(".bss.$RESERVED")));
+
+static bool calibrated = false;
+static bool cached = false;
+
+// Configuration of ADC0, see adc_init()
+#define ADC_CFG1 (0x9D)
+
+// Scan list
+static const adc_channel_t *scan[ADC_SCAN_MAX];
+static uint32_t scan_length = 0;
+
+// Number of scan timer counts between two conversions of a channel
+static uint32_t scan_period[ADC_SCAN_MAX];
+
+// Number of scan timer ticks between two conversions of a channel, and the
+// ticks left until the next conversion
+static uint32_t scan_divider[ADC_SCAN_MAX];
+static uint32_t scan_countdown[ADC_SCAN_MAX];
+
+// Channels that are due for a conversion, one bit per channel
+static uint32_t scan_due = 0;
+
+// Channel that is being converted, or -1
+static int32_t scan_current = -1;
+
+// Hardware averaging that is currently configured
+static adc_average_t scan_average = ADC_AVERAGE_1;
+
+// Conversions that were skipped, because the previous conversion of the
+// channel was still due
+static volatile uint32_t scan_overruns = 0;
+
+// Ownership of ADC0
+static bool scan_running = false;
+static bool claimed = false;
+static adc_handler_t claimed_handler = NULL;
+
+// Local function prototypes
+static bool adc_restore(void);
+static uint32_t adc_scan_tick(void);
+static void adc_scan_next(void);
+
+/*!
+ * \brief Initialises ADC0
+ *
+ * Enables the clock and selects 16-bit single-ended conversions. The
+ * trigger, channel and interrupts are configured by the drivers.
+ *
+ * The first call calibrates ADC0. After a warm restart, e.g. a reset by the
+ * debugger or the watchdog, the calibration of the previous run is restored
+ * instead, which saves the time of the calibration. Use adc_calibration()
+ * to see the result.
+ */
+void adc_init(void)
+{
+    // Enable clock to ADC0
+    SIM->SCGC6 |= SIM_SCGC6_ADC0(1);
+
+    // Configure ADC
+    // - ADLPC = 1        : Low-power configuration. The power is reduced at
+    //                      the expense of maximum clock speed.
+    // - ADIV[1:0] = 00   : The divide ratio is 1 and the clock rate is input
+    //                      clock.
+    // - ADLSMP = 1       : Long sample time.
+    // - MODE[1:0] = 11   : Single-ended 16-bit conversion
+    // - ADICLK[1:0] = 01 : (Bus clock)/2
+    ADC0->CFG1 = ADC_CFG1;
+
+    if(!calibrated)
+    {
+        if(!adc_restore())
+        {
+            adc_calibrate();
+        }
+    }
+}
+
+/*!
+ * \brief Calibrates ADC0
+ *
+ * Runs the self-calibration and writes the plus-side and minus-side gain
+ * from the calibration values. The offset (OFS) is written by the hardware.
+ * The calibration runs with software triggering, 32 averaged conversions
+ * and a 1.5 MHz ADC clock, as recommended by the reference manual, and
+ * busy-waits until it has completed, which takes tens of milliseconds.
+ * Afterwards SC2, SC3 and CFG1 are restored to the state of adc_init(). It
+ * must not be called while conversions are running. Run it again after
+ * large changes of the supply voltage or temperature.
+ *
+ * \return False if the calibration failed (CALF), the gains are then not
+ * changed
+ */
+bool adc_calibrate(void)
+{
+    // - ADTRG = 0 : Software trigger selected
+    ADC0->SC2 = 0;
+
+    // - ADIV[1:0] = 11 : The divide ratio is 8, (24 MHz / 2) / 8 = 1.5 MHz
+    ADC0->CFG1 = ADC_CFG1 | ADC_CFG1_ADIV(3);
+
+    // - CAL = 1       : Start the calibration
+    // - CALF = 1      : Clear a previous calibration failure
+    // - AVGE = 1      : Hardware average function enabled
+    // - AVGS[1:0] = 11: 32 samples averaged
+    ADC0->SC3 = ADC_SC3_CAL(1) | ADC_SC3_CALF(1) | ADC_SC3_AVGE(1) |
+                ADC_SC3_AVGS(3);
+
+    // COCO is set when the calibration has completed
+    while((ADC0->SC1[0] & ADC_SC1_COCO_MASK) == 0)
+    {}
+
+    const bool failed = (ADC0->SC3 & ADC_SC3_CALF_MASK) != 0;
+
+    if(!failed)
+    {
+        const uint16_t clp[ADC_GAIN_VALUES] =
+        {
+            ADC0->CLP0, ADC0->CLP1, ADC0->CLP2, ADC0->CLP3, ADC0->CLP4, ADC0->CLPS,
+        };
+
+        const uint16_t clm[ADC_GAIN_VALUES] =
+        {
+            ADC0->CLM0, ADC0->CLM1, ADC0->CLM2, ADC0->CLM3, ADC0->CLM4, ADC0->CLMS,
+        };
+
+        ADC0->PG = adc_gain(clp);
+        ADC0->MG = adc_gain(clm);
+
+        // Cache the result for a warm restart
+        record.magic = ADC_CALIBRATION_MAGIC;
+        record.cfg1 = ADC_CFG1;
+        record.pg = (uint16_t)ADC0->PG;
+        record.mg = (uint16_t)ADC0->MG;
+        record.ofs = (uint16_t)ADC0->OFS;
+        record.reserved = 0;
+        record.crc = flash_crc32(&record, offsetof(adc_record_t, crc));
+    }
+
+    // Reading R[0] clears COCO. Restore the configuration of adc_init().
+    (void)ADC0->R[0];
+    ADC0->SC3 = ADC_SC3_CALF(1);
+    ADC0->CFG1 = ADC_CFG1;
+
+    calibrated = !failed;
+    cached = false;
+
+    return calibrated;
+}
+
+/*!
+ * \brief Calculates a gain from the calibration values of one side
+ *
+ * The gain is the sum of the calibration values divided by 2, with the MSB
+ * set (KL25 Sub-Family Reference Manual, section "Calibration function").
+ * Only the implemented bits of the values are used: 6 bits of CLx0, 7, 8, 9
+ * and 10 bits of CLx1 to CLx4 and 6 bits of CLxS.
+ *
+ * \param[in]  cl  CLP0 to CLP4 and CLPS for the plus-side gain (PG), or CLM0
+ *                 to CLM4 and CLMS for the minus-side gain (MG)
+ *
+ * \return Value for the PG or MG register
+ */
+uint16_t adc_gain(const uint16_t cl[ADC_GAIN_VALUES])
+{
+    // The CLMx registers have the same widths
+    static const uint16_t mask[ADC_GAIN_VALUES] =
+    {
+        ADC_CLP0_CLP0_MASK, ADC_CLP1_CLP1_MASK, ADC_CLP2_CLP2_MASK,
+        ADC_CLP3_CLP3_MASK, ADC_CLP4_CLP4_MASK, ADC_CLPS_CLPS_MASK,
+    };
+
+    uint16_t sum = 0;
+
+    for(uint32_t i=0; i<ADC_GAIN_VALUES; i++)
+    {
+        sum += cl[i] & mask[i];
+    }
+
+    return (sum >> 1) | 0x8000;
+}
+
+/*!
+ * \brief Returns the calibration of ADC0
+ *
+ * \param[out] calibration  Gains and offset that are in use
+ *
+ * \return False if ADC0 is not calibrated
+ */
+bool adc_calibration(adc_calibration_t *calibration)
+{
+    if(!calibrated)
+    {
+        return false;
+    }
+
+    calibration->pg = (uint16_t)ADC0->PG;
+    calibration->mg = (uint16_t)ADC0->MG;
+    calibration->ofs = (uint16_t)ADC0->OFS;
+    calibration->cached = cached;
+
+    return true;
+}
+
+/*!
+ * \brief Selects the hardware averaging
+ *
+ * With hardware averaging the ADC performs the selected number of
+ * conversions after every trigger and signals conversion complete once, with
+ * the average in the result register. The conversion time is multiplied by
+ * the number of conversions, so it must still fit in the trigger period.
+ *
+ * \param[in]  average  Number of conversions per result
+ */
+void adc_average(const adc_average_t average)
+{
+    uint32_t sc3 = ADC0->SC3 & ~(ADC_SC3_AVGE_MASK | ADC_SC3_AVGS_MASK |
+                                 ADC_SC3_CALF_MASK);
+
+    if(average != ADC_AVERAGE_1)
+    {
+        // - AVGE = 1      : Hardware average function enabled
+        // - AVGS[1:0]     : 00 = 4, 01 = 8, 10 = 16, 11 = 32 samples
+        sc3 |= ADC_SC3_AVGE(1) | ADC_SC3_AVGS(average - ADC_AVERAGE_4);
+    }
+
+    ADC0->SC3 = sc3;
+}
+
+/*!
+ * \brief Configures the compare function
+ *
+ * With the compare function enabled, a conversion only completes, and sets
+ * conversion complete with its interrupt or DMA request, if the result meets
+ * the condition. Other conversions are discarded without CPU involvement.
+ * The setting can be changed from the conversion complete interrupt.
+ *
+ * \param[in]  compare  Condition
+ * \param[in]  value    Compare value (CV1), in the format of the result
+ */
+void adc_compare(const adc_compare_t compare, const uint16_t value)
+{
+    uint32_t sc2 = ADC0->SC2 & ~(ADC_SC2_ACFE_MASK | ADC_SC2_ACFGT_MASK |
+                                 ADC_SC2_ACREN_MASK);
+
+    ADC0->CV1 = value;
+
+    // - ACFE = 1  : Compare function enabled
+    // - ACFGT     : 0 = less than CV1, 1 = greater than or equal to CV1
+    // - ACREN = 0 : Range function disabled
+    if(compare == ADC_COMPARE_LESS)
+    {
+        sc2 |= ADC_SC2_ACFE(1);
+    }
+    else if(compare == ADC_COMPARE_GREATER_EQUAL)
+    {
+        sc2 |= ADC_SC2_ACFE(1) | ADC_SC2_ACFGT(1);
+    }
+
+    ADC0->SC2 = sc2;
+}
+
+/*!
+ * \brief Claims ADC0 for a single driver
+ *
+ * A driver that configures ADC0 itself, for example for hardware triggering
+ * or DMA, must claim it first. The handler is called from the ADC0 interrupt.
+ * ADC0 can either be claimed once or be used by the scan.
+ *
+ * \param[in]  handler  Conversion complete handler, or NULL
+ *
+ * \return False if ADC0 is already claimed or the scan is running
+ */
+bool adc_claim(adc_handler_t handler)
+{
+    if(claimed || scan_running)
+    {
+        return false;
+    }
+
+    claimed = true;
+    claimed_handler = handler;
+
+    return true;
+}
+
+/*!
+ * \brief Adds a channel to the scan list
+ *
+ * Channels must be added before adc_scan_start() is called. A channel can be
+ * added more than once with different settings.
+ *
+ * \param[in]  channel  Channel descriptor
+ *
+ * \return False if the scan list is full or the rate is not supported
+ */
+bool adc_scan_add(const adc_channel_t *channel)
+{
+    if(scan_running || (scan_length == ADC_SCAN_MAX) || (channel->rate == 0) ||
+       ((ADC_SCAN_CLOCK % channel->rate) != 0))
+    {
+        return false;
+    }
+
+    scan[scan_length] = channel;
+    scan_period[scan_length] = ADC_SCAN_CLOCK / channel->rate;
+    scan_length++;
+
+    return true;
+}
+
+/*!
+ * \brief Starts the scan
+ *
+ * TPM1 interrupts at the lowest rate that all channel periods are a
+ * multiple of, see adc_scan_tick(), and marks the channels that are due.
+ * With a single channel at 20 Hz, TPM1 interrupts at 20 Hz instead of at a
+ * fixed high rate. The due channels are converted one after the other,
+ * every conversion is
+ * started from the conversion complete interrupt of the previous one. So
+ * there is no busy-waiting and the converter is used back to back when
+ * several channels are due. The hardware averaging is only written when it
+ * differs from the previous conversion.
+ *
+ * \return False if ADC0 is claimed by a driver
+ */
+bool adc_scan_start(void)
+{
+    if(claimed || scan_running)
+    {
+        return false;
+    }
+
+    scan_running = true;
+
+    adc_init();
+
+    // - ADTRG = 0   : Software trigger selected
+    // - ACFE  = 0   : Compare function disabled
+    // - DMAEN = 0   : DMA is disabled
+    // - REFSEL = 00 : Default voltage reference pin pair
+    ADC0->SC2 = 0;
+
+    scan_average = ADC_AVERAGE_1;
+    adc_average(scan_average);
+
+    // ------------------------------------------------------------------------
+
+    // Clock to TPM1 on
+    SIM->SCGC6 |= SIM_SCGC6_TPM1(1);
+
+    // Divide by 128 Prescale Factor, interrupt on overflow
+    TPM1->SC = TPM_SC_PS(0b111) | TPM_SC_TOIE(1);
+
+    // Every channel is due once every divider ticks
+    const uint32_t tick = adc_scan_tick();
+
+    for(uint32_t i=0; i<scan_length; i++)
+    {
+        scan_divider[i] = scan_period[i] / tick;
+        scan_countdown[i] = scan_divider[i];
+    }
+
+    TPM1->MOD = tick - 1;
+
+    // ------------------------------------------------------------------------
+
+    // The ADC interrupt must not preempt the timer interrupt and vice versa,
+    // because both update the scan state
+    NVIC_SetPriority(ADC0_IRQn, 128);
+    NVIC_ClearPendingIRQ(ADC0_IRQn);
+    NVIC_EnableIRQ(ADC0_IRQn);
+
+    NVIC_SetPriority(TPM1_IRQn, 128);
+    NVIC_ClearPendingIRQ(TPM1_IRQn);
+    NVIC_EnableIRQ(TPM1_IRQn);
+
+    // Counter increments on every LPTPM counter clock
+    TPM1->SC |= TPM_SC_CMOD(1);
+
+    return true;
+}
+
+/*!
+ * \brief Returns the number of skipped conversions
+ *
+ * A conversion is skipped if it is due while the previous conversion of the
+ * same channel has not been started yet, because the scan list takes more
+ * time than the rates allow.
+ *
+ * \return Number of skipped conversions
+ */
+uint32_t adc_scan_overruns(void)
+{
+    return scan_overruns;
+}
+
+/*!
+ * \brief Restores the cached calibration after a warm restart
+ *
+ * \return False after a power-on or low-voltage reset, or if the cache is
+ * not valid
+ */
+static bool adc_restore(void)
+{
+    // The RAM content is not retained by these resets
+    if((RCM->SRS0 & (RCM_SRS0_POR_MASK | RCM_SRS0_LVD_MASK)) != 0)
+    {
+        return false;
+    }
+
+    if((record.magic != ADC_CALIBRATION_MAGIC) || (record.cfg1 != ADC_CFG1) ||
+       (record.crc != flash_crc32(&record, offsetof(adc_record_t, crc))))
+    {
+        return false;
+    }
+
+    ADC0->PG = record.pg;
+    ADC0->MG = record.mg;
+    ADC0->OFS = record.ofs;
+
+    calibrated = true;
+    cached = true;
+
+    return true;
+}
+
+/*!
+ * \brief Calculates the period of the scan timer
+ *
+ * The period is the greatest common divisor of the channel periods, so the
+ * timer only interrupts when a channel can be due. If it doesn't fit in the
+ * 16-bit counter, the largest divisor of it that fits is used.
+ *
+ * \return Period in scan timer counts, 1 to 65536
+ */
+static uint32_t adc_scan_tick(void)
+{
+    uint32_t tick = 0;
+
+    for(uint32_t i=0; i<scan_length; i++)
+    {
+        // Euclid's algorithm, gcd(0, p) = p
+        uint32_t a = scan_period[i];
+        uint32_t b = tick;
+
+        while(b != 0)
+        {
+            uint32_t r = a % b;
+            a = b;
+            b = r;
+        }
+
+        tick = a;
+    }
+
+    if(tick == 0)
+    {
+        // Empty scan list
+        return 0x10000;
+    }
+
+    uint32_t d = 1;
+    while((tick / d > 0x10000) || ((tick % d) != 0))
+    {
+        d++;
+    }
+
+    return tick / d;
+}
+
+/*!
+ * \brief Starts the conversion of the next due channel, if any
+ */
+static void adc_scan_next(void)
+{
+    scan_current = -1;
+
+    for(uint32_t i=0; i<scan_length; i++)
+    {
+        if(scan_due & (1U << i))
+        {
+            scan_due &= ~(1U << i);
+            scan_current = (int32_t)i;
+
+            if(scan[i]->average != scan_average)
+            {
+                scan_average = scan[i]->average;
+                adc_average(scan_average);
+            }
+
+            // Writing SC1A starts the conversion
+            // - AIEN = 1 : Conversion complete interrupt is enabled
+            // - DIFF = 0 : Single-ended conversion
+            ADC0->SC1[0] = ADC_SC1_AIEN(1) | ADC_SC1_ADCH(scan[i]->channel);
+            break;
+        }
+    }
+}
+
+void TPM1_IRQHandler(void)
+{
+    // Clear pending interrupt
+    NVIC_ClearPendingIRQ(TPM1_IRQn);
+
+    // Clear the flag
+    TPM1->STATUS = TPM_STATUS_TOF(1);
+
+    for(uint32_t i=0; i<scan_length; i++)
+    {
+        if(--scan_countdown[i] == 0)
+        {
+            scan_countdown[i] = scan_divider[i];
+
+            if(scan_due & (1U << i))
+            {
+                scan_overruns++;
+            }
+
+            scan_due |= (1U << i);
+        }
+    }
+
+    if(scan_current < 0)
+    {
+        adc_scan_next();
+    }
+}
+
+void ADC0_IRQHandler(void)
+{
+    // Clear pending interrupt
+    NVIC_ClearPendingIRQ(ADC0_IRQn);
+
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    if(claimed)
+    {
+        if(claimed_handler != NULL)
+        {
+            claimed_handler(&xHigherPriorityTaskWoken);
+        }
+    }
+    else if(scan_current >= 0)
+    {
+        // Reading the result clears the conversion complete flag
+        const uint16_t result = (uint16_t)ADC0->R[0];
+        const TickType_t timestamp = xTaskGetTickCountFromISR();
+        const adc_channel_t *c = scan[scan_current];
+
+        // Start the next conversion before the result is delivered
+        adc_scan_next();
+
+        if(c->ring != NULL)
+        {
+            ring_push_from_isr(c->ring, &result, timestamp, &xHigherPriorityTaskWoken);
+        }
+
+        if(c->callback != NULL)
+        {
+            c->callback(result, timestamp, &xHigherPriorityTaskWoken);
+        }
+    }
+
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
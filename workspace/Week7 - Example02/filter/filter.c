@@ -0,0 +1,314 @@
+/*! ***************************************************************************
+ *
+ * \brief     Fixed-point filter stages
+ * \file      filter.c
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include "filter.h"
+
+#include <string.h>
+
+/*
+ * All filters process a block of n samples. The state of a filter is kept in
+ * a struct that is owned by the caller, so no memory is allocated and every
+ * channel of a sensor has its own instance. Stages are chained by passing the
+ * output block of one stage as the input block of the next stage. The input
+ * and output block may be the same array.
+ */
+
+/*!
+ * \brief Initialises a first-order IIR low-pass filter
+ *
+ * The -3 dB frequency is approximately alpha * fs / (2 * pi) for small alpha.
+ *
+ * \param[out] f      Filter
+ * \param[in]  alpha  Smoothing factor, 0 < alpha <= 1. alpha = 1 disables the
+ *                    filter.
+ */
+void filter_iir_init(filter_iir_t *f, const q16_t alpha)
+{
+    f->alpha = alpha;
+    f->y = 0;
+    f->primed = false;
+}
+
+/*!
+ * \brief Processes a block of samples with a first-order IIR low-pass filter
+ *
+ * The filter starts at the first sample, so there is no step response from
+ * zero.
+ *
+ * \param[in,out] f    Filter
+ * \param[in]     in   Input samples
+ * \param[out]    out  Output samples
+ * \param[in]     n    Number of samples
+ */
+void filter_iir(filter_iir_t *f, const q16_t in[], q16_t out[], const uint32_t n)
+{
+    if((n > 0) && !f->primed)
+    {
+        f->y = in[0];
+        f->primed = true;
+    }
+
+    q16_t y = f->y;
+
+    for(uint32_t i=0; i<n; i++)
+    {
+        y += q16_mul(f->alpha, in[i] - y);
+        out[i] = y;
+    }
+
+    f->y = y;
+}
+
+/*!
+ * \brief Initialises a moving average filter
+ *
+ * \param[out] f       Filter
+ * \param[in]  length  Number of samples, a power of two up to FILTER_MA_MAX
+ *
+ * \return False if the length is not supported
+ */
+bool filter_ma_init(filter_ma_t *f, const uint8_t length)
+{
+    if((length == 0) || (length > FILTER_MA_MAX) || ((length & (length - 1)) != 0))
+    {
+        return false;
+    }
+
+    memset(f, 0, sizeof(filter_ma_t));
+
+    while((1U << f->shift) < length)
+    {
+        f->shift++;
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Processes a block of samples with a moving average filter
+ *
+ * The window starts filled with zeros. The running sum is updated with every
+ * sample, so the cost does not depend on the length. The samples must be
+ * smaller than 2^31 / length in magnitude, so the sum does not overflow.
+ *
+ * \param[in,out] f    Filter
+ * \param[in]     in   Input samples
+ * \param[out]    out  Output samples
+ * \param[in]     n    Number of samples
+ */
+void filter_ma(filter_ma_t *f, const q16_t in[], q16_t out[], const uint32_t n)
+{
+    const uint8_t mask = (uint8_t)((1U << f->shift) - 1);
+
+    for(uint32_t i=0; i<n; i++)
+    {
+        q16_t x = in[i];
+
+        f->sum += x - f->window[f->index];
+        f->window[f->index] = x;
+        f->index = (f->index + 1) & mask;
+
+        out[i] = f->sum >> f->shift;
+    }
+}
+
+/*!
+ * \brief Initialises a median filter
+ *
+ * \param[out] f       Filter
+ * \param[in]  length  Number of samples, up to FILTER_MEDIAN_MAX
+ *
+ * \return False if the length is not supported
+ */
+bool filter_median_init(filter_median_t *f, const uint8_t length)
+{
+    if((length == 0) || (length > FILTER_MEDIAN_MAX))
+    {
+        return false;
+    }
+
+    memset(f, 0, sizeof(filter_median_t));
+    f->length = length;
+
+    return true;
+}
+
+/*!
+ * \brief Processes a block of samples with a median filter
+ *
+ * Until the window is filled, the median of the available samples is used.
+ * For every sample the window is copied and sorted with an insertion sort,
+ * which is fast for the short windows that are supported.
+ *
+ * \param[in,out] f    Filter
+ * \param[in]     in   Input samples
+ * \param[out]    out  Output samples
+ * \param[in]     n    Number of samples
+ */
+void filter_median(filter_median_t *f, const q16_t in[], q16_t out[], const uint32_t n)
+{
+    q16_t sorted[FILTER_MEDIAN_MAX];
+
+    for(uint32_t i=0; i<n; i++)
+    {
+        f->window[f->index] = in[i];
+        f->index = (f->index + 1 == f->length) ? 0 : f->index + 1;
+
+        if(f->count < f->length)
+        {
+            f->count++;
+        }
+
+        for(uint8_t j=0; j<f->count; j++)
+        {
+            q16_t v = f->window[j];
+            int8_t k = (int8_t)j - 1;
+
+            while((k >= 0) && (sorted[k] > v))
+            {
+                sorted[k+1] = sorted[k];
+                k--;
+            }
+
+            sorted[k+1] = v;
+        }
+
+        out[i] = sorted[f->count / 2];
+    }
+}
+
+/*!
+ * \brief Initialises an oversample and decimate stage
+ *
+ * \param[out] f      Stage
+ * \param[in]  ratio  Number of input samples per output sample, up to
+ *                    FILTER_DECIMATE_MAX
+ * \param[in]  shift  Right shift of the sum of a group
+ *
+ * \return False if the ratio is not supported
+ */
+bool filter_decimate_init(filter_decimate_t *f, const uint16_t ratio, const uint8_t shift)
+{
+    if((ratio == 0) || (ratio > FILTER_DECIMATE_MAX) || (shift > 31))
+    {
+        return false;
+    }
+
+    memset(f, 0, sizeof(filter_decimate_t));
+    f->ratio = ratio;
+    f->shift = shift;
+
+    return true;
+}
+
+/*!
+ * \brief Processes a block of samples with an oversample and decimate stage
+ *
+ * A group of samples may span several blocks. The samples must be smaller
+ * than 2^31 / ratio in magnitude, so the sum does not overflow.
+ *
+ * \param[in,out] f    Stage
+ * \param[in]     in   Input samples
+ * \param[out]    out  Output samples, room for n / ratio + 1 samples. May be
+ *                     the same array as in.
+ * \param[in]     n    Number of input samples
+ *
+ * \return Number of output samples
+ */
+uint32_t filter_decimate(filter_decimate_t *f, const int32_t in[], int32_t out[],
+                         const uint32_t n)
+{
+    uint32_t m = 0;
+
+    for(uint32_t i=0; i<n; i++)
+    {
+        f->sum += in[i];
+
+        if(++f->count == f->ratio)
+        {
+            out[m++] = f->sum >> f->shift;
+            f->sum = 0;
+            f->count = 0;
+        }
+    }
+
+    return m;
+}
+
+/*!
+ * \brief Initialises a complementary filter
+ *
+ * The time constant of the filter is approximately
+ * tau = alpha * dt / (1 - alpha).
+ *
+ * \param[out] f      Filter
+ * \param[in]  alpha  Weight of the integrated rate, 0 <= alpha < 1
+ * \param[in]  dt     Sample period in seconds
+ */
+void filter_comp_init(filter_comp_t *f, const q16_t alpha, const q16_t dt)
+{
+    f->alpha = alpha;
+    f->dt = dt;
+    f->angle = 0;
+    f->primed = false;
+}
+
+/*!
+ * \brief Processes a block of samples with a complementary filter
+ *
+ * The filter starts at the first measured angle.
+ *
+ * \param[in,out] f     Filter
+ * \param[in]     meas  Measured angles
+ * \param[in]     rate  Rates in angle units per second
+ * \param[out]    out   Fused angles
+ * \param[in]     n     Number of samples
+ */
+void filter_comp(filter_comp_t *f, const q16_t meas[], const q16_t rate[], q16_t out[],
+                 const uint32_t n)
+{
+    if((n > 0) && !f->primed)
+    {
+        f->angle = meas[0];
+        f->primed = true;
+    }
+
+    q16_t angle = f->angle;
+
+    for(uint32_t i=0; i<n; i++)
+    {
+        q16_t predicted = angle + q16_mul(rate[i], f->dt);
+
+        // alpha * predicted + (1 - alpha) * meas
+        angle = meas[i] + q16_mul(f->alpha, predicted - meas[i]);
+        out[i] = angle;
+    }
+
+    f->angle = angle;
+}
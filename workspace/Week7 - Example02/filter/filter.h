@@ -0,0 +1,142 @@
+/*! ***************************************************************************
+ *
+ * \brief     Fixed-point filter stages
+ * \file      filter.h
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "fixmath.h"
+
+/*!
+ * \brief Definition for the maximum length of a moving average filter
+ */
+#define FILTER_MA_MAX      (16)
+
+/*!
+ * \brief Definition for the maximum length of a median filter
+ */
+#define FILTER_MEDIAN_MAX  (9)
+
+/*!
+ * \brief Definition for the maximum ratio of a decimation stage
+ */
+#define FILTER_DECIMATE_MAX (256)
+
+/*!
+ * \brief First-order IIR low-pass filter
+ *
+ * y[n] = y[n-1] + alpha * (x[n] - y[n-1])
+ */
+typedef struct
+{
+    q16_t alpha;  ///< Smoothing factor, 0 < alpha <= 1
+    q16_t y;      ///< Previous output
+    bool primed;  ///< Set after the first sample
+} filter_iir_t;
+
+/*!
+ * \brief Moving average filter
+ *
+ * The length must be a power of two, so the division is a shift.
+ */
+typedef struct
+{
+    q16_t window[FILTER_MA_MAX]; ///< Last samples
+    int32_t sum;                 ///< Sum of the window
+    uint8_t shift;               ///< log2 of the length
+    uint8_t index;               ///< Position of the oldest sample
+} filter_ma_t;
+
+/*!
+ * \brief Median filter
+ *
+ * Removes spikes that are shorter than half the length. The length should be
+ * odd.
+ */
+typedef struct
+{
+    q16_t window[FILTER_MEDIAN_MAX]; ///< Last samples
+    uint8_t length;                  ///< Number of samples in the median
+    uint8_t index;                   ///< Position of the oldest sample
+    uint8_t count;                   ///< Number of samples in the window
+} filter_median_t;
+
+/*!
+ * \brief Complementary filter
+ *
+ * Fuses an angle that is integrated from a rate (for example a gyroscope)
+ * with an absolute, but noisy, angle (for example from an accelerometer):
+ *
+ * angle[n] = alpha * (angle[n-1] + rate[n] * dt) + (1 - alpha) * meas[n]
+ */
+typedef struct
+{
+    q16_t alpha;  ///< Weight of the integrated rate, 0 <= alpha < 1
+    q16_t dt;     ///< Sample period in seconds
+    q16_t angle;  ///< Previous output
+    bool primed;  ///< Set after the first sample
+} filter_comp_t;
+
+/*!
+ * \brief Oversample and decimate stage
+ *
+ * Sums ratio input samples into one output sample and shifts the sum right.
+ * Shifting by log2(ratio) gives the mean. Oversampling by 4^k and shifting
+ * by k gives k additional bits of resolution, provided that the input
+ * contains at least one LSB of noise.
+ */
+typedef struct
+{
+    int32_t sum;     ///< Sum of the current group
+    uint16_t ratio;  ///< Number of input samples per output sample
+    uint16_t count;  ///< Number of samples in the current group
+    uint8_t shift;   ///< Right shift of the sum
+} filter_decimate_t;
+
+// Function prototypes
+void filter_iir_init(filter_iir_t *f, const q16_t alpha);
+void filter_iir(filter_iir_t *f, const q16_t in[], q16_t out[], const uint32_t n);
+
+bool filter_ma_init(filter_ma_t *f, const uint8_t length);
+void filter_ma(filter_ma_t *f, const q16_t in[], q16_t out[], const uint32_t n);
+
+bool filter_median_init(filter_median_t *f, const uint8_t length);
+void filter_median(filter_median_t *f, const q16_t in[], q16_t out[], const uint32_t n);
+
+bool filter_decimate_init(filter_decimate_t *f, const uint16_t ratio, const uint8_t shift);
+uint32_t filter_decimate(filter_decimate_t *f, const int32_t in[], int32_t out[],
+                         const uint32_t n);
+
+void filter_comp_init(filter_comp_t *f, const q16_t alpha, const q16_t dt);
+void filter_comp(filter_comp_t *f, const q16_t meas[], const q16_t rate[], q16_t out[],
+                 const uint32_t n);
+
+#endif // FILTER_H
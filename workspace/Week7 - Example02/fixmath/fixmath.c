@@ -0,0 +1,224 @@
+/*! ***************************************************************************
+ *
+ * \brief     Fixed-point math
+ * \file      fixmath.c
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include "fixmath.h"
+
+/*!
+ * \brief Integer square root
+ *
+ * Computes floor(sqrt(x)) bit by bit, using only shifts, additions and
+ * subtractions. The loop runs 16 times.
+ *
+ * \param[in]  x  Value
+ *
+ * \return floor(sqrt(x)), exact
+ */
+uint32_t isqrt32(uint32_t x)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+
+    while(bit > x)
+    {
+        bit >>= 2;
+    }
+
+    while(bit != 0)
+    {
+        if(x >= root + bit)
+        {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+
+        bit >>= 2;
+    }
+
+    return root;
+}
+
+/*!
+ * \brief Square root of a Q16.16 number
+ *
+ * The square root of a Q16.16 number is the integer square root of the
+ * number shifted left by 16 bits. The same bitwise algorithm as isqrt32() is
+ * used on 64-bit values.
+ *
+ * \param[in]  x  Value
+ *
+ * \return sqrt(x) rounded towards zero, the error is less than 1 LSB
+ *         (1.5e-5). Negative values return 0.
+ */
+q16_t q16_sqrt(const q16_t x)
+{
+    if(x <= 0)
+    {
+        return 0;
+    }
+
+    uint64_t v = (uint64_t)x << 16;
+    uint64_t root = 0;
+    uint64_t bit = 1ULL << 46;
+
+    while(bit > v)
+    {
+        bit >>= 2;
+    }
+
+    while(bit != 0)
+    {
+        if(v >= root + bit)
+        {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+
+        bit >>= 2;
+    }
+
+    return (q16_t)root;
+}
+
+/*!
+ * \brief Reciprocal of a Q16.16 number
+ *
+ * 1/x in Q16.16 is 2^32 divided by the raw value of x, so a single 32-bit
+ * division is sufficient. The Cortex-M0+ has no divide instruction, but the
+ * 32-bit division of the run-time library is much faster than a
+ * floating-point division.
+ *
+ * \param[in]  x  Value, |x| must be larger than 1/65536
+ *
+ * \return 1/x rounded towards zero, the error is less than 1 LSB. The result
+ *         is saturated for x = +/-1/65536 and 0.
+ */
+q16_t q16_recip(const q16_t x)
+{
+    uint32_t ax = (x < 0) ? (uint32_t)(-x) : (uint32_t)x;
+
+    if(ax <= 1)
+    {
+        return (x < 0) ? INT32_MIN : INT32_MAX;
+    }
+
+    // 2^32 doesn't fit in 32 bits. 2^32 / ax is one more than
+    // (2^32 - 1) / ax if ax divides 2^32, which is when the remainder is
+    // ax - 1.
+    uint32_t r = 0xFFFFFFFFUL / ax;
+
+    if((0xFFFFFFFFUL - r * ax) == (ax - 1))
+    {
+        r++;
+    }
+
+    if(r > INT32_MAX)
+    {
+        r = INT32_MAX;
+    }
+
+    return (x < 0) ? -(q16_t)r : (q16_t)r;
+}
+
+/*!
+ * \brief Four-quadrant arctangent
+ *
+ * The arguments are reduced to a ratio r = min(|y|,|x|) / max(|y|,|x|) in
+ * the range [0,1], for which the arctangent is approximated by the
+ * polynomial
+ *
+ *     atan(r) = pi/4 * r - r * (r - 1) * (0.2447 + 0.0663 * r)
+ *
+ * (Rajan et al., "Efficient approximations for the arctangent function",
+ * IEEE Signal Processing Magazine, 2006). The result is then mapped to the
+ * correct octant.
+ *
+ * Because only the ratio matters, \p y and \p x can have any scale, as long
+ * as both have the same scale. For example, raw accelerometer counts can be
+ * used directly.
+ *
+ * \param[in]  y  Y coordinate
+ * \param[in]  x  X coordinate
+ *
+ * \return atan2(y,x) in radians in Q16.16, in the range [-pi,pi]. The
+ *         maximum error is 0.0016 rad (0.1 degrees). atan2(0,0) returns 0.
+ */
+q16_t q16_atan2(int32_t y, int32_t x)
+{
+    uint32_t ay = (y < 0) ? -(uint32_t)y : (uint32_t)y;
+    uint32_t ax = (x < 0) ? -(uint32_t)x : (uint32_t)x;
+
+    if((ax == 0) && (ay == 0))
+    {
+        return 0;
+    }
+
+    uint32_t num = (ay < ax) ? ay : ax;
+    uint32_t den = (ay < ax) ? ax : ay;
+
+    // Scale down, so the numerator can be shifted into Q16.16 without
+    // overflow. The ratio keeps at least 15 significant bits.
+    while(den >= (1UL << 15))
+    {
+        num >>= 1;
+        den >>= 1;
+    }
+
+    // r in Q16.16, 0 <= r <= 1
+    q16_t r = (q16_t)((num << 16) / den);
+
+    // Polynomial approximation of atan(r) for 0 <= r <= 1
+    q16_t a = q16_mul(Q16(0.2447) + q16_mul(Q16(0.0663), r), q16_mul(r, Q16_ONE - r));
+    q16_t angle = q16_mul(Q16_PI / 4, r) + a;
+
+    // Map to the octant
+    if(ay > ax)
+    {
+        angle = (Q16_PI / 2) - angle;
+    }
+
+    if(x < 0)
+    {
+        angle = Q16_PI - angle;
+    }
+
+    if(y < 0)
+    {
+        angle = -angle;
+    }
+
+    return angle;
+}
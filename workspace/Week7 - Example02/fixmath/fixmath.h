@@ -0,0 +1,103 @@
+/*! ***************************************************************************
+ *
+ * \brief     Fixed-point math
+ * \file      fixmath.h
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef FIXMATH_H
+#define FIXMATH_H
+
+#include <stdint.h>
+
+/*!
+ * \brief Signed Q16.16 fixed-point number
+ *
+ * Range -32768 to 32767.99998, resolution 1/65536.
+ */
+typedef int32_t q16_t;
+
+/*!
+ * \brief Signed Q1.15 fixed-point number
+ *
+ * Range -1 to 0.99997, resolution 1/32768.
+ */
+typedef int16_t q15_t;
+
+#define Q16_ONE      ((q16_t)0x00010000)
+#define Q15_ONE      ((int32_t)0x00008000)
+
+/*!
+ * \brief Converts a constant to Q16.16
+ *
+ * Only use this macro with constants, so the conversion is done by the
+ * compiler instead of by the software floating-point library.
+ */
+#define Q16(x)       ((q16_t)((x) * 65536.0 + (((x) >= 0) ? 0.5 : -0.5)))
+
+/*!
+ * \brief Converts a constant to Q1.15
+ */
+#define Q15(x)       ((q15_t)((x) * 32768.0 + (((x) >= 0) ? 0.5 : -0.5)))
+
+#define Q16_PI       Q16(3.14159265358979)
+#define Q16_RAD2DEG  Q16(57.2957795130823)
+
+/*!
+ * \brief Converts a Q16.16 number to an integer, rounding towards minus
+ * infinity
+ */
+#define Q16_TO_INT(x) ((int32_t)((x) >> 16))
+
+/*!
+ * \brief Multiplies two Q16.16 numbers
+ *
+ * The result is rounded to the nearest and is not saturated.
+ */
+static inline q16_t q16_mul(const q16_t a, const q16_t b)
+{
+    return (q16_t)((((int64_t)a * b) + 0x8000) >> 16);
+}
+
+/*!
+ * \brief Multiplies two Q1.15 numbers
+ *
+ * The result is rounded to the nearest and saturated, because -1 * -1 does
+ * not fit.
+ */
+static inline q15_t q15_mul(const q15_t a, const q15_t b)
+{
+    int32_t p = (((int32_t)a * b) + 0x4000) >> 15;
+
+    return (q15_t)((p > 0x7FFF) ? 0x7FFF : p);
+}
+
+// Function prototypes
+uint32_t isqrt32(uint32_t x);
+q16_t q16_sqrt(const q16_t x);
+q16_t q16_recip(const q16_t x);
+q16_t q16_atan2(int32_t y, int32_t x);
+
+#endif // FIXMATH_H
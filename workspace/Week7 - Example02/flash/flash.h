@@ -0,0 +1,108 @@
+/*! ***************************************************************************
+ *
+ * \brief     Flash sector erase and program driver
+ * \file      flash.h
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef FLASH_H
+#define FLASH_H
+
+#include <MKL25Z4.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*!
+ * \brief Definition for the size of an erasable flash sector in bytes
+ */
+#define FLASH_SECTOR_SIZE  (1024)
+
+/*!
+ * \brief Definition for the address of the data sector
+ *
+ * This is the last sector of the program flash. The memory configuration in
+ * .cproject and startup/linker_script.ld exclude it from PROGRAM_FLASH
+ * (region DATA_FLASH), so the application can store data in it at runtime
+ * without overwriting code.
+ */
+#define FLASH_DATA_ADDRESS (0x0001FC00)
+
+/// Result of a flash command
+typedef enum
+{
+    FLASH_OK = 0,      ///< Command completed
+    FLASH_ALIGNMENT,   ///< Address or length is not aligned
+    FLASH_ACCESS,      ///< Access error (ACCERR), e.g. an invalid address
+    FLASH_PROTECTION,  ///< Protection violation (FPVIOL)
+    FLASH_VERIFY,      ///< Erase or program verify failed (MGSTAT0)
+} flash_status_t;
+
+/*!
+ * \brief Flash memory that records are stored in
+ *
+ * The record functions only use these operations, so they work on any
+ * implementation. flash_ftfa is the program flash of the KL25Z. A host test
+ * replaces it with a model of the FTFA in RAM.
+ */
+typedef struct
+{
+    /// Erases the sector at an address aligned to FLASH_SECTOR_SIZE
+    flash_status_t (*erase)(const uint32_t address);
+
+    /// Programs longwords into erased flash
+    flash_status_t (*program)(const uint32_t address, const uint32_t data[],
+                              const uint32_t n);
+
+    /// Returns a pointer to the contents of the flash at an address
+    const void *(*read)(const uint32_t address);
+} flash_t;
+
+/*!
+ * \brief Header at the start of a record
+ *
+ * A record starts with this header and ends with a CRC-32 of all previous
+ * bytes. Its size is a multiple of 4 bytes, so it can be programmed in
+ * longwords.
+ */
+typedef struct
+{
+    uint32_t magic;    ///< Identifies the record
+    uint16_t version;  ///< Incremented when the layout of the record changes
+    uint16_t size;     ///< Size of the record in bytes, including the CRC
+} flash_record_t;
+
+extern const flash_t flash_ftfa;
+
+// Function prototypes
+flash_status_t flash_erase(const uint32_t address);
+flash_status_t flash_program(const uint32_t address, const uint32_t data[],
+                             const uint32_t n);
+uint32_t flash_crc32(const void *data, const uint32_t n);
+flash_status_t flash_record_write(const flash_t *flash, const uint32_t address,
+                                  void *record, const uint32_t size);
+bool flash_record_read(const flash_t *flash, const uint32_t address,
+                       void *record, const uint32_t size);
+
+#endif // FLASH_H
@@ -0,0 +1,96 @@
+/*! ***************************************************************************
+ *
+ * \brief     FreeRTOS configuration for the host tests
+ * \file      FreeRTOSConfig.h
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#include <stdint.h>
+
+/*
+ * Same kernel features as inc/FreeRTOSConfig.h, except:
+ * - the idle hook advances the simulated time, see sim.c
+ * - no tickless idle and no run time statistics, there is no timer to drive
+ *   them
+ * - a larger heap, the task stacks hold 64-bit words
+ * - a failed assertion ends the test instead of hanging
+ */
+extern uint32_t SystemCoreClock;
+extern void sim_assert(const char *file, const int line);
+
+#define configUSE_PREEMPTION			         1
+#define configUSE_TIME_SLICING			         1
+#define configUSE_IDLE_HOOK				         1
+#define configUSE_TICK_HOOK				         0
+#define configCPU_CLOCK_HZ				         ( SystemCoreClock )
+#define configTICK_RATE_HZ				         ( ( TickType_t ) 1000 )
+#define configMAX_PRIORITIES			         5
+#define configMAX_TASK_NAME_LEN			         12
+#define configUSE_TRACE_FACILITY		         1
+#define configUSE_16_BIT_TICKS			         0
+#define configIDLE_SHOULD_YIELD			         1
+#define configUSE_MUTEXES				         1
+#define configQUEUE_REGISTRY_SIZE		         8
+#define configCHECK_FOR_STACK_OVERFLOW	         0
+#define configUSE_RECURSIVE_MUTEXES		         1
+#define configUSE_MALLOC_FAILED_HOOK	         0
+#define configUSE_APPLICATION_TASK_TAG	         0
+#define configUSE_COUNTING_SEMAPHORES	         1
+#define configUSE_TASK_NOTIFICATIONS             1
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES    2
+
+#define configGENERATE_RUN_TIME_STATS	         0
+#define configUSE_STATS_FORMATTING_FUNCTIONS     0
+
+#define configRECORD_STACK_HIGH_ADDRESS          1
+
+#define configSUPPORT_STATIC_ALLOCATION          0
+#define configSUPPORT_DYNAMIC_ALLOCATION         1
+
+#define configMINIMAL_STACK_SIZE		         ( ( unsigned short ) 192 )
+#define configTOTAL_HEAP_SIZE			         (  ( size_t ) ( 256 * 1024 ) )
+
+#define configUSE_TIMERS				         1
+#define configTIMER_TASK_PRIORITY		         2
+#define configTIMER_QUEUE_LENGTH		         5
+#define configTIMER_TASK_STACK_DEPTH	         ( configMINIMAL_STACK_SIZE )
+
+#define configUSE_TICKLESS_IDLE			         0
+
+#define INCLUDE_vTaskPrioritySet		         1
+#define INCLUDE_uxTaskPriorityGet		         1
+#define INCLUDE_vTaskDelete				         1
+#define INCLUDE_vTaskCleanUpResources	         1
+#define INCLUDE_vTaskSuspend			         1
+#define INCLUDE_vTaskDelayUntil			         1
+#define INCLUDE_vTaskDelay				         1
+#define INCLUDE_eTaskGetState			         1
+
+#define configASSERT( x )                        if( ( x ) == 0 ) { sim_assert( __FILE__, __LINE__ ); }
+
+#endif /* FREERTOS_CONFIG_H */
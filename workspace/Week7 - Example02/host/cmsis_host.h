@@ -0,0 +1,87 @@
+/*! ***************************************************************************
+ *
+ * \brief     Host replacements for the Cortex-M0+ intrinsics
+ * \file      cmsis_host.h
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef CMSIS_HOST_H
+#define CMSIS_HOST_H
+
+#include <stdint.h>
+
+/*!
+ * \brief The drivers are compiled for the host with this file force-included
+ *
+ * core_cm0plus.h includes cmsis_gcc.h, which implements the intrinsics with
+ * Cortex-M0+ instructions. Defining its include guard skips it, and the
+ * intrinsics that the drivers use are implemented here instead. PRIMASK is a
+ * variable that the host tests can inspect.
+ */
+#define __CMSIS_GCC_H
+
+/// PRIMASK of the host, 1 if interrupts are disabled
+extern volatile uint32_t cmsis_host_primask;
+
+static inline void __enable_irq(void)
+{
+    cmsis_host_primask = 0;
+}
+
+static inline void __disable_irq(void)
+{
+    cmsis_host_primask = 1;
+}
+
+static inline uint32_t __get_PRIMASK(void)
+{
+    return cmsis_host_primask;
+}
+
+static inline void __set_PRIMASK(uint32_t priMask)
+{
+    cmsis_host_primask = priMask & 1;
+}
+
+static inline void __NOP(void)
+{
+}
+
+static inline void __DMB(void)
+{
+    __sync_synchronize();
+}
+
+static inline void __DSB(void)
+{
+    __sync_synchronize();
+}
+
+static inline void __ISB(void)
+{
+    __sync_synchronize();
+}
+
+#endif // CMSIS_HOST_H
@@ -0,0 +1,177 @@
+/*! ***************************************************************************
+ *
+ * \brief     Model of the FTFA program flash in RAM
+ * \file      flash_ram.c
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include "flash_ram.h"
+
+#include <string.h>
+
+static uint8_t memory[FLASH_RAM_SIZE];
+static flash_ram_stats_t stats;
+
+// Longwords that are programmed before the power fails, or -1
+static int32_t power_fail = -1;
+static bool powered = true;
+
+// Local function prototypes
+static flash_status_t flash_ram_erase(const uint32_t address);
+static flash_status_t flash_ram_program(const uint32_t address,
+                                        const uint32_t data[],
+                                        const uint32_t n);
+static const void *flash_ram_read(const uint32_t address);
+
+const flash_t flash_ram =
+{
+    .erase = flash_ram_erase,
+    .program = flash_ram_program,
+    .read = flash_ram_read,
+};
+
+/*!
+ * \brief Erases the complete flash and clears the counters and faults
+ */
+void flash_ram_reset(void)
+{
+    memset(memory, 0xFF, sizeof(memory));
+    memset(&stats, 0, sizeof(stats));
+    power_fail = -1;
+    powered = true;
+}
+
+/*!
+ * \brief Returns a pointer to the modelled flash, e.g. to corrupt a record
+ *
+ * \param[in]  address  Flash address, less than FLASH_RAM_SIZE
+ *
+ * \return Pointer to the byte at the address
+ */
+uint8_t *flash_ram_memory(const uint32_t address)
+{
+    return &memory[address];
+}
+
+/*!
+ * \brief Lets the power fail while flash is programmed
+ *
+ * The given number of longwords is programmed normally. The next longword is
+ * programmed partially: only its lower 16 bits are written. All following
+ * commands are ignored and fail with FLASH_ACCESS, as if the device was
+ * reset. flash_ram_reset() restores the power.
+ *
+ * \param[in]  longwords  Longwords programmed before the power fails
+ */
+void flash_ram_power_fail(const uint32_t longwords)
+{
+    power_fail = (int32_t)longwords;
+}
+
+/*!
+ * \brief Gets the command counters
+ *
+ * \param[out] s  Copy of the counters
+ */
+void flash_ram_getstats(flash_ram_stats_t *s)
+{
+    *s = stats;
+}
+
+static flash_status_t flash_ram_erase(const uint32_t address)
+{
+    if(!powered)
+    {
+        return FLASH_ACCESS;
+    }
+
+    if(((address % FLASH_SECTOR_SIZE) != 0) || (address >= FLASH_RAM_SIZE))
+    {
+        return FLASH_ACCESS;
+    }
+
+    memset(&memory[address], 0xFF, FLASH_SECTOR_SIZE);
+    stats.erases++;
+
+    return FLASH_OK;
+}
+
+static flash_status_t flash_ram_program(const uint32_t address,
+                                        const uint32_t data[],
+                                        const uint32_t n)
+{
+    for(uint32_t i=0; i<n; i++)
+    {
+        const uint32_t a = address + (i * 4);
+
+        if(!powered)
+        {
+            return FLASH_ACCESS;
+        }
+
+        if(((a % 4) != 0) || (a >= FLASH_RAM_SIZE))
+        {
+            return FLASH_ACCESS;
+        }
+
+        uint32_t word;
+        memcpy(&word, &memory[a], 4);
+
+        uint32_t value = data[i];
+
+        if(power_fail == 0)
+        {
+            // Only the lower half is written before the power fails
+            value |= 0xFFFF0000;
+            powered = false;
+        }
+        else if(power_fail > 0)
+        {
+            power_fail--;
+        }
+
+        // Programming can only clear bits
+        word &= value;
+        memcpy(&memory[a], &word, 4);
+        stats.programs++;
+
+        if(!powered)
+        {
+            return FLASH_ACCESS;
+        }
+
+        if(word != data[i])
+        {
+            return FLASH_VERIFY;
+        }
+    }
+
+    return FLASH_OK;
+}
+
+static const void *flash_ram_read(const uint32_t address)
+{
+    return &memory[address];
+}
@@ -0,0 +1,64 @@
+/*! ***************************************************************************
+ *
+ * \brief     Model of the FTFA program flash in RAM
+ * \file      flash_ram.h
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef FLASH_RAM_H
+#define FLASH_RAM_H
+
+#include <stdint.h>
+
+#include "flash.h"
+
+/*!
+ * \brief Definition for the size of the modelled program flash in bytes
+ */
+#define FLASH_RAM_SIZE (128 * 1024)
+
+/*!
+ * \brief Model of the FTFA program flash in RAM
+ *
+ * Behaves like the FTFA commands that flash_erase() and flash_program()
+ * launch: an erase sets a sector to 0xFF, a program can only clear bits and
+ * fails verification (MGSTAT0) if a bit would have to be set. Misaligned and
+ * out of range addresses fail with an access error (ACCERR).
+ */
+extern const flash_t flash_ram;
+
+/// Number of commands executed since flash_ram_reset()
+typedef struct
+{
+    uint32_t erases;    ///< Sector erases
+    uint32_t programs;  ///< Programmed longwords
+} flash_ram_stats_t;
+
+void flash_ram_reset(void);
+uint8_t *flash_ram_memory(const uint32_t address);
+void flash_ram_power_fail(const uint32_t longwords);
+void flash_ram_getstats(flash_ram_stats_t *stats);
+
+#endif // FLASH_RAM_H
@@ -0,0 +1,239 @@
+/*! ***************************************************************************
+ *
+ * \brief     FreeRTOS port for the host tests
+ * \file      port.c
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ucontext.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*!
+ * \brief Definition for the size of the host stack of a task in bytes
+ *
+ * The host stack is much larger than the stack that FreeRTOS allocates,
+ * because host code such as printf() needs more stack than the target code.
+ */
+#define portHOST_STACK_SIZE (256 * 1024)
+
+/// Context of a task
+typedef struct
+{
+    ucontext_t context;         ///< Registers and stack of the task
+    TaskFunction_t code;        ///< Task function
+    void *parameters;           ///< Parameter of the task function
+} port_task_t;
+
+/// The TCB of the running task. Its first member is the top of the stack.
+extern void * volatile pxCurrentTCB;
+
+/// Simulated timer interrupt, implemented by the simulator
+extern void vPortSetupTimerInterrupt( void );
+
+/// Context of vTaskStartScheduler(), resumed by vTaskEndScheduler()
+static ucontext_t scheduler;
+
+static UBaseType_t critical_nesting = 0;
+static bool interrupts_disabled = false;
+static bool in_interrupt = false;
+static bool yield_pending = false;
+
+/*!
+ * \brief Returns the context of the running task
+ */
+static port_task_t *prvCurrentTask( void )
+{
+    StackType_t *top = *( StackType_t ** ) pxCurrentTCB;
+
+    return ( port_task_t * ) top[ 0 ];
+}
+
+/*!
+ * \brief Switches to the task selected by the scheduler
+ */
+static void prvSwitchContext( void )
+{
+    port_task_t *from = prvCurrentTask();
+
+    yield_pending = false;
+    vTaskSwitchContext();
+
+    port_task_t *to = prvCurrentTask();
+
+    if( from != to )
+    {
+        swapcontext( &from->context, &to->context );
+    }
+}
+
+/*!
+ * \brief Entry of every task
+ */
+static void prvTaskEntry( void )
+{
+    port_task_t *task = prvCurrentTask();
+
+    task->code( task->parameters );
+
+    printf( "port: task %s returned\n", pcTaskGetName( NULL ) );
+    abort();
+}
+
+StackType_t * pxPortInitialiseStack( StackType_t * pxTopOfStack,
+                                     TaskFunction_t pxCode,
+                                     void * pvParameters )
+{
+    port_task_t *task = malloc( sizeof( port_task_t ) );
+    void *stack = malloc( portHOST_STACK_SIZE );
+
+    configASSERT( ( task != NULL ) && ( stack != NULL ) );
+
+    getcontext( &task->context );
+    task->context.uc_stack.ss_sp = stack;
+    task->context.uc_stack.ss_size = portHOST_STACK_SIZE;
+    task->context.uc_link = NULL;
+    makecontext( &task->context, prvTaskEntry, 0 );
+
+    task->code = pxCode;
+    task->parameters = pvParameters;
+
+    *pxTopOfStack = ( StackType_t ) task;
+
+    return pxTopOfStack;
+}
+
+BaseType_t xPortStartScheduler( void )
+{
+    critical_nesting = 0;
+    interrupts_disabled = false;
+
+    vPortSetupTimerInterrupt();
+
+    // Returns when vTaskEndScheduler() is called
+    swapcontext( &scheduler, &prvCurrentTask()->context );
+
+    return pdFALSE;
+}
+
+void vPortEndScheduler( void )
+{
+    setcontext( &scheduler );
+}
+
+void vPortYield( void )
+{
+    if( in_interrupt || interrupts_disabled || ( critical_nesting > 0 ) )
+    {
+        yield_pending = true;
+    }
+    else
+    {
+        prvSwitchContext();
+    }
+}
+
+void vPortYieldFromISR( void )
+{
+    yield_pending = true;
+}
+
+void vPortEnterCritical( void )
+{
+    critical_nesting++;
+}
+
+void vPortExitCritical( void )
+{
+    configASSERT( critical_nesting > 0 );
+
+    critical_nesting--;
+
+    if( critical_nesting == 0 )
+    {
+        vPortYieldIfPending();
+    }
+}
+
+void vPortDisableInterrupts( void )
+{
+    interrupts_disabled = true;
+}
+
+void vPortEnableInterrupts( void )
+{
+    interrupts_disabled = false;
+    vPortYieldIfPending();
+}
+
+/*!
+ * \brief Runs an interrupt handler
+ *
+ * A context switch requested by the handler is held back until
+ * vPortYieldIfPending() is called, so several interrupts can be handled
+ * before the next task runs.
+ */
+void vPortInterrupt( void ( *pxHandler )( void ) )
+{
+    in_interrupt = true;
+    pxHandler();
+    in_interrupt = false;
+}
+
+/*!
+ * \brief Performs a context switch that was held back
+ */
+void vPortYieldIfPending( void )
+{
+    if( yield_pending && !in_interrupt && !interrupts_disabled &&
+        ( critical_nesting == 0 ) )
+    {
+        prvSwitchContext();
+    }
+}
+
+/*!
+ * \brief Returns whether an interrupt can be taken now
+ */
+BaseType_t xPortInterruptsEnabled( void )
+{
+    return ( !in_interrupt && !interrupts_disabled && ( critical_nesting == 0 ) ) ?
+           pdTRUE : pdFALSE;
+}
+
+/*!
+ * \brief Tick interrupt, called by the simulator every tick
+ */
+void xPortSysTickHandler( void )
+{
+    if( xTaskIncrementTick() != pdFALSE )
+    {
+        vPortYieldFromISR();
+    }
+}
@@ -0,0 +1,105 @@
+/*! ***************************************************************************
+ *
+ * \brief     FreeRTOS port for the host tests
+ * \file      portmacro.h
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+#include <stdint.h>
+
+/*
+ * Every task runs on its own ucontext with a stack allocated by the port, in
+ * a single host thread. The stack that FreeRTOS allocates for a task only
+ * holds a pointer to that context. Interrupts are simulated: they are only
+ * taken while the idle task runs, see sim.c. A context switch that is
+ * requested in a critical section or an interrupt is performed when the
+ * critical section is left or the interrupt returns, like PendSV does on the
+ * target.
+ */
+
+/* Type definitions. */
+#define portCHAR          char
+#define portFLOAT         float
+#define portDOUBLE        double
+#define portLONG          long
+#define portSHORT         short
+#define portSTACK_TYPE    uintptr_t
+#define portBASE_TYPE     long
+
+typedef portSTACK_TYPE   StackType_t;
+typedef long             BaseType_t;
+typedef unsigned long    UBaseType_t;
+
+typedef uint32_t         TickType_t;
+#define portMAX_DELAY    ( TickType_t ) 0xffffffffUL
+#define portPOINTER_SIZE_TYPE uintptr_t
+
+/* The host is single threaded, so the tick count can be read at any time. */
+#define portTICK_TYPE_IS_ATOMIC    1
+
+/* Architecture specifics. */
+#define portSTACK_GROWTH      ( -1 )
+#define portTICK_PERIOD_MS    ( ( TickType_t ) 1000 / configTICK_RATE_HZ )
+#define portBYTE_ALIGNMENT    16
+#define portDONT_DISCARD      __attribute__( ( used ) )
+
+/* Scheduler utilities. */
+extern void vPortYield( void );
+extern void vPortYieldFromISR( void );
+#define portYIELD()                                 vPortYield()
+#define portEND_SWITCHING_ISR( xSwitchRequired )    do { if( xSwitchRequired ) vPortYieldFromISR(); } while( 0 )
+#define portYIELD_FROM_ISR( x )                     portEND_SWITCHING_ISR( x )
+
+/* Critical section management. Simulated interrupts never preempt a task, so
+ * an interrupt doesn't need to mask other interrupts. */
+extern void vPortEnterCritical( void );
+extern void vPortExitCritical( void );
+extern void vPortDisableInterrupts( void );
+extern void vPortEnableInterrupts( void );
+
+#define portSET_INTERRUPT_MASK_FROM_ISR()         0
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR( x )    ( void ) ( x )
+#define portDISABLE_INTERRUPTS()                  vPortDisableInterrupts()
+#define portENABLE_INTERRUPTS()                   vPortEnableInterrupts()
+#define portENTER_CRITICAL()                      vPortEnterCritical()
+#define portEXIT_CRITICAL()                       vPortExitCritical()
+
+/* Simulated interrupts, used by the simulator. */
+extern void vPortInterrupt( void ( *pxHandler )( void ) );
+extern void vPortYieldIfPending( void );
+extern BaseType_t xPortInterruptsEnabled( void );
+
+/* Task function macros as described on the FreeRTOS.org WEB site. */
+#define portTASK_FUNCTION_PROTO( vFunction, pvParameters )    void vFunction( void * pvParameters )
+#define portTASK_FUNCTION( vFunction, pvParameters )          void vFunction( void * pvParameters )
+
+#define portNOP()
+
+#define portMEMORY_BARRIER()    __asm volatile ( "" ::: "memory" )
+
+#endif /* PORTMACRO_H */
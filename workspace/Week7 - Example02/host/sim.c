@@ -0,0 +1,837 @@
+/*! ***************************************************************************
+ *
+ * \brief     Simulated KL25Z for the host tests
+ * \file      sim.c
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include "sim.h"
+
+#include <signal.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*
+ * Simulated time only advances while the idle task runs: the idle hook runs
+ * the next scheduled event, e.g. the tick or the end of an I2C byte, and then
+ * takes the interrupts that the models raised. Tasks therefore run in zero
+ * time and an interrupt never preempts a task, but the order of the
+ * interrupts, the tick and the bus events is the same as on the target.
+ *
+ * The pages of the peripherals that have a model are protected. An access by
+ * a driver raises SIGSEGV, the handler lets the instruction execute with the
+ * page unprotected and the trap flag set, and the SIGTRAP after the
+ * instruction protects the page again and calls the write hook of the model.
+ */
+
+#define SIM_PAGE_SIZE   (4096)
+#define SIM_EVENTS      (64)
+#define SIM_HOOKS       (16)
+#define SIM_WATCHES     (4)
+#define SIM_IRQS        (32)
+#define SIM_MAX_IRQS    (100000)
+
+// Trap flag in EFLAGS
+#define SIM_EFLAGS_TF   (0x100)
+
+/// Memory region that is mapped at the address of the target
+typedef struct
+{
+    uintptr_t address;
+    size_t size;
+    uint8_t *model;
+} sim_region_t;
+
+static sim_region_t regions[] =
+{
+    {0x40000000, 0x00100000, NULL}, // Peripheral bridge and GPIO
+    {0xE000E000, 0x00001000, NULL}, // System control space
+};
+
+/// Hooked page
+typedef struct
+{
+    uintptr_t page;
+    sim_hook_t hook;
+} sim_page_t;
+
+static sim_page_t pages[SIM_HOOKS];
+static uint32_t n_pages = 0;
+
+/// Access in progress, between SIGSEGV and SIGTRAP
+static struct
+{
+    sim_page_t *page;
+    uintptr_t address;
+    bool write;
+    uint32_t old;
+} fault;
+
+/// Scheduled event
+typedef struct
+{
+    uint64_t time;
+    uint32_t id;
+    sim_event_t event;
+    void *context;
+} sim_slot_t;
+
+static sim_slot_t events[SIM_EVENTS];
+static uint32_t next_id = 1;
+static uint64_t now = 0;
+
+/// Interrupt request lines of the models
+static struct
+{
+    bool (*level)(void *context);
+    void *context;
+} irqs[SIM_IRQS];
+
+/// Levels of the pins
+static uint32_t external[SIM_N_PORTS];
+static uint32_t lines[SIM_N_PORTS];
+static struct
+{
+    sim_pin_watch_t watch;
+    void *context;
+} watches[SIM_N_PORTS][SIM_WATCHES];
+
+static PORT_Type *const ports[SIM_N_PORTS] = {PORTA, PORTB, PORTC, PORTD, PORTE};
+static GPIO_Type *const gpios[SIM_N_PORTS] = {PTA, PTB, PTC, PTD, PTE};
+
+/// Interrupt handlers of the drivers that are linked in
+#define SIM_WEAK __attribute__((weak))
+extern void DMA0_IRQHandler(void) SIM_WEAK;
+extern void DMA1_IRQHandler(void) SIM_WEAK;
+extern void DMA2_IRQHandler(void) SIM_WEAK;
+extern void DMA3_IRQHandler(void) SIM_WEAK;
+extern void FTFA_IRQHandler(void) SIM_WEAK;
+extern void LVD_LVW_IRQHandler(void) SIM_WEAK;
+extern void LLWU_IRQHandler(void) SIM_WEAK;
+extern void I2C0_IRQHandler(void) SIM_WEAK;
+extern void I2C1_IRQHandler(void) SIM_WEAK;
+extern void SPI0_IRQHandler(void) SIM_WEAK;
+extern void SPI1_IRQHandler(void) SIM_WEAK;
+extern void UART0_IRQHandler(void) SIM_WEAK;
+extern void UART1_IRQHandler(void) SIM_WEAK;
+extern void UART2_IRQHandler(void) SIM_WEAK;
+extern void ADC0_IRQHandler(void) SIM_WEAK;
+extern void CMP0_IRQHandler(void) SIM_WEAK;
+extern void TPM0_IRQHandler(void) SIM_WEAK;
+extern void TPM1_IRQHandler(void) SIM_WEAK;
+extern void TPM2_IRQHandler(void) SIM_WEAK;
+extern void RTC_IRQHandler(void) SIM_WEAK;
+extern void RTC_Seconds_IRQHandler(void) SIM_WEAK;
+extern void PIT_IRQHandler(void) SIM_WEAK;
+extern void USB0_IRQHandler(void) SIM_WEAK;
+extern void DAC0_IRQHandler(void) SIM_WEAK;
+extern void TSI0_IRQHandler(void) SIM_WEAK;
+extern void MCG_IRQHandler(void) SIM_WEAK;
+extern void LPTMR0_IRQHandler(void) SIM_WEAK;
+extern void PORTA_IRQHandler(void) SIM_WEAK;
+extern void PORTD_IRQHandler(void) SIM_WEAK;
+
+static void (*const vectors[SIM_IRQS])(void) =
+{
+    DMA0_IRQHandler, DMA1_IRQHandler, DMA2_IRQHandler, DMA3_IRQHandler,
+    NULL, FTFA_IRQHandler, LVD_LVW_IRQHandler, LLWU_IRQHandler,
+    I2C0_IRQHandler, I2C1_IRQHandler, SPI0_IRQHandler, SPI1_IRQHandler,
+    UART0_IRQHandler, UART1_IRQHandler, UART2_IRQHandler, ADC0_IRQHandler,
+    CMP0_IRQHandler, TPM0_IRQHandler, TPM1_IRQHandler, TPM2_IRQHandler,
+    RTC_IRQHandler, RTC_Seconds_IRQHandler, PIT_IRQHandler, NULL,
+    USB0_IRQHandler, DAC0_IRQHandler, TSI0_IRQHandler, MCG_IRQHandler,
+    LPTMR0_IRQHandler, NULL, PORTA_IRQHandler, PORTD_IRQHandler,
+};
+
+/// SystemCoreClock with CLOCK_SETUP 1, set by SystemInit() on the target
+uint32_t SystemCoreClock = 48000000;
+
+/// The test function of sim_run()
+static void (*tests)(void) = NULL;
+
+// Tick interrupt of the port
+extern void xPortSysTickHandler(void);
+
+// Local function prototypes
+static void sim_segv(int signal, siginfo_t *info, void *context);
+static void sim_trap(int signal, siginfo_t *info, void *context);
+static void sim_gpio_read(void *context, const uintptr_t address);
+static void sim_gpio_write(void *context, const uintptr_t address, const uint32_t old);
+static void sim_port_write(void *context, const uintptr_t address, const uint32_t old);
+static void sim_nvic_write(void *context, const uintptr_t address, const uint32_t old);
+static bool sim_port_level(void *context);
+static void sim_pins_changed(const sim_port_t port);
+
+/*!
+ * \brief Maps the peripherals and resets the models
+ *
+ * Call this function once, before the models are created.
+ */
+void sim_init(void)
+{
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    for(uint32_t i=0; i<(sizeof(regions)/sizeof(regions[0])); i++)
+    {
+        sim_region_t *r = &regions[i];
+
+        int fd = memfd_create("sim", 0);
+        if((fd < 0) || (ftruncate(fd, r->size) != 0))
+        {
+            sim_fail("sim: memfd_create failed");
+        }
+
+        void *target = mmap((void *)r->address, r->size, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_FIXED_NOREPLACE, fd, 0);
+        void *model = mmap(NULL, r->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+        if((target != (void *)r->address) || (model == MAP_FAILED))
+        {
+            sim_fail("sim: cannot map 0x%08lx", (unsigned long)r->address);
+        }
+
+        r->model = model;
+        close(fd);
+    }
+
+    struct sigaction sa = {0};
+    sa.sa_flags = SA_SIGINFO;
+    sa.sa_sigaction = sim_segv;
+    sigaction(SIGSEGV, &sa, NULL);
+    sa.sa_sigaction = sim_trap;
+    sigaction(SIGTRAP, &sa, NULL);
+
+    // Bus clock is the core clock divided by 2, as set by SystemInit()
+    SIM_MODEL(SIM)->CLKDIV1 = SIM_CLKDIV1_OUTDIV4(1);
+
+    for(uint32_t i=0; i<SIM_N_PORTS; i++)
+    {
+        external[i] = 0xFFFFFFFF;
+        lines[i] = 0xFFFFFFFF;
+
+        sim_hook_t port = {NULL, sim_port_write, (void *)(uintptr_t)i};
+        sim_hook((uintptr_t)ports[i], &port);
+    }
+
+    // All GPIO ports are in a single page
+    sim_hook_t gpio = {sim_gpio_read, sim_gpio_write, NULL};
+    sim_hook((uintptr_t)PTA, &gpio);
+
+    sim_hook_t nvic = {NULL, sim_nvic_write, NULL};
+    sim_hook((uintptr_t)NVIC, &nvic);
+
+    sim_irq_connect(PORTA_IRQn, sim_port_level, (void *)SIM_PORTA);
+    sim_irq_connect(PORTD_IRQn, sim_port_level, (void *)SIM_PORTD);
+}
+
+static void sim_test_task(void *pvParameters)
+{
+    (void)pvParameters;
+
+    tests();
+
+    vTaskEndScheduler();
+}
+
+/*!
+ * \brief Runs tests in a task
+ *
+ * Starts the scheduler with a task that calls the test function. Returns when
+ * the test function returns. The task has priority 3, the tests can create
+ * other tasks.
+ *
+ * \param[in]  test  Test function
+ */
+void sim_run(void (*test)(void))
+{
+    tests = test;
+
+    xTaskCreate(sim_test_task, "Test", configMINIMAL_STACK_SIZE, NULL, 3, NULL);
+    vTaskStartScheduler();
+}
+
+/*!
+ * \brief Reports an error of the simulation and ends the test program
+ */
+void sim_fail(const char *format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+
+    printf(" (at %llu us)\n", (unsigned long long)(now / SIM_US));
+    exit(1);
+}
+
+void sim_assert(const char *file, const int line)
+{
+    sim_fail("%s:%d: assertion failed", file, line);
+}
+
+/*!
+ * \brief Returns the simulated time in nanoseconds
+ */
+uint64_t sim_time(void)
+{
+    return now;
+}
+
+/*!
+ * \brief Schedules an event
+ *
+ * \param[in]  delay    Time from now in nanoseconds
+ * \param[in]  event    Called at the time
+ * \param[in]  context  Passed to the event
+ *
+ * \return Identifier of the event for sim_cancel(), never 0
+ */
+uint32_t sim_schedule(const uint64_t delay, sim_event_t event, void *context)
+{
+    for(uint32_t i=0; i<SIM_EVENTS; i++)
+    {
+        if(events[i].event == NULL)
+        {
+            events[i].time = now + delay;
+            events[i].id = next_id++;
+            events[i].event = event;
+            events[i].context = context;
+
+            return events[i].id;
+        }
+    }
+
+    sim_fail("sim: too many events");
+    return 0;
+}
+
+/*!
+ * \brief Cancels an event that has not happened yet
+ *
+ * \param[in]  id  Identifier of the event, 0 is ignored
+ */
+void sim_cancel(const uint32_t id)
+{
+    for(uint32_t i=0; (id != 0) && (i<SIM_EVENTS); i++)
+    {
+        if((events[i].event != NULL) && (events[i].id == id))
+        {
+            events[i].event = NULL;
+        }
+    }
+}
+
+/*!
+ * \brief Returns the address of a register in the model view
+ */
+void *sim_model(const uintptr_t address)
+{
+    for(uint32_t i=0; i<(sizeof(regions)/sizeof(regions[0])); i++)
+    {
+        const sim_region_t *r = &regions[i];
+
+        if((address >= r->address) && (address < (r->address + r->size)))
+        {
+            return &r->model[address - r->address];
+        }
+    }
+
+    sim_fail("sim: 0x%08lx is not mapped", (unsigned long)address);
+    return NULL;
+}
+
+/*!
+ * \brief Calls the hook on accesses of the drivers to a page
+ *
+ * \param[in]  address  Address in the page
+ * \param[in]  hook     Hook, copied
+ */
+void sim_hook(const uintptr_t address, const sim_hook_t *hook)
+{
+    if(n_pages == SIM_HOOKS)
+    {
+        sim_fail("sim: too many hooks");
+    }
+
+    pages[n_pages].page = address & ~(uintptr_t)(SIM_PAGE_SIZE - 1);
+    pages[n_pages].hook = *hook;
+
+    mprotect((void *)pages[n_pages].page, SIM_PAGE_SIZE, PROT_NONE);
+
+    n_pages++;
+}
+
+static void sim_segv(int signal, siginfo_t *info, void *context)
+{
+    ucontext_t *uc = (ucontext_t *)context;
+    const uintptr_t address = (uintptr_t)info->si_addr;
+
+    sim_page_t *page = NULL;
+    for(uint32_t i=0; i<n_pages; i++)
+    {
+        if(pages[i].page == (address & ~(uintptr_t)(SIM_PAGE_SIZE - 1)))
+        {
+            page = &pages[i];
+        }
+    }
+
+    if((page == NULL) || (fault.page != NULL))
+    {
+        // A real segmentation fault, the instruction faults again
+        struct sigaction sa = {0};
+        sa.sa_handler = SIG_DFL;
+        sigaction(signal, &sa, NULL);
+        return;
+    }
+
+    fault.page = page;
+    fault.address = address;
+    fault.write = (uc->uc_mcontext.gregs[REG_ERR] & 2) != 0;
+    fault.old = *(uint32_t *)sim_model(address & ~(uintptr_t)3);
+
+    if(!fault.write && (page->hook.read != NULL))
+    {
+        page->hook.read(page->hook.context, address);
+    }
+
+    mprotect((void *)page->page, SIM_PAGE_SIZE, PROT_READ | PROT_WRITE);
+    uc->uc_mcontext.gregs[REG_EFL] |= SIM_EFLAGS_TF;
+}
+
+static void sim_trap(int signal, siginfo_t *info, void *context)
+{
+    ucontext_t *uc = (ucontext_t *)context;
+    sim_page_t *page = fault.page;
+
+    (void)signal;
+    (void)info;
+
+    uc->uc_mcontext.gregs[REG_EFL] &= ~SIM_EFLAGS_TF;
+
+    if(page == NULL)
+    {
+        return;
+    }
+
+    mprotect((void *)page->page, SIM_PAGE_SIZE, PROT_NONE);
+    fault.page = NULL;
+
+    if(fault.write && (page->hook.write != NULL))
+    {
+        page->hook.write(page->hook.context, fault.address, fault.old);
+    }
+}
+
+/*!
+ * \brief Connects the interrupt request of a model
+ *
+ * The interrupt is level sensitive: it is pending while the level function
+ * returns true.
+ */
+void sim_irq_connect(const IRQn_Type irq, bool (*level)(void *context), void *context)
+{
+    irqs[irq].level = level;
+    irqs[irq].context = context;
+}
+
+/*!
+ * \brief Takes the pending interrupts, highest priority first
+ *
+ * \return True if an interrupt was taken
+ */
+static bool sim_dispatch(void)
+{
+    NVIC_Type *nvic = SIM_MODEL(NVIC);
+    uint32_t n = 0;
+
+    while((xPortInterruptsEnabled() == pdTRUE) && (cmsis_host_primask == 0))
+    {
+        for(uint32_t i=0; i<SIM_IRQS; i++)
+        {
+            if((irqs[i].level != NULL) && irqs[i].level(irqs[i].context))
+            {
+                nvic->ISPR[0] |= (1UL << i);
+            }
+        }
+
+        nvic->ICPR[0] = nvic->ISPR[0];
+
+        uint32_t ready = nvic->ISPR[0] & nvic->ISER[0];
+        if(ready == 0)
+        {
+            break;
+        }
+
+        // Lowest priority value first, then the lowest number
+        uint32_t irq = 0;
+        uint32_t priority = 0x100;
+        for(uint32_t i=0; i<SIM_IRQS; i++)
+        {
+            uint32_t p = (nvic->IP[i >> 2] >> ((i & 3) * 8)) & 0xC0;
+
+            if((ready & (1UL << i)) && (p < priority))
+            {
+                irq = i;
+                priority = p;
+            }
+        }
+
+        nvic->ISPR[0] &= ~(1UL << irq);
+        nvic->ICPR[0] = nvic->ISPR[0];
+
+        if(vectors[irq] == NULL)
+        {
+            sim_fail("sim: no handler for IRQ %u", (unsigned int)irq);
+        }
+
+        vPortInterrupt(vectors[irq]);
+
+        if(++n > SIM_MAX_IRQS)
+        {
+            sim_fail("sim: IRQ %u is not cleared by its handler", (unsigned int)irq);
+        }
+    }
+
+    return (n > 0);
+}
+
+/*!
+ * \brief Advances the simulated time to the next event
+ */
+static void sim_step(void)
+{
+    sim_slot_t *next = NULL;
+
+    for(uint32_t i=0; i<SIM_EVENTS; i++)
+    {
+        if((events[i].event != NULL) &&
+           ((next == NULL) || (events[i].time < next->time) ||
+            ((events[i].time == next->time) && (events[i].id < next->id))))
+        {
+            next = &events[i];
+        }
+    }
+
+    if(next == NULL)
+    {
+        sim_fail("sim: nothing scheduled");
+    }
+
+    if(next->time > SIM_TIME_LIMIT)
+    {
+        sim_fail("sim: time limit exceeded");
+    }
+
+    sim_slot_t slot = *next;
+    next->event = NULL;
+
+    now = slot.time;
+    slot.event(slot.context);
+}
+
+/*!
+ * \brief Runs the simulation while all tasks are blocked
+ */
+void vApplicationIdleHook(void)
+{
+    if(!sim_dispatch())
+    {
+        sim_step();
+        sim_dispatch();
+    }
+
+    vPortYieldIfPending();
+}
+
+static void sim_tick(void *context)
+{
+    (void)context;
+
+    sim_schedule(SIM_MS * 1000 / configTICK_RATE_HZ, sim_tick, NULL);
+    vPortInterrupt(xPortSysTickHandler);
+}
+
+/*!
+ * \brief Starts the tick, called by the port when the scheduler starts
+ */
+void vPortSetupTimerInterrupt(void)
+{
+    sim_schedule(SIM_MS * 1000 / configTICK_RATE_HZ, sim_tick, NULL);
+}
+
+static void sim_nvic_write(void *context, const uintptr_t address, const uint32_t old)
+{
+    NVIC_Type *nvic = SIM_MODEL(NVIC);
+    const uint32_t value = *(uint32_t *)sim_model(address);
+
+    (void)context;
+
+    switch(address)
+    {
+        case NVIC_BASE + offsetof(NVIC_Type, ISER): nvic->ISER[0] = old | value;  break;
+        case NVIC_BASE + offsetof(NVIC_Type, ICER): nvic->ISER[0] = old & ~value; break;
+        case NVIC_BASE + offsetof(NVIC_Type, ISPR): nvic->ISPR[0] = old | value;  break;
+        case NVIC_BASE + offsetof(NVIC_Type, ICPR): nvic->ISPR[0] = old & ~value; break;
+        default: return;
+    }
+
+    // The set and clear registers read the same state
+    nvic->ICER[0] = nvic->ISER[0];
+    nvic->ICPR[0] = nvic->ISPR[0];
+}
+
+/*!
+ * \brief Computes the levels of the pins of a port
+ *
+ * A pin with the GPIO function that is an output driving low pulls the line
+ * low, like an open-drain output. Otherwise the line has the level set with
+ * sim_pin_input(), high by default.
+ */
+static uint32_t sim_lines(const sim_port_t port)
+{
+    PORT_Type *p = SIM_MODEL(ports[port]);
+    GPIO_Type *g = SIM_MODEL(gpios[port]);
+
+    uint32_t gpio = 0;
+    for(uint32_t i=0; i<32; i++)
+    {
+        if(((p->PCR[i] & PORT_PCR_MUX_MASK) >> PORT_PCR_MUX_SHIFT) == 1)
+        {
+            gpio |= (1UL << i);
+        }
+    }
+
+    return external[port] & ~(g->PDDR & ~g->PDOR & gpio);
+}
+
+/*!
+ * \brief Sets the interrupt status flag of a pin
+ */
+static void sim_port_flag(const sim_port_t port, const uint32_t pin)
+{
+    PORT_Type *p = SIM_MODEL(ports[port]);
+
+    p->PCR[pin] |= PORT_PCR_ISF_MASK;
+    p->ISFR |= (1UL << pin);
+}
+
+/*!
+ * \brief Updates the levels of the pins of a port
+ *
+ * Detects the edges that the interrupt configuration of the pins selects and
+ * notifies the watches.
+ */
+static void sim_pins_changed(const sim_port_t port)
+{
+    PORT_Type *p = SIM_MODEL(ports[port]);
+    const uint32_t before = lines[port];
+    const uint32_t after = sim_lines(port);
+
+    if(before == after)
+    {
+        return;
+    }
+
+    lines[port] = after;
+
+    for(uint32_t i=0; i<32; i++)
+    {
+        const uint32_t mask = (1UL << i);
+
+        if(((before ^ after) & mask) == 0)
+        {
+            continue;
+        }
+
+        const bool high = (after & mask) != 0;
+
+        switch((p->PCR[i] & PORT_PCR_IRQC_MASK) >> PORT_PCR_IRQC_SHIFT)
+        {
+            case 0x8: if(!high) { sim_port_flag(port, i); } break;
+            case 0x9: if(high)  { sim_port_flag(port, i); } break;
+            case 0xA: if(!high) { sim_port_flag(port, i); } break;
+            case 0xB:             sim_port_flag(port, i);   break;
+            case 0xC: if(high)  { sim_port_flag(port, i); } break;
+            default: break;
+        }
+    }
+
+    for(uint32_t i=0; i<SIM_WATCHES; i++)
+    {
+        if(watches[port][i].watch != NULL)
+        {
+            watches[port][i].watch(watches[port][i].context, before, after);
+        }
+    }
+}
+
+/*!
+ * \brief Sets the level that a device drives on a pin
+ *
+ * \param[in]  port   Port
+ * \param[in]  pin    Pin number
+ * \param[in]  level  False if the device pulls the line low
+ */
+void sim_pin_input(const sim_port_t port, const uint32_t pin, const bool level)
+{
+    if(level)
+    {
+        external[port] |= (1UL << pin);
+    }
+    else
+    {
+        external[port] &= ~(1UL << pin);
+    }
+
+    sim_pins_changed(port);
+}
+
+/*!
+ * \brief Returns the level of a line
+ */
+bool sim_pin_level(const sim_port_t port, const uint32_t pin)
+{
+    return (sim_lines(port) & (1UL << pin)) != 0;
+}
+
+/*!
+ * \brief Calls a function when the level of pins of a port changes
+ */
+void sim_pin_watch(const sim_port_t port, sim_pin_watch_t watch, void *context)
+{
+    for(uint32_t i=0; i<SIM_WATCHES; i++)
+    {
+        if(watches[port][i].watch == NULL)
+        {
+            watches[port][i].watch = watch;
+            watches[port][i].context = context;
+            return;
+        }
+    }
+
+    sim_fail("sim: too many pin watches");
+}
+
+static void sim_gpio_read(void *context, const uintptr_t address)
+{
+    const uint32_t port = (address - (uintptr_t)PTA) / 0x40;
+
+    (void)context;
+
+    if(port < SIM_N_PORTS)
+    {
+        *(volatile uint32_t *)&SIM_MODEL(gpios[port])->PDIR = sim_lines(port);
+    }
+}
+
+static void sim_gpio_write(void *context, const uintptr_t address, const uint32_t old)
+{
+    const uint32_t port = (address - (uintptr_t)PTA) / 0x40;
+
+    (void)context;
+
+    if(port >= SIM_N_PORTS)
+    {
+        return;
+    }
+
+    GPIO_Type *g = SIM_MODEL(gpios[port]);
+    const uint32_t value = *(uint32_t *)sim_model(address);
+
+    switch((address - (uintptr_t)PTA) % 0x40)
+    {
+        case offsetof(GPIO_Type, PSOR): g->PDOR |= value;  g->PSOR = 0; break;
+        case offsetof(GPIO_Type, PCOR): g->PDOR &= ~value; g->PCOR = 0; break;
+        case offsetof(GPIO_Type, PTOR): g->PDOR ^= value;  g->PTOR = 0; break;
+        case offsetof(GPIO_Type, PDIR): *(volatile uint32_t *)&g->PDIR = old; break;
+        default: break;
+    }
+
+    sim_pins_changed(port);
+}
+
+static void sim_port_write(void *context, const uintptr_t address, const uint32_t old)
+{
+    const sim_port_t port = (sim_port_t)(uintptr_t)context;
+    PORT_Type *p = SIM_MODEL(ports[port]);
+    const uint32_t offset = address - (uintptr_t)ports[port];
+
+    if(offset < sizeof(p->PCR))
+    {
+        // ISF is cleared by writing 1, the other bits are written
+        const uint32_t pin = offset / 4;
+        const uint32_t value = p->PCR[pin];
+        const uint32_t isf = old & ~value & PORT_PCR_ISF_MASK;
+
+        p->PCR[pin] = (value & ~PORT_PCR_ISF_MASK) | isf;
+
+        if(isf == 0)
+        {
+            p->ISFR &= ~(1UL << pin);
+        }
+
+        // Level sensitive interrupts
+        const uint32_t irqc = (p->PCR[pin] & PORT_PCR_IRQC_MASK) >> PORT_PCR_IRQC_SHIFT;
+        const bool high = (lines[port] & (1UL << pin)) != 0;
+
+        if(((irqc == 0x8) && !high) || ((irqc == 0xC) && high))
+        {
+            sim_port_flag(port, pin);
+        }
+    }
+    else if(offset == offsetof(PORT_Type, ISFR))
+    {
+        const uint32_t isfr = old & ~p->ISFR;
+
+        p->ISFR = isfr;
+
+        for(uint32_t i=0; i<32; i++)
+        {
+            if((isfr & (1UL << i)) == 0)
+            {
+                p->PCR[i] &= ~PORT_PCR_ISF_MASK;
+            }
+        }
+    }
+
+    // The pin mux can change the levels
+    sim_pins_changed(port);
+}
+
+static bool sim_port_level(void *context)
+{
+    const sim_port_t port = (sim_port_t)(uintptr_t)context;
+
+    return (SIM_MODEL(ports[port])->ISFR != 0);
+}
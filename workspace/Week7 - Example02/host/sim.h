@@ -0,0 +1,107 @@
+/*! ***************************************************************************
+ *
+ * \brief     Simulated KL25Z for the host tests
+ * \file      sim.h
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef SIM_H
+#define SIM_H
+
+#include <MKL25Z4.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/*!
+ * \brief Definitions for time in nanoseconds
+ */
+#define SIM_US (1000ULL)
+#define SIM_MS (1000000ULL)
+
+/*!
+ * \brief Definition for the simulated time after which a test is aborted
+ */
+#define SIM_TIME_LIMIT (600 * 1000 * SIM_MS)
+
+/*!
+ * \brief Returns the model view of a peripheral
+ *
+ * The peripherals are mapped at their addresses on the target, so the drivers
+ * use the CMSIS device header as is. Accesses to some peripherals trap into
+ * their models. The models themselves access the registers through a second
+ * mapping of the same memory, which doesn't trap. For example:
+ * SIM_MODEL(I2C0)->S |= I2C_S_IICIF_MASK
+ */
+#define SIM_MODEL(p) ((__typeof__(p))sim_model((uintptr_t)(p)))
+
+/// Ports for sim_pin_input()
+typedef enum
+{
+    SIM_PORTA = 0,
+    SIM_PORTB,
+    SIM_PORTC,
+    SIM_PORTD,
+    SIM_PORTE,
+    SIM_N_PORTS,
+} sim_port_t;
+
+/// Called after an access to a register of a hooked page
+typedef struct
+{
+    /// Called before the register at the address is read, or NULL
+    void (*read)(void *context, const uintptr_t address);
+
+    /// Called after the register at the address has been written, with the
+    /// previous contents of the 32-bit word at the aligned address, or NULL
+    void (*write)(void *context, const uintptr_t address, const uint32_t old);
+
+    void *context;
+} sim_hook_t;
+
+/// Called when the level of pins of a port changes
+typedef void (*sim_pin_watch_t)(void *context, const uint32_t before,
+                                const uint32_t after);
+
+/// Called at a scheduled time
+typedef void (*sim_event_t)(void *context);
+
+void sim_init(void);
+void sim_run(void (*tests)(void));
+void sim_fail(const char *format, ...);
+
+uint64_t sim_time(void);
+uint32_t sim_schedule(const uint64_t delay, sim_event_t event, void *context);
+void sim_cancel(const uint32_t id);
+
+void *sim_model(const uintptr_t address);
+void sim_hook(const uintptr_t address, const sim_hook_t *hook);
+
+void sim_irq_connect(const IRQn_Type irq, bool (*level)(void *context), void *context);
+
+void sim_pin_input(const sim_port_t port, const uint32_t pin, const bool level);
+bool sim_pin_level(const sim_port_t port, const uint32_t pin);
+void sim_pin_watch(const sim_port_t port, sim_pin_watch_t watch, void *context);
+
+#endif // SIM_H
@@ -0,0 +1,611 @@
+/*! ***************************************************************************
+ *
+ * \brief     Simulated KL25Z I2C peripherals and buses
+ * \file      sim_i2c.c
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include "sim_i2c.h"
+#include "sim.h"
+
+#include <stddef.h>
+
+/// Phase of the transfer on a bus
+typedef enum
+{
+    PHASE_IDLE = 0, ///< Bus free
+    PHASE_ADDRESS,  ///< START generated, the next byte is an address
+    PHASE_TX,       ///< Master transmits data
+    PHASE_RX,       ///< Master receives data
+} sim_phase_t;
+
+/// Simulated bus with its peripheral
+typedef struct
+{
+    I2C_Type *i2c;           ///< Peripheral
+    IRQn_Type irq;           ///< Interrupt of the peripheral
+    sim_port_t port;         ///< Port of the SCL and SDA pins
+    uint32_t scl;            ///< SCL pin number
+    uint32_t sda;            ///< SDA pin number
+
+    sim_i2c_slave_t *slaves; ///< Attached slaves
+    sim_i2c_slave_t *slave;  ///< Addressed slave, or NULL
+
+    sim_phase_t phase;       ///< Phase of the transfer
+    bool start;              ///< The next byte follows a START
+    uint8_t byte;            ///< Byte being transmitted
+    uint32_t event;          ///< Byte or STOP in progress, 0 if none
+    uint64_t started;        ///< Time of the START
+
+    uint32_t nak;            ///< Addresses to NAK
+    uint32_t stuck;          ///< SCL pulses until SDA is released, 0 if free
+    uint32_t hold;           ///< Release of SCL, 0 if free
+    uint64_t hold_until;     ///< Time when SCL is released
+
+    sim_i2c_stats_t stats;
+} sim_bus_t;
+
+static sim_bus_t buses[SIM_I2C_BUSES] =
+{
+    {.i2c = I2C0, .irq = I2C0_IRQn, .port = SIM_PORTE, .scl = 24, .sda = 25},
+    {.i2c = I2C1, .irq = I2C1_IRQn, .port = SIM_PORTE, .scl =  1, .sda =  0},
+};
+
+/// SCL divider for every ICR value (KL25 Sub-Family Reference Manual, table
+/// "I2C divider and hold values")
+static const uint16_t scl_divider[64] =
+{
+      20,   22,   24,   26,   28,   30,   34,   40,
+      28,   32,   36,   40,   44,   48,   56,   68,
+      48,   56,   64,   72,   80,   88,  104,  128,
+      80,   96,  112,  128,  144,  160,  192,  240,
+     160,  192,  224,  256,  288,  320,  384,  480,
+     320,  384,  448,  512,  576,  640,  768,  960,
+     640,  768,  896, 1024, 1152, 1280, 1536, 1920,
+    1280, 1536, 1792, 2048, 2304, 2560, 3072, 3840,
+};
+
+// Register offsets
+#define REG_F   (1)
+#define REG_C1  (2)
+#define REG_S   (3)
+#define REG_D   (4)
+#define REG_FLT (6)
+
+// Local function prototypes
+static void sim_i2c_read(void *context, const uintptr_t address);
+static void sim_i2c_write(void *context, const uintptr_t address, const uint32_t old);
+static bool sim_i2c_level(void *context);
+static void sim_i2c_pins(void *context, const uint32_t before, const uint32_t after);
+
+/*!
+ * \brief Connects the peripherals to the simulation
+ *
+ * Call this function once, after sim_init().
+ */
+void sim_i2c_init(void)
+{
+    for(uint32_t i=0; i<SIM_I2C_BUSES; i++)
+    {
+        sim_bus_t *b = &buses[i];
+
+        // Reset values
+        SIM_MODEL(b->i2c)->S = I2C_S_TCF_MASK;
+
+        sim_hook_t hook = {sim_i2c_read, sim_i2c_write, b};
+        sim_hook((uintptr_t)b->i2c, &hook);
+
+        sim_irq_connect(b->irq, sim_i2c_level, b);
+    }
+
+    sim_pin_watch(SIM_PORTE, sim_i2c_pins, NULL);
+}
+
+/*!
+ * \brief Attaches a slave to a bus
+ */
+void sim_i2c_attach(const uint32_t bus, sim_i2c_slave_t *slave)
+{
+    slave->next = buses[bus].slaves;
+    buses[bus].slaves = slave;
+}
+
+/*!
+ * \brief Makes the next addresses on a bus not acknowledged
+ *
+ * \param[in]  bus  The bus
+ * \param[in]  n    Number of address bytes to NAK
+ */
+void sim_i2c_nak(const uint32_t bus, const uint32_t n)
+{
+    buses[bus].nak = n;
+}
+
+/*!
+ * \brief Makes a slave hold SDA low
+ *
+ * This is what a slave does when its transfer was interrupted in the middle
+ * of a byte that it transmits. SDA is released after the given number of SCL
+ * pulses that are generated as GPIO, 0 releases it now.
+ *
+ * \param[in]  bus     The bus
+ * \param[in]  pulses  SCL pulses until SDA is released
+ */
+void sim_i2c_stuck_sda(const uint32_t bus, const uint32_t pulses)
+{
+    sim_bus_t *b = &buses[bus];
+
+    b->stuck = pulses;
+    sim_pin_input(b->port, b->sda, (pulses == 0));
+}
+
+static void sim_i2c_release(void *context)
+{
+    sim_bus_t *b = (sim_bus_t *)context;
+
+    b->hold = 0;
+    sim_pin_input(b->port, b->scl, true);
+}
+
+/*!
+ * \brief Makes a slave hold SCL low
+ *
+ * The peripheral waits until SCL is released, as it does for clock stretching.
+ *
+ * \param[in]  bus       The bus
+ * \param[in]  duration  Time in nanoseconds
+ */
+void sim_i2c_hold_scl(const uint32_t bus, const uint64_t duration)
+{
+    sim_bus_t *b = &buses[bus];
+
+    sim_cancel(b->hold);
+    b->hold = sim_schedule(duration, sim_i2c_release, b);
+    b->hold_until = sim_time() + duration;
+    sim_pin_input(b->port, b->scl, false);
+}
+
+/*!
+ * \brief Gets the counters of a bus
+ */
+void sim_i2c_getstats(const uint32_t bus, sim_i2c_stats_t *stats)
+{
+    *stats = buses[bus].stats;
+}
+
+/*!
+ * \brief Resets the counters of a bus
+ */
+void sim_i2c_resetstats(const uint32_t bus)
+{
+    buses[bus].stats = (sim_i2c_stats_t){0};
+}
+
+/*!
+ * \brief Returns the duration of a number of bits in nanoseconds
+ *
+ * The bit rate is the bus clock divided by the SCL divider and the multiplier
+ * of the F register.
+ */
+static uint64_t sim_i2c_bits(sim_bus_t *b, const uint32_t bits)
+{
+    const uint8_t f = SIM_MODEL(b->i2c)->F;
+    const uint32_t outdiv4 = (SIM_MODEL(SIM)->CLKDIV1 & SIM_CLKDIV1_OUTDIV4_MASK) >> SIM_CLKDIV1_OUTDIV4_SHIFT;
+    const uint64_t busclock = SystemCoreClock / (outdiv4 + 1);
+    const uint64_t divider = (uint64_t)scl_divider[f & 0x3F] << ((f >> 6) & 0x03);
+
+    b->stats.bitrate = busclock / divider;
+
+    return (bits * divider * 1000000000ULL) / busclock;
+}
+
+/*!
+ * \brief Returns the time from now until a byte of 9 bits has been sent
+ *
+ * A byte directly after a START takes an extra bit. While SCL is held low by
+ * a slave, the byte doesn't start.
+ */
+static uint64_t sim_i2c_duration(sim_bus_t *b)
+{
+    uint64_t delay = sim_i2c_bits(b, b->start ? 10 : 9);
+
+    if(b->hold != 0)
+    {
+        delay += b->hold_until - sim_time();
+    }
+
+    return delay;
+}
+
+static sim_i2c_slave_t *sim_i2c_find(sim_bus_t *b, const uint8_t address)
+{
+    for(sim_i2c_slave_t *s = b->slaves; s != NULL; s = s->next)
+    {
+        if(s->address == (address & 0xFE))
+        {
+            return s;
+        }
+    }
+
+    return NULL;
+}
+
+/*!
+ * \brief Ends the byte on the bus with an interrupt
+ */
+static void sim_i2c_done(sim_bus_t *b, const bool ack)
+{
+    I2C_Type *i2c = SIM_MODEL(b->i2c);
+
+    b->event = 0;
+    b->start = false;
+    b->stats.bytes++;
+
+    if(ack)
+    {
+        i2c->S &= ~I2C_S_RXAK_MASK;
+    }
+    else
+    {
+        i2c->S |= I2C_S_RXAK_MASK;
+        b->stats.naks++;
+    }
+
+    i2c->S |= I2C_S_TCF_MASK | I2C_S_IICIF_MASK;
+}
+
+/*!
+ * \brief Loses the arbitration, the peripheral leaves master mode
+ */
+static void sim_i2c_arblost(sim_bus_t *b)
+{
+    I2C_Type *i2c = SIM_MODEL(b->i2c);
+
+    if(b->slave != NULL)
+    {
+        b->slave->stop(b->slave);
+        b->slave = NULL;
+    }
+
+    b->phase = PHASE_IDLE;
+    b->stats.arblost++;
+
+    i2c->C1 &= ~I2C_C1_MST_MASK;
+    i2c->S = (i2c->S & ~I2C_S_BUSY_MASK) | I2C_S_ARBL_MASK | I2C_S_IICIF_MASK;
+}
+
+static void sim_i2c_transmitted(void *context)
+{
+    sim_bus_t *b = (sim_bus_t *)context;
+    bool ack = false;
+
+    // A slave that holds SDA low wins the arbitration of every 1 bit
+    if(!sim_pin_level(b->port, b->sda))
+    {
+        b->event = 0;
+        sim_i2c_arblost(b);
+        return;
+    }
+
+    if(b->phase == PHASE_ADDRESS)
+    {
+        const bool read = (b->byte & 0x01) != 0;
+        sim_i2c_slave_t *s = sim_i2c_find(b, b->byte);
+
+        if(b->nak > 0)
+        {
+            b->nak--;
+        }
+        else if((s != NULL) && s->start(s, read))
+        {
+            b->slave = s;
+            ack = true;
+        }
+
+        b->phase = read ? PHASE_RX : PHASE_TX;
+    }
+    else if(b->slave != NULL)
+    {
+        ack = b->slave->write(b->slave, b->byte);
+    }
+
+    sim_i2c_done(b, ack);
+}
+
+static void sim_i2c_received(void *context)
+{
+    sim_bus_t *b = (sim_bus_t *)context;
+    I2C_Type *i2c = SIM_MODEL(b->i2c);
+
+    // Without a slave the pull-up is read
+    i2c->D = (b->slave != NULL) ? b->slave->read(b->slave) : 0xFF;
+
+    sim_i2c_done(b, (i2c->C1 & I2C_C1_TXAK_MASK) == 0);
+}
+
+/*!
+ * \brief Counts bytes that are faster than the slave allows
+ */
+static void sim_i2c_checkrate(sim_bus_t *b, const sim_i2c_slave_t *s)
+{
+    if((s != NULL) && (b->stats.bitrate > s->max_bitrate))
+    {
+        b->stats.overspeed++;
+    }
+}
+
+static void sim_i2c_transmit(sim_bus_t *b, const uint8_t data)
+{
+    if((b->event != 0) || (b->phase == PHASE_IDLE) || (b->phase == PHASE_RX))
+    {
+        b->stats.errors++;
+        return;
+    }
+
+    b->byte = data;
+    b->event = sim_schedule(sim_i2c_duration(b), sim_i2c_transmitted, b);
+
+    sim_i2c_checkrate(b, (b->phase == PHASE_ADDRESS) ? sim_i2c_find(b, data) : b->slave);
+}
+
+static void sim_i2c_receive(sim_bus_t *b)
+{
+    if((b->event != 0) || (b->phase != PHASE_RX))
+    {
+        b->stats.errors++;
+        return;
+    }
+
+    b->event = sim_schedule(sim_i2c_duration(b), sim_i2c_received, b);
+
+    sim_i2c_checkrate(b, b->slave);
+}
+
+static void sim_i2c_start(sim_bus_t *b)
+{
+    I2C_Type *i2c = SIM_MODEL(b->i2c);
+
+    if(b->slave != NULL)
+    {
+        b->slave->stop(b->slave);
+        b->slave = NULL;
+    }
+
+    b->stats.starts++;
+
+    // The START itself fails if a slave holds SDA low
+    if(!sim_pin_level(b->port, b->sda))
+    {
+        sim_i2c_arblost(b);
+        return;
+    }
+
+    if(b->phase == PHASE_IDLE)
+    {
+        b->started = sim_time();
+    }
+
+    b->phase = PHASE_ADDRESS;
+    b->start = true;
+    i2c->S |= I2C_S_BUSY_MASK;
+}
+
+static void sim_i2c_stopped(void *context)
+{
+    sim_bus_t *b = (sim_bus_t *)context;
+    I2C_Type *i2c = SIM_MODEL(b->i2c);
+
+    if(b->slave != NULL)
+    {
+        b->slave->stop(b->slave);
+        b->slave = NULL;
+    }
+
+    b->event = 0;
+    b->phase = PHASE_IDLE;
+    b->stats.stops++;
+    b->stats.busy += sim_time() - b->started;
+
+    i2c->S &= ~I2C_S_BUSY_MASK;
+    i2c->FLT |= I2C_FLT_STOPF_MASK;
+}
+
+static void sim_i2c_stop(sim_bus_t *b)
+{
+    // A byte in progress is cut short
+    sim_cancel(b->event);
+    b->event = sim_schedule(sim_i2c_bits(b, 1), sim_i2c_stopped, b);
+}
+
+/*!
+ * \brief Disabling the peripheral aborts the transfer and resets the flags
+ */
+static void sim_i2c_disable(sim_bus_t *b)
+{
+    I2C_Type *i2c = SIM_MODEL(b->i2c);
+
+    sim_cancel(b->event);
+    b->event = 0;
+
+    if(b->slave != NULL)
+    {
+        b->slave->stop(b->slave);
+        b->slave = NULL;
+    }
+
+    if(b->phase != PHASE_IDLE)
+    {
+        b->stats.busy += sim_time() - b->started;
+        b->phase = PHASE_IDLE;
+    }
+
+    i2c->C1 = 0;
+    i2c->S = I2C_S_TCF_MASK;
+    i2c->FLT &= ~I2C_FLT_STOPF_MASK;
+}
+
+static void sim_i2c_read(void *context, const uintptr_t address)
+{
+    sim_bus_t *b = (sim_bus_t *)context;
+    const I2C_Type *i2c = SIM_MODEL(b->i2c);
+
+    switch(address - (uintptr_t)b->i2c)
+    {
+        case REG_S:
+            b->stats.status_reads++;
+            break;
+
+        case REG_D:
+            // Reading the data register in receive mode starts the reception
+            // of the next byte. The byte that is read is the previous one.
+            if((i2c->C1 & I2C_C1_MST_MASK) && !(i2c->C1 & I2C_C1_TX_MASK))
+            {
+                sim_i2c_receive(b);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void sim_i2c_write(void *context, const uintptr_t address, const uint32_t old)
+{
+    sim_bus_t *b = (sim_bus_t *)context;
+    I2C_Type *i2c = SIM_MODEL(b->i2c);
+    const uint8_t before = old >> ((address & 3) * 8);
+
+    switch(address - (uintptr_t)b->i2c)
+    {
+        case REG_C1:
+        {
+            const uint8_t c1 = i2c->C1;
+
+            if(!(c1 & I2C_C1_IICEN_MASK))
+            {
+                if(before & I2C_C1_IICEN_MASK)
+                {
+                    sim_i2c_disable(b);
+                }
+                break;
+            }
+
+            if(c1 & I2C_C1_RSTA_MASK)
+            {
+                // Repeated START, the bit reads as 0
+                i2c->C1 &= ~I2C_C1_RSTA_MASK;
+
+                if((before & I2C_C1_MST_MASK) && (c1 & I2C_C1_MST_MASK))
+                {
+                    b->stats.restarts++;
+                    sim_i2c_start(b);
+                }
+            }
+
+            if(!(before & I2C_C1_MST_MASK) && (c1 & I2C_C1_MST_MASK))
+            {
+                sim_i2c_start(b);
+            }
+            else if((before & I2C_C1_MST_MASK) && !(c1 & I2C_C1_MST_MASK))
+            {
+                sim_i2c_stop(b);
+            }
+            break;
+        }
+
+        case REG_S:
+            // ARBL and IICIF are cleared by writing 1, the others are read-only
+            i2c->S = before & ~(i2c->S & (I2C_S_ARBL_MASK | I2C_S_IICIF_MASK));
+            break;
+
+        case REG_D:
+            if((i2c->C1 & I2C_C1_MST_MASK) && (i2c->C1 & I2C_C1_TX_MASK))
+            {
+                sim_i2c_transmit(b, i2c->D);
+            }
+            break;
+
+        case REG_FLT:
+        {
+            // STOPF is cleared by writing 1
+            const uint8_t flt = i2c->FLT;
+            i2c->FLT = (flt & ~I2C_FLT_STOPF_MASK) | (before & ~flt & I2C_FLT_STOPF_MASK);
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+/*!
+ * \brief Interrupt request of a peripheral
+ *
+ * The interrupt is requested by IICIF, or by STOPF if the stop detection
+ * interrupt is enabled.
+ */
+static bool sim_i2c_level(void *context)
+{
+    const sim_bus_t *b = (const sim_bus_t *)context;
+    const I2C_Type *i2c = SIM_MODEL(b->i2c);
+
+    return (i2c->C1 & I2C_C1_IICEN_MASK) && (i2c->C1 & I2C_C1_IICIE_MASK) &&
+           ((i2c->S & I2C_S_IICIF_MASK) ||
+            ((i2c->FLT & I2C_FLT_STOPF_MASK) && (i2c->FLT & I2C_FLT_STOPIE_MASK)));
+}
+
+/*!
+ * \brief Observes the lines while they are driven as GPIO
+ *
+ * Counts the SCL pulses and STOP conditions of a bus clear. A slave that holds
+ * SDA releases it in the low phase of the last configured pulse.
+ */
+static void sim_i2c_pins(void *context, const uint32_t before, const uint32_t after)
+{
+    (void)context;
+
+    for(uint32_t i=0; i<SIM_I2C_BUSES; i++)
+    {
+        sim_bus_t *b = &buses[i];
+        const uint32_t scl = (1UL << b->scl);
+        const uint32_t sda = (1UL << b->sda);
+
+        if(!(before & scl) && (after & scl))
+        {
+            b->stats.pulses++;
+        }
+
+        // The slave shifts out its next bit while SCL is low
+        if((before & scl) && !(after & scl) && (b->stuck > 0) && (--b->stuck == 0))
+        {
+            sim_pin_input(b->port, b->sda, true);
+        }
+
+        if((before & scl) && (after & scl) && !(before & sda) && (after & sda))
+        {
+            b->stats.gpio_stops++;
+        }
+    }
+}
@@ -0,0 +1,95 @@
+/*! ***************************************************************************
+ *
+ * \brief     Simulated KL25Z I2C peripherals and buses
+ * \file      sim_i2c.h
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef SIM_I2C_H
+#define SIM_I2C_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*!
+ * \brief Definition for the number of simulated buses, I2C0 and I2C1
+ */
+#define SIM_I2C_BUSES (2)
+
+/*!
+ * \brief Slave on a simulated bus
+ *
+ * A model of a device embeds this structure as its first member. The
+ * functions are called at the end of each byte on the bus.
+ */
+typedef struct sim_i2c_slave_t
+{
+    uint8_t address;       ///< 8-bit slave address, R/W bit 0
+    uint32_t max_bitrate;  ///< Highest bit rate in the datasheet
+
+    /// Address received, returns true to acknowledge it
+    bool (*start)(struct sim_i2c_slave_t *slave, const bool read);
+
+    /// Byte written by the master, returns true to acknowledge it
+    bool (*write)(struct sim_i2c_slave_t *slave, const uint8_t data);
+
+    /// Returns the next byte that the master reads
+    uint8_t (*read)(struct sim_i2c_slave_t *slave);
+
+    /// STOP or repeated START after the slave was addressed
+    void (*stop)(struct sim_i2c_slave_t *slave);
+
+    struct sim_i2c_slave_t *next;
+} sim_i2c_slave_t;
+
+/// Counters of a simulated bus
+typedef struct
+{
+    uint32_t starts;       ///< START conditions, including repeated STARTs
+    uint32_t restarts;     ///< Repeated STARTs
+    uint32_t stops;        ///< STOP conditions generated by the peripheral
+    uint32_t bytes;        ///< Bytes on the bus, including address bytes
+    uint32_t naks;         ///< Bytes that were not acknowledged
+    uint32_t arblost;      ///< STARTs that lost arbitration
+    uint32_t overspeed;    ///< Bytes faster than the max_bitrate of the slave
+    uint32_t status_reads; ///< Reads of the status register by the driver
+    uint32_t pulses;       ///< SCL pulses generated as GPIO by a bus clear
+    uint32_t gpio_stops;   ///< STOP conditions generated as GPIO
+    uint32_t errors;       ///< Register accesses that the peripheral ignores
+    uint32_t bitrate;      ///< Bit rate of the last byte
+    uint64_t busy;         ///< Total time between START and STOP in ns
+} sim_i2c_stats_t;
+
+void sim_i2c_init(void);
+void sim_i2c_attach(const uint32_t bus, sim_i2c_slave_t *slave);
+
+void sim_i2c_nak(const uint32_t bus, const uint32_t n);
+void sim_i2c_stuck_sda(const uint32_t bus, const uint32_t pulses);
+void sim_i2c_hold_scl(const uint32_t bus, const uint64_t duration);
+
+void sim_i2c_getstats(const uint32_t bus, sim_i2c_stats_t *stats);
+void sim_i2c_resetstats(const uint32_t bus);
+
+#endif // SIM_I2C_H
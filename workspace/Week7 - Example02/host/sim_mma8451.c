@@ -0,0 +1,461 @@
+/*! ***************************************************************************
+ *
+ * \brief     Behavioural model of the MMA8451Q accelerometer
+ * \file      sim_mma8451.c
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include "sim_mma8451.h"
+#include "sim.h"
+
+#include <string.h>
+
+// Registers
+#define STATUS        (0x00)
+#define OUT_X_MSB     (0x01)
+#define OUT_Z_LSB     (0x06)
+#define F_SETUP       (0x09)
+#define SYSMOD        (0x0B)
+#define INT_SOURCE    (0x0C)
+#define WHO_AM_I      (0x0D)
+#define XYZ_DATA_CFG  (0x0E)
+#define PL_STATUS     (0x10)
+#define FF_MT_SRC     (0x16)
+#define TRANSIENT_SRC (0x1E)
+#define CTRL_REG1     (0x2A)
+#define CTRL_REG2     (0x2B)
+#define CTRL_REG3     (0x2C)
+#define CTRL_REG4     (0x2D)
+#define CTRL_REG5     (0x2E)
+#define OFF_X         (0x2F)
+
+// Interrupt sources
+#define SRC_DRDY      (0x01)
+#define SRC_FF_MT     (0x04)
+#define SRC_LNDPRT    (0x10)
+#define SRC_TRANS     (0x20)
+#define SRC_FIFO      (0x40)
+
+// Pins of INT1 and INT2 on PORTA
+#define INT1_PIN      (14)
+#define INT2_PIN      (15)
+
+#define ADDRESS       (0x3A)
+#define WHO_AM_I_VAL  (0x1A)
+
+/// Sample period for every output data rate in ns
+static const uint64_t odr_period[8] =
+{
+    1250 * SIM_US, 2500 * SIM_US, 5000 * SIM_US, 10000 * SIM_US,
+    20000 * SIM_US, 80000 * SIM_US, 160000 * SIM_US, 640000 * SIM_US,
+};
+
+/// Registers that are writable, the others are read-only
+static const uint8_t writable[SIM_MMA8451_REGS] =
+{
+    [F_SETUP] = 1, [0x0A] = 1, [XYZ_DATA_CFG] = 1, [0x0F] = 1,
+    [0x11] = 1, [0x12] = 1, [0x13] = 1, [0x14] = 1, [0x15] = 1,
+    [0x17] = 1, [0x18] = 1, [0x1D] = 1, [0x1F] = 1, [0x20] = 1,
+    [0x21] = 1, [0x23] = 1, [0x24] = 1, [0x25] = 1, [0x26] = 1,
+    [0x27] = 1, [0x28] = 1, [0x29] = 1, [CTRL_REG1] = 1, [CTRL_REG2] = 1,
+    [CTRL_REG3] = 1, [CTRL_REG4] = 1, [CTRL_REG5] = 1, [OFF_X] = 1,
+    [0x30] = 1, [0x31] = 1,
+};
+
+static uint8_t mma8451_fmode(const sim_mma8451_t *m)
+{
+    return m->regs[F_SETUP] >> 6;
+}
+
+/*!
+ * \brief Drives INT1 and INT2
+ *
+ * A source is routed to INT1 if its bit in CTRL_REG5 is set, to INT2
+ * otherwise. The pins are active low unless IPOL is set.
+ */
+static void mma8451_pins(sim_mma8451_t *m)
+{
+    const uint8_t active = m->regs[INT_SOURCE] & m->regs[CTRL_REG4];
+    const bool ipol = (m->regs[CTRL_REG3] & 0x02) != 0;
+
+    sim_pin_input(SIM_PORTA, INT1_PIN, ((active & m->regs[CTRL_REG5]) != 0) == ipol);
+    sim_pin_input(SIM_PORTA, INT2_PIN, ((active & ~m->regs[CTRL_REG5]) != 0) == ipol);
+}
+
+static void mma8451_por(sim_mma8451_t *m)
+{
+    memset(m->regs, 0, sizeof(m->regs));
+    m->regs[WHO_AM_I] = WHO_AM_I_VAL;
+    m->regs[0x0F] = 0x00;
+    m->regs[0x11] = 0x80;
+    m->regs[0x13] = 0x44;
+    m->regs[0x14] = 0x84;
+
+    memset(m->output, 0, sizeof(m->output));
+    m->head = 0;
+    m->count = 0;
+    m->overflow = false;
+    m->watermark = false;
+
+    sim_cancel(m->sample);
+    m->sample = 0;
+
+    mma8451_pins(m);
+}
+
+/*!
+ * \brief Takes a sample at the output data rate
+ *
+ * The offset registers have 2 mg per LSB, which is 8 counts in the 2g range.
+ */
+static void mma8451_sample(void *context)
+{
+    sim_mma8451_t *m = (sim_mma8451_t *)context;
+    const uint32_t range = m->regs[XYZ_DATA_CFG] & 0x03;
+
+    m->sample = sim_schedule(odr_period[(m->regs[CTRL_REG1] >> 3) & 0x07], mma8451_sample, m);
+    m->samples++;
+
+    for(uint32_t i=0; i<3; i++)
+    {
+        int32_t v = (m->input[i] + (int8_t)m->regs[OFF_X + i] * 8) >> range;
+        v = (v > 8191) ? 8191 : ((v < -8192) ? -8192 : v);
+        m->output[i] = (int16_t)v;
+    }
+
+    // Data ready, overwritten if the previous sample was not read
+    if(m->regs[STATUS] & 0x08)
+    {
+        m->regs[STATUS] |= 0x80;
+    }
+    m->regs[STATUS] |= 0x08;
+    m->regs[INT_SOURCE] |= SRC_DRDY;
+
+    if(mma8451_fmode(m) != 0)
+    {
+        if(m->count == SIM_MMA8451_FIFO_SIZE)
+        {
+            m->overflow = true;
+
+            // Circular mode discards the oldest sample, fill mode stops
+            if(mma8451_fmode(m) == 1)
+            {
+                m->head = (m->head + 1) % SIM_MMA8451_FIFO_SIZE;
+                m->count--;
+            }
+        }
+
+        if(m->count < SIM_MMA8451_FIFO_SIZE)
+        {
+            memcpy(m->fifo[(m->head + m->count) % SIM_MMA8451_FIFO_SIZE], m->output,
+                   sizeof(m->output));
+            m->count++;
+        }
+
+        const uint8_t wmrk = m->regs[F_SETUP] & 0x3F;
+        const bool watermark = (wmrk > 0) && (m->count >= wmrk);
+
+        if(watermark && !m->watermark)
+        {
+            m->regs[INT_SOURCE] |= SRC_FIFO;
+        }
+        m->watermark = watermark;
+    }
+
+    mma8451_pins(m);
+}
+
+static void mma8451_reset_done(void *context)
+{
+    sim_mma8451_t *m = (sim_mma8451_t *)context;
+
+    m->reset = 0;
+    m->regs[CTRL_REG2] &= ~0x40;
+}
+
+static void mma8451_latch(sim_mma8451_t *m, const int16_t sample[3])
+{
+    // Left aligned 14-bit values
+    for(uint32_t i=0; i<3; i++)
+    {
+        const uint16_t v = (uint16_t)sample[i] << 2;
+        m->latch[i * 2] = v >> 8;
+        m->latch[i * 2 + 1] = v & 0xFF;
+    }
+}
+
+static uint8_t mma8451_read_reg(sim_mma8451_t *m, const uint8_t reg)
+{
+    uint8_t value = m->regs[reg];
+
+    switch(reg)
+    {
+        case STATUS:
+            if(mma8451_fmode(m) != 0)
+            {
+                // F_STATUS, reading it clears the FIFO interrupt
+                value = (m->overflow ? 0x80 : 0) | (m->watermark ? 0x40 : 0) | m->count;
+                m->overflow = false;
+                m->regs[INT_SOURCE] &= ~SRC_FIFO;
+            }
+            break;
+
+        case OUT_X_MSB:
+            // The sample is latched when its first byte is read
+            if(mma8451_fmode(m) != 0)
+            {
+                if(m->count > 0)
+                {
+                    mma8451_latch(m, m->fifo[m->head]);
+                    m->head = (m->head + 1) % SIM_MMA8451_FIFO_SIZE;
+                    m->count--;
+
+                    const uint8_t wmrk = m->regs[F_SETUP] & 0x3F;
+                    m->watermark = (wmrk > 0) && (m->count >= wmrk);
+                }
+            }
+            else
+            {
+                mma8451_latch(m, m->output);
+                m->regs[STATUS] = 0;
+                m->regs[INT_SOURCE] &= ~SRC_DRDY;
+            }
+            value = m->latch[0];
+            break;
+
+        case FF_MT_SRC:
+            m->regs[INT_SOURCE] &= ~SRC_FF_MT;
+            m->regs[FF_MT_SRC] = 0;
+            break;
+
+        case TRANSIENT_SRC:
+            m->regs[INT_SOURCE] &= ~SRC_TRANS;
+            m->regs[TRANSIENT_SRC] = 0;
+            break;
+
+        case PL_STATUS:
+            m->regs[INT_SOURCE] &= ~SRC_LNDPRT;
+            m->regs[PL_STATUS] &= ~0x80;
+            break;
+
+        default:
+            if((reg > OUT_X_MSB) && (reg <= OUT_Z_LSB))
+            {
+                value = m->latch[reg - OUT_X_MSB];
+            }
+            break;
+    }
+
+    mma8451_pins(m);
+
+    return value;
+}
+
+static void mma8451_write_reg(sim_mma8451_t *m, const uint8_t reg, const uint8_t value)
+{
+    // Only CTRL_REG1 and CTRL_REG2 can be written in active mode
+    if(!writable[reg] || ((m->regs[CTRL_REG1] & 0x01) && (reg != CTRL_REG1) && (reg != CTRL_REG2)))
+    {
+        m->errors++;
+        return;
+    }
+
+    if((reg == F_SETUP) && (mma8451_fmode(m) != 0) && ((value >> 6) != 0) &&
+       ((value >> 6) != mma8451_fmode(m)))
+    {
+        // The mode can only be changed with the FIFO disabled
+        m->errors++;
+        return;
+    }
+
+    if((reg == CTRL_REG2) && (value & 0x40))
+    {
+        // The device resets and doesn't acknowledge until it is done
+        mma8451_por(m);
+        m->regs[CTRL_REG2] = 0x40;
+        m->reset = sim_schedule(m->reset_time, mma8451_reset_done, m);
+        return;
+    }
+
+    const uint8_t before = m->regs[reg];
+    m->regs[reg] = value;
+
+    if(reg == F_SETUP)
+    {
+        if((value >> 6) == 0)
+        {
+            m->head = 0;
+            m->count = 0;
+            m->overflow = false;
+        }
+        m->watermark = false;
+    }
+
+    if(reg == CTRL_REG1)
+    {
+        if((value & 0x01) && !(before & 0x01))
+        {
+            m->regs[SYSMOD] = 0x01;
+            m->sample = sim_schedule(odr_period[(value >> 3) & 0x07], mma8451_sample, m);
+        }
+        else if(!(value & 0x01))
+        {
+            m->regs[SYSMOD] = 0x00;
+            sim_cancel(m->sample);
+            m->sample = 0;
+        }
+    }
+
+    mma8451_pins(m);
+}
+
+/*!
+ * \brief Returns the next register address of a burst
+ *
+ * In FIFO mode the address wraps from OUT_Z_LSB to OUT_X_MSB, so a burst
+ * reads the next samples.
+ */
+static uint8_t mma8451_next(const sim_mma8451_t *m, const uint8_t reg)
+{
+    if((reg == OUT_Z_LSB) && (mma8451_fmode(m) != 0))
+    {
+        return OUT_X_MSB;
+    }
+
+    return (reg + 1) % SIM_MMA8451_REGS;
+}
+
+static bool mma8451_start(sim_i2c_slave_t *slave, const bool read)
+{
+    sim_mma8451_t *m = (sim_mma8451_t *)slave;
+
+    if(m->reset != 0)
+    {
+        return false;
+    }
+
+    m->addressed = !read;
+    return true;
+}
+
+static bool mma8451_write(sim_i2c_slave_t *slave, const uint8_t data)
+{
+    sim_mma8451_t *m = (sim_mma8451_t *)slave;
+
+    if(m->reset != 0)
+    {
+        return false;
+    }
+
+    if(m->addressed)
+    {
+        m->addressed = false;
+        m->pointer = data % SIM_MMA8451_REGS;
+        return true;
+    }
+
+    mma8451_write_reg(m, m->pointer, data);
+    m->pointer = mma8451_next(m, m->pointer);
+
+    return true;
+}
+
+static uint8_t mma8451_read(sim_i2c_slave_t *slave)
+{
+    sim_mma8451_t *m = (sim_mma8451_t *)slave;
+
+    const uint8_t value = mma8451_read_reg(m, m->pointer);
+    m->pointer = mma8451_next(m, m->pointer);
+
+    return value;
+}
+
+static void mma8451_stop(sim_i2c_slave_t *slave)
+{
+    (void)slave;
+}
+
+/*!
+ * \brief Initialises the model and attaches it to a bus
+ *
+ * The device is in standby with the acceleration of the board lying flat.
+ */
+void sim_mma8451_init(sim_mma8451_t *m, const uint32_t bus)
+{
+    memset(m, 0, sizeof(*m));
+
+    m->slave = (sim_i2c_slave_t){ADDRESS, 400000, mma8451_start, mma8451_write,
+                                 mma8451_read, mma8451_stop, NULL};
+    m->reset_time = 1 * SIM_MS;
+    m->input[2] = 4096;
+
+    mma8451_por(m);
+    sim_i2c_attach(bus, &m->slave);
+}
+
+/*!
+ * \brief Sets the acceleration
+ *
+ * \param[in]  m        The model
+ * \param[in]  x, y, z  Acceleration in 14-bit counts of the 2g range, 4096
+ *                      counts per g
+ */
+void sim_mma8451_set(sim_mma8451_t *m, const int16_t x, const int16_t y, const int16_t z)
+{
+    m->input[0] = x;
+    m->input[1] = y;
+    m->input[2] = z;
+}
+
+/*!
+ * \brief Raises embedded function events
+ *
+ * The events are flagged in INT_SOURCE and drive the interrupt pins if
+ * they are enabled. Reading the source register of an event clears it.
+ *
+ * \param[in]  m       The model
+ * \param[in]  source  Bits of INT_SOURCE: SRC_FF_MT, SRC_LNDPRT or SRC_TRANS
+ */
+void sim_mma8451_event(sim_mma8451_t *m, const uint8_t source)
+{
+    m->regs[INT_SOURCE] |= source & (SRC_FF_MT | SRC_LNDPRT | SRC_TRANS);
+
+    if(source & SRC_FF_MT)
+    {
+        m->regs[FF_MT_SRC] = 0x80;
+    }
+
+    if(source & SRC_TRANS)
+    {
+        m->regs[TRANSIENT_SRC] = 0x40;
+    }
+
+    if(source & SRC_LNDPRT)
+    {
+        m->regs[PL_STATUS] |= 0x80;
+    }
+
+    mma8451_pins(m);
+}
@@ -0,0 +1,83 @@
+/*! ***************************************************************************
+ *
+ * \brief     Behavioural model of the MMA8451Q accelerometer
+ * \file      sim_mma8451.h
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef SIM_MMA8451_H
+#define SIM_MMA8451_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sim_i2c.h"
+
+/*!
+ * \brief Definitions for the size of the model
+ */
+#define SIM_MMA8451_REGS      (0x32)
+#define SIM_MMA8451_FIFO_SIZE (32)
+
+/*!
+ * \brief Model of an MMA8451Q
+ *
+ * The model samples the acceleration that is set with sim_mma8451_set() at
+ * the output data rate and adds the offset registers. There is no noise, no
+ * filtering and no embedded function, the events are raised by the test with
+ * sim_mma8451_event(). INT1 and INT2 are connected to PTA14 and PTA15, as on
+ * the FRDM-KL25Z.
+ */
+typedef struct
+{
+    sim_i2c_slave_t slave;           ///< Must be the first member
+
+    uint8_t regs[SIM_MMA8451_REGS];  ///< Register file
+    uint8_t pointer;                 ///< Register address
+    bool addressed;                  ///< The next written byte is the address
+
+    int16_t input[3];                ///< Acceleration in counts of the 2g range
+    int16_t output[3];               ///< Most recent sample
+    uint8_t latch[6];                ///< Sample that is being read
+
+    int16_t fifo[SIM_MMA8451_FIFO_SIZE][3];
+    uint32_t head;                   ///< Oldest sample in the FIFO
+    uint32_t count;                  ///< Samples in the FIFO
+    bool overflow;                   ///< Samples were lost
+    bool watermark;                  ///< Count is at the watermark or higher
+
+    uint32_t sample;                 ///< Sampling event, 0 if in standby
+    uint32_t reset;                  ///< Reset event, 0 if not resetting
+    uint64_t reset_time;             ///< Duration of a reset in ns
+
+    uint32_t samples;                ///< Samples taken
+    uint32_t errors;                 ///< Writes the device ignores
+} sim_mma8451_t;
+
+void sim_mma8451_init(sim_mma8451_t *m, const uint32_t bus);
+void sim_mma8451_set(sim_mma8451_t *m, const int16_t x, const int16_t y, const int16_t z);
+void sim_mma8451_event(sim_mma8451_t *m, const uint8_t source);
+
+#endif // SIM_MMA8451_H
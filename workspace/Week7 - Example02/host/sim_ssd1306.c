@@ -0,0 +1,283 @@
+/*! ***************************************************************************
+ *
+ * \brief     Behavioural model of the SSD1306 Oled controller
+ * \file      sim_ssd1306.c
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include "sim_ssd1306.h"
+#include "sim.h"
+
+#include <string.h>
+
+/*!
+ * \brief Returns the number of bytes of a command, including the command
+ *
+ * \return The length, or 0 for an unknown command
+ */
+static uint32_t ssd1306_length(const uint8_t cmd)
+{
+    switch(cmd)
+    {
+        case 0x20: case 0x23: case 0x81: case 0x8D: case 0xA8:
+        case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+            return 2;
+
+        case 0x21: case 0x22: case 0xA3:
+            return 3;
+
+        case 0x29: case 0x2A:
+            return 6;
+
+        case 0x26: case 0x27:
+            return 7;
+
+        case 0x2E: case 0x2F: case 0xA0: case 0xA1: case 0xA4: case 0xA5:
+        case 0xA6: case 0xA7: case 0xAE: case 0xAF: case 0xC0: case 0xC8:
+        case 0xE3:
+            return 1;
+
+        default:
+            // Lower and higher column start, display start line and page
+            // start in page addressing mode
+            if((cmd <= 0x1F) || ((cmd >= 0x40) && (cmd <= 0x7F)) ||
+               ((cmd >= 0xB0) && (cmd <= 0xB7)))
+            {
+                return 1;
+            }
+            return 0;
+    }
+}
+
+static void ssd1306_execute(sim_ssd1306_t *d)
+{
+    const uint8_t *c = d->command;
+
+    d->commands++;
+
+    switch(c[0])
+    {
+        case 0x20: d->mode = c[1] & 0x03; break;
+
+        case 0x21:
+            d->column_start = c[1] & 0x7F;
+            d->column_end = c[2] & 0x7F;
+            d->column = d->column_start;
+            break;
+
+        case 0x22:
+            d->page_start = c[1] & 0x07;
+            d->page_end = c[2] & 0x07;
+            d->page = d->page_start;
+            break;
+
+        case 0x23: d->fade = c[1]; break;
+
+        case 0x81:
+            d->contrast = c[1];
+
+            if(d->n_contrast < SIM_SSD1306_LOG_SIZE)
+            {
+                d->contrast_log[d->n_contrast] = c[1];
+                d->contrast_time[d->n_contrast] = sim_time();
+                d->n_contrast++;
+            }
+            break;
+
+        case 0x8D: d->charge_pump = (c[1] & 0x04) != 0; break;
+        case 0xA8: d->multiplex = c[1] & 0x3F;          break;
+        case 0xDA: d->compins = c[1];                   break;
+
+        case 0x26: case 0x27: case 0x29: case 0x2A: case 0xA3:
+            // Scroll setup, only allowed while the scroll is deactivated
+            if(d->scrolling)
+            {
+                d->errors++;
+            }
+            break;
+
+        case 0x2E: d->scrolling = false; break;
+        case 0x2F: d->scrolling = true;  break;
+        case 0xA0: d->remap = false;     break;
+        case 0xA1: d->remap = true;      break;
+        case 0xA6: d->inverse = false;   break;
+        case 0xA7: d->inverse = true;    break;
+        case 0xAE: d->on = false;        break;
+        case 0xAF: d->on = true;         break;
+        case 0xC0: d->comscan = false;   break;
+        case 0xC8: d->comscan = true;    break;
+
+        default:
+            if(c[0] <= 0x0F)
+            {
+                d->column = (d->column & 0xF0) | c[0];
+            }
+            else if(c[0] <= 0x1F)
+            {
+                d->column = (d->column & 0x0F) | ((c[0] & 0x07) << 4);
+            }
+            else if((c[0] >= 0x40) && (c[0] <= 0x7F))
+            {
+                d->start_line = c[0] & 0x3F;
+            }
+            else if((c[0] >= 0xB0) && (c[0] <= 0xB7))
+            {
+                d->page = c[0] & 0x07;
+            }
+            break;
+    }
+}
+
+static void ssd1306_command(sim_ssd1306_t *d, const uint8_t byte)
+{
+    if(d->received == 0)
+    {
+        d->expected = ssd1306_length(byte);
+
+        if(d->expected == 0)
+        {
+            d->errors++;
+            return;
+        }
+    }
+
+    d->command[d->received++] = byte;
+
+    if(d->received == d->expected)
+    {
+        ssd1306_execute(d);
+        d->received = 0;
+    }
+}
+
+/*!
+ * \brief Writes a byte into the GDDRAM and advances the address
+ */
+static void ssd1306_data(sim_ssd1306_t *d, const uint8_t byte)
+{
+    // Writing the RAM during a scroll corrupts it
+    if(d->scrolling)
+    {
+        d->errors++;
+    }
+
+    d->gddram[d->page][d->column] = byte;
+    d->data_bytes++;
+
+    switch(d->mode)
+    {
+        case 0:
+            if(d->column++ == d->column_end)
+            {
+                d->column = d->column_start;
+                d->page = (d->page == d->page_end) ? d->page_start : d->page + 1;
+            }
+            break;
+
+        case 1:
+            if(d->page++ == d->page_end)
+            {
+                d->page = d->page_start;
+                d->column = (d->column == d->column_end) ? d->column_start : d->column + 1;
+            }
+            break;
+
+        default:
+            d->column = (d->column + 1) % SIM_SSD1306_COLUMNS;
+            break;
+    }
+}
+
+static bool ssd1306_start(sim_i2c_slave_t *slave, const bool read)
+{
+    sim_ssd1306_t *d = (sim_ssd1306_t *)slave;
+
+    // The status can't be read over I2C
+    d->control = true;
+    return !read;
+}
+
+static bool ssd1306_write(sim_i2c_slave_t *slave, const uint8_t byte)
+{
+    sim_ssd1306_t *d = (sim_ssd1306_t *)slave;
+
+    if(d->control)
+    {
+        d->continuation = (byte & 0x80) != 0;
+        d->data = (byte & 0x40) != 0;
+        d->control = false;
+        return true;
+    }
+
+    if(d->data)
+    {
+        ssd1306_data(d, byte);
+    }
+    else
+    {
+        ssd1306_command(d, byte);
+    }
+
+    // After a byte with Co = 1 another control byte follows
+    d->control = d->continuation;
+
+    return true;
+}
+
+static uint8_t ssd1306_read(sim_i2c_slave_t *slave)
+{
+    (void)slave;
+    return 0xFF;
+}
+
+static void ssd1306_stop(sim_i2c_slave_t *slave)
+{
+    (void)slave;
+}
+
+/*!
+ * \brief Initialises the model in its reset state and attaches it to a bus
+ *
+ * \param[in]  d        The model
+ * \param[in]  bus      The bus
+ * \param[in]  address  8-bit slave address, 0x78 or 0x7A
+ */
+void sim_ssd1306_init(sim_ssd1306_t *d, const uint32_t bus, const uint8_t address)
+{
+    memset(d, 0, sizeof(*d));
+
+    d->slave = (sim_i2c_slave_t){address, 400000, ssd1306_start, ssd1306_write,
+                                 ssd1306_read, ssd1306_stop, NULL};
+
+    // Reset values of the datasheet
+    d->mode = 2;
+    d->column_end = SIM_SSD1306_COLUMNS - 1;
+    d->page_end = SIM_SSD1306_PAGES - 1;
+    d->multiplex = 63;
+    d->compins = 0x12;
+    d->contrast = 0x7F;
+
+    sim_i2c_attach(bus, &d->slave);
+}
@@ -0,0 +1,97 @@
+/*! ***************************************************************************
+ *
+ * \brief     Behavioural model of the SSD1306 Oled controller
+ * \file      sim_ssd1306.h
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef SIM_SSD1306_H
+#define SIM_SSD1306_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sim_i2c.h"
+
+/*!
+ * \brief Definitions for the size of the GDDRAM and the contrast log
+ */
+#define SIM_SSD1306_COLUMNS  (128)
+#define SIM_SSD1306_PAGES    (8)
+#define SIM_SSD1306_LOG_SIZE (32)
+
+/*!
+ * \brief Model of an SSD1306
+ *
+ * The model parses the control bytes and the commands and writes the data
+ * bytes into the GDDRAM with the addressing mode and window of the commands.
+ * It keeps the state that the commands set, but does not render the display
+ * or perform a scroll or fade.
+ */
+typedef struct
+{
+    sim_i2c_slave_t slave;   ///< Must be the first member
+
+    uint8_t gddram[SIM_SSD1306_PAGES][SIM_SSD1306_COLUMNS];
+
+    // Parser
+    bool control;            ///< The next byte is a control byte
+    bool continuation;       ///< Co bit of the last control byte
+    bool data;               ///< D/C# bit of the last control byte
+    uint8_t command[8];      ///< Command and its arguments
+    uint32_t received;       ///< Bytes of the command received
+    uint32_t expected;       ///< Bytes of the command
+
+    // Addressing
+    uint8_t mode;            ///< 0 horizontal, 1 vertical, 2 page
+    uint8_t column_start, column_end, column;
+    uint8_t page_start, page_end, page;
+
+    // Display state
+    bool on;
+    bool inverse;
+    bool remap;              ///< Segment re-map, column 127 is SEG0
+    bool comscan;            ///< COM output scan direction remapped
+    bool charge_pump;
+    bool scrolling;
+    uint8_t start_line;
+    uint8_t multiplex;
+    uint8_t compins;
+    uint8_t contrast;
+    uint8_t fade;
+
+    // Contrast changes with their time
+    uint32_t n_contrast;
+    uint8_t contrast_log[SIM_SSD1306_LOG_SIZE];
+    uint64_t contrast_time[SIM_SSD1306_LOG_SIZE];
+
+    uint32_t commands;       ///< Commands executed
+    uint32_t data_bytes;     ///< Bytes written into the GDDRAM
+    uint32_t errors;         ///< Unknown commands and writes during a scroll
+} sim_ssd1306_t;
+
+void sim_ssd1306_init(sim_ssd1306_t *d, const uint32_t bus, const uint8_t address);
+
+#endif // SIM_SSD1306_H
@@ -0,0 +1,81 @@
+/*! ***************************************************************************
+ *
+ * \brief     Minimal test framework for the host tests
+ * \file      test.c
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include "test.h"
+
+#include <stdio.h>
+
+static uint32_t tests = 0;
+static uint32_t failures = 0;
+static const char *current = "";
+
+void test_check(const bool cond, const char *text, const char *file,
+                const int line)
+{
+    if(!cond)
+    {
+        printf("%s:%d: %s: check failed: %s\n", file, line, current, text);
+        failures++;
+    }
+}
+
+void test_equal(const int64_t actual, const int64_t expected,
+                const char *text, const char *file, const int line)
+{
+    if(actual != expected)
+    {
+        printf("%s:%d: %s: %s is %lld, expected %lld\n", file, line, current,
+               text, (long long)actual, (long long)expected);
+        failures++;
+    }
+}
+
+void test_run(void (*test)(void), const char *name)
+{
+    uint32_t before = failures;
+
+    current = name;
+    test();
+    tests++;
+
+    printf("%s %s\n", (failures == before) ? "pass" : "FAIL", name);
+}
+
+/*!
+ * \brief Prints the summary
+ *
+ * \return Exit code of the test program, 0 if all checks passed
+ */
+int test_report(void)
+{
+    printf("%u tests, %u failed checks\n", (unsigned int)tests,
+           (unsigned int)failures);
+
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+/*! ***************************************************************************
+ *
+ * \brief     Minimal test framework for the host tests
+ * \file      test.h
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*!
+ * \brief Checks a condition
+ *
+ * A failed check is reported with its file and line, the test continues.
+ */
+#define TEST_CHECK(cond) \
+    test_check((cond), #cond, __FILE__, __LINE__)
+
+/*!
+ * \brief Checks that two integers are equal
+ */
+#define TEST_EQUAL(actual, expected) \
+    test_equal((int64_t)(actual), (int64_t)(expected), #actual, __FILE__, __LINE__)
+
+/*!
+ * \brief Runs a test function
+ */
+#define TEST_RUN(test) \
+    test_run(test, #test)
+
+void test_check(const bool cond, const char *text, const char *file,
+                const int line);
+void test_equal(const int64_t actual, const int64_t expected,
+                const char *text, const char *file, const int line);
+void test_run(void (*test)(void), const char *name);
+int test_report(void);
+
+#endif // TEST_H
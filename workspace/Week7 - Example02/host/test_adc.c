@@ -0,0 +1,190 @@
+/*! ***************************************************************************
+ *
+ * \brief     Tests of the ADC0 calibration against a model of the calibration
+ * \file      test_adc.c
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include <stddef.h>
+
+#include "adc.h"
+#include "sim.h"
+#include "test.h"
+
+/// Calibration values that the model reports, CLPS to CLP0 and CLMS to CLM0
+/// in register order
+static uint32_t clp[ADC_GAIN_VALUES];
+static uint32_t clm[ADC_GAIN_VALUES];
+static bool fail = false;
+
+/*!
+ * \brief Model of the calibration function of ADC0
+ *
+ * Setting CAL completes the calibration at once: the calibration values and
+ * OFS are written, CAL is cleared and COCO is set. CALF is cleared by
+ * writing 1.
+ */
+static void adc_write(void *context, const uintptr_t address, const uint32_t old)
+{
+    ADC_Type *adc = SIM_MODEL(ADC0);
+
+    (void)context;
+
+    if(address != (uintptr_t)&ADC0->SC3)
+    {
+        return;
+    }
+
+    const uint32_t sc3 = adc->SC3;
+    adc->SC3 = (sc3 & ~(ADC_SC3_CALF_MASK | ADC_SC3_CAL_MASK)) |
+               (old & ~sc3 & ADC_SC3_CALF_MASK);
+
+    if(sc3 & ADC_SC3_CAL_MASK)
+    {
+        uint32_t *p = (uint32_t *)&adc->CLPS;
+        uint32_t *m = (uint32_t *)&adc->CLMS;
+
+        for(uint32_t i=0; i<ADC_GAIN_VALUES; i++)
+        {
+            p[i] = clp[i];
+            m[i] = clm[i];
+        }
+
+        adc->OFS = 0x0004;
+        adc->SC1[0] |= ADC_SC1_COCO_MASK;
+
+        if(fail)
+        {
+            adc->SC3 |= ADC_SC3_CALF_MASK;
+        }
+    }
+}
+
+/*!
+ * \brief The formula of the reference manual
+ */
+static uint16_t reference(const uint32_t cl[ADC_GAIN_VALUES])
+{
+    uint16_t sum = 0;
+
+    for(uint32_t i=0; i<ADC_GAIN_VALUES; i++)
+    {
+        sum += cl[i];
+    }
+
+    return (sum / 2) | 0x8000;
+}
+
+static uint16_t gain(const uint32_t cl[ADC_GAIN_VALUES])
+{
+    // CLx0 to CLx4 and CLxS
+    const uint16_t values[ADC_GAIN_VALUES] = {cl[5], cl[4], cl[3], cl[2], cl[1], cl[0]};
+
+    return adc_gain(values);
+}
+
+static void test_gain(void)
+{
+    // Widths of CLxS, CLx4, CLx3, CLx2, CLx1 and CLx0
+    static const uint32_t max[ADC_GAIN_VALUES] = {0x3F, 0x3FF, 0x1FF, 0xFF, 0x7F, 0x3F};
+    uint32_t cl[ADC_GAIN_VALUES] = {0};
+
+    TEST_EQUAL(gain(cl), 0x8000);
+
+    TEST_EQUAL(gain(max), 0x8000 | ((0x3F + 0x3FF + 0x1FF + 0xFF + 0x7F + 0x3F) / 2));
+
+    // Typical values of a KL25Z
+    const uint32_t typical[ADC_GAIN_VALUES] = {0x2E, 0x2E4, 0x172, 0xB9, 0x5C, 0x2E};
+    TEST_EQUAL(gain(typical), 0x8000 | (0x2E + 0x2E4 + 0x172 + 0xB9 + 0x5C + 0x2E) / 2);
+
+    uint32_t seed = 1;
+    for(uint32_t n=0; n<10000; n++)
+    {
+        for(uint32_t i=0; i<ADC_GAIN_VALUES; i++)
+        {
+            seed = seed * 1103515245 + 12345;
+            cl[i] = (seed >> 16) & max[i];
+        }
+
+        TEST_EQUAL(gain(cl), reference(cl));
+    }
+
+    // The unimplemented bits read as 0 on the target, but are ignored anyway
+    for(uint32_t i=0; i<ADC_GAIN_VALUES; i++)
+    {
+        cl[i] = max[i] | 0xFC00;
+    }
+    TEST_EQUAL(gain(cl), gain(max));
+}
+
+static void test_calibrate(void)
+{
+    adc_calibration_t c;
+
+    const uint32_t p[ADC_GAIN_VALUES] = {0x2E, 0x2E4, 0x172, 0xB9, 0x5C, 0x2E};
+    const uint32_t m[ADC_GAIN_VALUES] = {0x2D, 0x2DC, 0x16E, 0xB7, 0x5B, 0x2D};
+
+    for(uint32_t i=0; i<ADC_GAIN_VALUES; i++)
+    {
+        clp[i] = p[i];
+        clm[i] = m[i];
+    }
+
+    TEST_CHECK(!adc_calibration(&c));
+
+    adc_init();
+
+    TEST_CHECK(adc_calibration(&c));
+    TEST_EQUAL(c.pg, reference(p));
+    TEST_EQUAL(c.mg, reference(m));
+    TEST_EQUAL(c.ofs, 0x0004);
+    TEST_CHECK(!c.cached);
+
+    // The configuration of adc_init() is restored
+    TEST_EQUAL(SIM_MODEL(ADC0)->CFG1, 0x9D);
+    TEST_EQUAL(SIM_MODEL(ADC0)->SC2, 0);
+    TEST_EQUAL(SIM_MODEL(ADC0)->SC3 & ADC_SC3_AVGE_MASK, 0);
+
+    // A failed calibration keeps the gains
+    fail = true;
+    clp[0] = 0;
+    TEST_CHECK(!adc_calibrate());
+    TEST_CHECK(!adc_calibration(&c));
+    TEST_EQUAL(SIM_MODEL(ADC0)->PG, reference(p));
+    fail = false;
+}
+
+int main(void)
+{
+    sim_init();
+
+    sim_hook_t adc = {NULL, adc_write, NULL};
+    sim_hook((uintptr_t)ADC0, &adc);
+
+    TEST_RUN(test_gain);
+    TEST_RUN(test_calibrate);
+
+    return test_report();
+}
@@ -0,0 +1,196 @@
+/*! ***************************************************************************
+ *
+ * \brief     Tests of the fixed-point math against the C library
+ * \file      test_fixmath.c
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include <math.h>
+#include <stdlib.h>
+
+#include "fixmath.h"
+#include "test.h"
+
+/// Error bound of q16_atan2() in radians, as documented in fixmath.c
+#define ATAN2_MAX_ERROR (0.0016)
+
+/// Maximum error of q16_sqrt() and q16_recip() in LSB
+#define Q16_MAX_ERROR   (1.0)
+
+/*!
+ * \brief Converts a Q16.16 number to a double
+ */
+static double q16_to_double(const q16_t x)
+{
+    return (double)x / Q16_ONE;
+}
+
+/*!
+ * \brief Random integer in the range [-range,range]
+ */
+static int32_t random_range(const int32_t range)
+{
+    return (int32_t)(((int64_t)rand() * (2 * (int64_t)range + 1)) / ((int64_t)RAND_MAX + 1)) - range;
+}
+
+/*!
+ * \brief isqrt32() is exact for all squares, their neighbours and random
+ *        values
+ */
+static void test_isqrt32(void)
+{
+    uint32_t errors = 0;
+
+    for(uint32_t r = 0; r < 65536; r++)
+    {
+        const uint32_t sq = r * r;
+
+        errors += (isqrt32(sq) != r);
+        errors += (sq > 0) && (isqrt32(sq - 1) != r - 1);
+        errors += (r < 65535) && (isqrt32(sq + 2 * r) != r);
+    }
+
+    for(uint32_t i = 0; i < 100000; i++)
+    {
+        const uint32_t x = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+        const uint32_t r = isqrt32(x);
+
+        errors += ((uint64_t)r * r > x) || ((uint64_t)(r + 1) * (r + 1) <= x);
+    }
+
+    TEST_EQUAL(errors, 0);
+    TEST_EQUAL(isqrt32(UINT32_MAX), 65535);
+}
+
+/*!
+ * \brief q16_sqrt() is within 1 LSB of sqrt() and never rounds up
+ */
+static void test_q16_sqrt(void)
+{
+    double max_error = 0;
+
+    for(uint32_t i = 0; i < 100000; i++)
+    {
+        const q16_t x = (q16_t)(((uint32_t)rand() << 16) ^ (uint32_t)rand()) & INT32_MAX;
+        const double expected = sqrt(q16_to_double(x)) * Q16_ONE;
+        const double error = expected - q16_sqrt(x);
+
+        TEST_CHECK(error >= 0);
+        max_error = fmax(max_error, error);
+    }
+
+    TEST_CHECK(max_error < Q16_MAX_ERROR);
+    TEST_EQUAL(q16_sqrt(Q16(4)), Q16(2));
+    TEST_EQUAL(q16_sqrt(Q16_ONE), Q16_ONE);
+    TEST_EQUAL(q16_sqrt(0), 0);
+    TEST_EQUAL(q16_sqrt(-Q16_ONE), 0);
+}
+
+/*!
+ * \brief q16_recip() is within 1 LSB of 1/x and saturates
+ */
+static void test_q16_recip(void)
+{
+    double max_error = 0;
+
+    for(uint32_t i = 0; i < 100000; i++)
+    {
+        q16_t x = random_range(INT32_MAX);
+
+        if((x >= -1) && (x <= 1))
+        {
+            continue;
+        }
+
+        const double expected = Q16_ONE / q16_to_double(x);
+        max_error = fmax(max_error, fabs(expected - q16_recip(x)));
+    }
+
+    TEST_CHECK(max_error < Q16_MAX_ERROR);
+    TEST_EQUAL(q16_recip(Q16(2)), Q16(0.5));
+    TEST_EQUAL(q16_recip(-Q16(4)), -Q16(0.25));
+    TEST_EQUAL(q16_recip(0), INT32_MAX);
+    TEST_EQUAL(q16_recip(1), INT32_MAX);
+    TEST_EQUAL(q16_recip(-1), INT32_MIN);
+}
+
+/*!
+ * \brief q16_atan2() is within the documented error in all four quadrants
+ *
+ * The full circle is swept at several radii, including the 14-bit range of
+ * the accelerometer, and random arguments cover the full int32_t range.
+ */
+static void test_q16_atan2(void)
+{
+    static const int32_t radius[] = {1, 100, 4096, 8191, 1000000, INT32_MAX / 2};
+    double max_error = 0;
+
+    for(uint32_t i = 0; i < sizeof(radius) / sizeof(radius[0]); i++)
+    {
+        for(uint32_t step = 0; step < 3600; step++)
+        {
+            const double a = step * (2 * M_PI / 3600);
+            const int32_t y = (int32_t)lround(radius[i] * sin(a));
+            const int32_t x = (int32_t)lround(radius[i] * cos(a));
+
+            if((x == 0) && (y == 0))
+            {
+                continue;
+            }
+
+            max_error = fmax(max_error, fabs(atan2(y, x) - q16_to_double(q16_atan2(y, x))));
+        }
+    }
+
+    for(uint32_t i = 0; i < 100000; i++)
+    {
+        const int32_t y = random_range(INT32_MAX);
+        const int32_t x = random_range(INT32_MAX);
+
+        max_error = fmax(max_error, fabs(atan2(y, x) - q16_to_double(q16_atan2(y, x))));
+    }
+
+    TEST_CHECK(max_error < ATAN2_MAX_ERROR);
+
+    // Axes and the special case
+    TEST_EQUAL(q16_atan2(0, 0), 0);
+    TEST_EQUAL(q16_atan2(0, 1000), 0);
+    TEST_EQUAL(q16_atan2(1000, 0), Q16_PI / 2);
+    TEST_EQUAL(q16_atan2(-1000, 0), -(Q16_PI / 2));
+    TEST_EQUAL(q16_atan2(0, -1000), Q16_PI);
+    TEST_EQUAL(q16_atan2(INT32_MIN, INT32_MIN), -(Q16_PI - Q16_PI / 4));
+}
+
+int main(void)
+{
+    srand(32);
+
+    TEST_RUN(test_isqrt32);
+    TEST_RUN(test_q16_sqrt);
+    TEST_RUN(test_q16_recip);
+    TEST_RUN(test_q16_atan2);
+
+    return test_report();
+}
@@ -0,0 +1,201 @@
+/*! ***************************************************************************
+ *
+ * \brief     Host tests of the flash records
+ * \file      test_flash.c
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include <stddef.h>
+#include <string.h>
+
+#include "flash.h"
+#include "flash_ram.h"
+#include "test.h"
+
+#define ADDRESS (FLASH_DATA_ADDRESS)
+#define MAGIC   (0x54534554)
+
+// A record like the calibration record of the MMA8451Q
+typedef struct
+{
+    flash_record_t header;
+    int8_t offset[3];
+    uint8_t reserved;
+    uint32_t crc;
+} record_t;
+
+static record_t record(const uint16_t version, const int8_t x,
+                       const int8_t y, const int8_t z)
+{
+    record_t r =
+    {
+        .header = {.magic = MAGIC, .version = version},
+        .offset = {x, y, z},
+    };
+
+    return r;
+}
+
+static void test_crc32(void)
+{
+    TEST_EQUAL(flash_crc32("123456789", 9), 0xCBF43926);
+    TEST_EQUAL(flash_crc32("", 0), 0x00000000);
+}
+
+static void test_round_trip(void)
+{
+    flash_ram_reset();
+
+    record_t w = record(1, -12, 34, -56);
+    TEST_EQUAL(flash_record_write(&flash_ram, ADDRESS, &w, sizeof(w)), FLASH_OK);
+    TEST_EQUAL(w.header.size, sizeof(w));
+
+    record_t r = record(1, 0, 0, 0);
+    TEST_CHECK(flash_record_read(&flash_ram, ADDRESS, &r, sizeof(r)));
+    TEST_CHECK(memcmp(&r, &w, sizeof(r)) == 0);
+
+    // A second write replaces the record
+    w = record(1, 1, 2, 3);
+    TEST_EQUAL(flash_record_write(&flash_ram, ADDRESS, &w, sizeof(w)), FLASH_OK);
+    TEST_CHECK(flash_record_read(&flash_ram, ADDRESS, &r, sizeof(r)));
+    TEST_EQUAL(r.offset[0], 1);
+    TEST_EQUAL(r.offset[1], 2);
+    TEST_EQUAL(r.offset[2], 3);
+
+    flash_ram_stats_t stats;
+    flash_ram_getstats(&stats);
+    TEST_EQUAL(stats.erases, 2);
+    TEST_EQUAL(stats.programs, 2 * (sizeof(w) / 4));
+}
+
+static void test_erased(void)
+{
+    flash_ram_reset();
+
+    record_t r = record(1, 7, 8, 9);
+    TEST_CHECK(!flash_record_read(&flash_ram, ADDRESS, &r, sizeof(r)));
+
+    // Not changed
+    TEST_EQUAL(r.offset[0], 7);
+    TEST_EQUAL(r.offset[1], 8);
+    TEST_EQUAL(r.offset[2], 9);
+}
+
+static void test_mismatch(void)
+{
+    flash_ram_reset();
+
+    record_t w = record(2, 1, 2, 3);
+    TEST_EQUAL(flash_record_write(&flash_ram, ADDRESS, &w, sizeof(w)), FLASH_OK);
+
+    // Version
+    record_t r = record(1, 0, 0, 0);
+    TEST_CHECK(!flash_record_read(&flash_ram, ADDRESS, &r, sizeof(r)));
+    TEST_EQUAL(r.offset[0], 0);
+
+    // Magic
+    r = record(2, 0, 0, 0);
+    r.header.magic = ~MAGIC;
+    TEST_CHECK(!flash_record_read(&flash_ram, ADDRESS, &r, sizeof(r)));
+
+    // Size: a record that has grown by a longword
+    uint32_t larger[sizeof(record_t) / 4 + 1] = {0};
+    memcpy(larger, &r, sizeof(flash_record_t));
+    ((flash_record_t *)larger)->magic = MAGIC;
+    TEST_CHECK(!flash_record_read(&flash_ram, ADDRESS, larger, sizeof(larger)));
+
+    // Still valid with the expected header
+    r = record(2, 0, 0, 0);
+    TEST_CHECK(flash_record_read(&flash_ram, ADDRESS, &r, sizeof(r)));
+
+    // CRC: flip a single bit of the payload
+    *flash_ram_memory(ADDRESS + offsetof(record_t, offset)) ^= 0x01;
+    r = record(2, 0, 0, 0);
+    TEST_CHECK(!flash_record_read(&flash_ram, ADDRESS, &r, sizeof(r)));
+    TEST_EQUAL(r.offset[0], 0);
+
+    // CRC: flip a single bit of the stored CRC
+    *flash_ram_memory(ADDRESS + offsetof(record_t, offset)) ^= 0x01;
+    *flash_ram_memory(ADDRESS + offsetof(record_t, crc) + 3) ^= 0x80;
+    TEST_CHECK(!flash_record_read(&flash_ram, ADDRESS, &r, sizeof(r)));
+}
+
+static void test_torn_write(void)
+{
+    const uint32_t n = sizeof(record_t) / 4;
+
+    // Power fails after programming 0 .. n-1 longwords
+    for(uint32_t i=0; i<n; i++)
+    {
+        flash_ram_reset();
+
+        record_t w = record(1, 4, 5, 6);
+        TEST_EQUAL(flash_record_write(&flash_ram, ADDRESS, &w, sizeof(w)), FLASH_OK);
+
+        flash_ram_power_fail(i);
+        w = record(1, -4, -5, -6);
+        TEST_CHECK(flash_record_write(&flash_ram, ADDRESS, &w, sizeof(w)) != FLASH_OK);
+
+        // Neither the old nor the partial new record is accepted
+        record_t r = record(1, 0, 0, 0);
+        TEST_CHECK(!flash_record_read(&flash_ram, ADDRESS, &r, sizeof(r)));
+        TEST_EQUAL(r.offset[0], 0);
+    }
+}
+
+static void test_invalid(void)
+{
+    flash_ram_reset();
+
+    record_t w = record(1, 1, 2, 3);
+
+    // Not a multiple of 4 bytes
+    TEST_EQUAL(flash_record_write(&flash_ram, ADDRESS, &w, sizeof(w) - 1),
+               FLASH_ALIGNMENT);
+
+    // No room for the CRC
+    TEST_EQUAL(flash_record_write(&flash_ram, ADDRESS, &w,
+                                  sizeof(flash_record_t)), FLASH_ALIGNMENT);
+
+    // Not the start of a sector
+    TEST_EQUAL(flash_record_write(&flash_ram, ADDRESS + 4, &w, sizeof(w)),
+               FLASH_ACCESS);
+
+    flash_ram_stats_t stats;
+    flash_ram_getstats(&stats);
+    TEST_EQUAL(stats.programs, 0);
+}
+
+int main(void)
+{
+    TEST_RUN(test_crc32);
+    TEST_RUN(test_round_trip);
+    TEST_RUN(test_erased);
+    TEST_RUN(test_mismatch);
+    TEST_RUN(test_torn_write);
+    TEST_RUN(test_invalid);
+
+    return test_report();
+}
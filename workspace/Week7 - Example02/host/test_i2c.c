@@ -0,0 +1,524 @@
+/*! ***************************************************************************
+ *
+ * \brief     Tests of the I2C driver against the simulated buses
+ * \file      test_i2c.c
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include <string.h>
+
+#include "i2c.h"
+#include "sim.h"
+#include "sim_i2c.h"
+#include "test.h"
+
+#define ADDRESS      (0xA0)
+#define SLOW_ADDRESS (0xA2)
+
+// A memory with an address pointer, like a serial EEPROM
+typedef struct
+{
+    sim_i2c_slave_t slave;
+    uint8_t memory[256];
+    uint8_t pointer;
+    bool addressed;   ///< The next written byte is the pointer
+} memory_t;
+
+static memory_t memory[SIM_I2C_BUSES];
+static memory_t slow;
+
+static bool memory_start(sim_i2c_slave_t *slave, const bool read)
+{
+    memory_t *m = (memory_t *)slave;
+
+    m->addressed = !read;
+    return true;
+}
+
+static bool memory_write(sim_i2c_slave_t *slave, const uint8_t data)
+{
+    memory_t *m = (memory_t *)slave;
+
+    if(m->addressed)
+    {
+        m->pointer = data;
+        m->addressed = false;
+    }
+    else
+    {
+        m->memory[m->pointer++] = data;
+    }
+
+    return true;
+}
+
+static uint8_t memory_read(sim_i2c_slave_t *slave)
+{
+    memory_t *m = (memory_t *)slave;
+
+    return m->memory[m->pointer++];
+}
+
+static void memory_stop(sim_i2c_slave_t *slave)
+{
+    (void)slave;
+}
+
+/*!
+ * \brief Returns the time of a number of bits at the default bit rate in ns
+ *
+ * The default rate is 24 MHz / 64 = 375 kbps.
+ */
+static uint64_t bits(const uint32_t n)
+{
+    return (n * 64 * 1000000000ULL) / 24000000;
+}
+
+/*!
+ * \brief Returns the time of a transfer of n bytes at the default bit rate
+ *
+ * The first byte follows the START, the STOP takes another bit.
+ */
+static uint64_t transfer_time(const uint32_t n)
+{
+    return bits(1) + n * bits(9) + bits(1);
+}
+
+/*!
+ * \brief Completion callback of a submitted transfer, sets the flag in the
+ * context
+ */
+static void done_callback(i2c_transfer_t *transfer, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    (void)pxHigherPriorityTaskWoken;
+    *(volatile bool *)transfer->context = true;
+}
+
+static void test_write_read(void)
+{
+    const uint8_t data[4] = {0x12, 0x34, 0x56, 0x78};
+    uint8_t rx[4] = {0};
+    sim_i2c_stats_t s;
+
+    sim_i2c_resetstats(0);
+
+    TEST_EQUAL(i2c_write(I2C_BUS0, ADDRESS, 0x10, data, sizeof(data)), I2C_OK);
+    TEST_CHECK(memcmp(&memory[0].memory[0x10], data, sizeof(data)) == 0);
+
+    // Register address, repeated START and the read in one transfer
+    TEST_EQUAL(i2c_read(I2C_BUS0, ADDRESS, 0x10, rx, sizeof(rx)), I2C_OK);
+    TEST_CHECK(memcmp(rx, data, sizeof(data)) == 0);
+
+    // A single byte is NAKed directly
+    TEST_EQUAL(i2c_read(I2C_BUS0, ADDRESS, 0x13, rx, 1), I2C_OK);
+    TEST_EQUAL(rx[0], 0x78);
+
+    sim_i2c_getstats(0, &s);
+    TEST_EQUAL(s.starts, 5);
+    TEST_EQUAL(s.restarts, 2);
+    TEST_EQUAL(s.stops, 3);
+    TEST_EQUAL(s.bytes, (1 + 5) + (1 + 1 + 1 + 4) + (1 + 1 + 1 + 1));
+    TEST_EQUAL(s.errors, 0);
+    TEST_EQUAL(s.overspeed, 0);
+    TEST_EQUAL(s.bitrate, 375000);
+}
+
+static void test_scatter(void)
+{
+    uint8_t a[2] = {0x20, 0x01};
+    uint8_t b[3] = {0x02, 0x03, 0x04};
+    uint8_t c[1] = {0x05};
+    uint8_t rx[4] = {0};
+    sim_i2c_stats_t s;
+
+    const i2c_segment_t write[] =
+    {
+        {a, sizeof(a), I2C_WRITE},
+        {b, sizeof(b), I2C_WRITE},
+        {c, sizeof(c), I2C_WRITE},
+    };
+
+    sim_i2c_resetstats(0);
+
+    // All segments are sent in one transfer
+    TEST_EQUAL(i2c_writev(I2C_BUS0, ADDRESS, write, 3), I2C_OK);
+
+    sim_i2c_getstats(0, &s);
+    TEST_EQUAL(s.starts, 1);
+    TEST_EQUAL(s.stops, 1);
+    TEST_EQUAL(s.bytes, 1 + 6);
+
+    uint8_t reg = 0x20;
+    const i2c_segment_t read[] =
+    {
+        {&reg, 1, I2C_WRITE},
+        {&rx[0], 1, I2C_READ},
+        {&rx[1], 3, I2C_READ},
+    };
+
+    TEST_EQUAL(i2c_writev(I2C_BUS0, ADDRESS, read, 3), I2C_OK);
+    TEST_EQUAL(rx[0], 0x01);
+    TEST_EQUAL(rx[1], 0x02);
+    TEST_EQUAL(rx[2], 0x03);
+    TEST_EQUAL(rx[3], 0x04);
+}
+
+/*!
+ * \brief The driver uses the interrupt of every byte and doesn't poll
+ *
+ * Every interrupt reads the status register once, so there is no CPU
+ * spinning while the bytes are on the bus. The bus is not idle between the
+ * bytes, the transfer takes as long as its bits.
+ */
+static void test_interrupt_driven(void)
+{
+    uint8_t data[64] = {0};
+    sim_i2c_stats_t s;
+
+    sim_i2c_resetstats(0);
+
+    const uint64_t start = sim_time();
+    TEST_EQUAL(i2c_write(I2C_BUS0, ADDRESS, 0x00, data, sizeof(data)), I2C_OK);
+    const uint64_t elapsed = sim_time() - start;
+
+    sim_i2c_getstats(0, &s);
+    TEST_EQUAL(s.bytes, 66);
+
+    // One interrupt per byte and one for the STOP
+    TEST_EQUAL(s.status_reads, s.bytes + 1);
+
+    TEST_EQUAL(elapsed, transfer_time(66));
+    TEST_EQUAL(s.busy, elapsed);
+}
+
+static void test_concurrent(void)
+{
+    static uint8_t data[2][256];
+    volatile bool done = false;
+    sim_i2c_stats_t s0, s1;
+
+    uint8_t header = 0;
+    const i2c_segment_t segments[] =
+    {
+        {&header, 1, I2C_WRITE},
+        {data[1], sizeof(data[1]), I2C_WRITE},
+    };
+
+    i2c_transfer_t t =
+    {
+        .address = ADDRESS,
+        .segments = segments,
+        .n_segments = 2,
+        .callback = done_callback,
+        .context = (void *)&done,
+    };
+
+    sim_i2c_resetstats(0);
+    sim_i2c_resetstats(1);
+
+    const uint64_t start = sim_time();
+
+    // The transfer on bus 1 runs while the task waits for bus 0
+    TEST_CHECK(i2c_submit(I2C_BUS1, &t));
+    TEST_EQUAL(i2c_write(I2C_BUS0, ADDRESS, 0x00, data[0], sizeof(data[0])), I2C_OK);
+
+    while(!done)
+    {
+        vTaskDelay(1);
+    }
+
+    TEST_EQUAL(t.status, I2C_OK);
+
+    sim_i2c_getstats(0, &s0);
+    sim_i2c_getstats(1, &s1);
+    TEST_EQUAL(s0.busy, transfer_time(258));
+    TEST_EQUAL(s1.busy, transfer_time(258));
+
+    // Both transfers finished in the time of one
+    TEST_CHECK((sim_time() - start) < (2 * transfer_time(258) * 6 / 10));
+}
+
+/*!
+ * \brief A transfer submitted while the bus is busy is queued and started by
+ * the interrupt that completes the previous one
+ */
+static void test_queued(void)
+{
+    static uint8_t data[2][8] = {{1, 2, 3, 4, 5, 6, 7, 8}, {9, 10, 11, 12, 13, 14, 15, 16}};
+    volatile bool done[2] = {false, false};
+    sim_i2c_stats_t s;
+
+    uint8_t header[2] = {0x10, 0x20};
+    const i2c_segment_t segments[2][2] =
+    {
+        {{&header[0], 1, I2C_WRITE}, {data[0], sizeof(data[0]), I2C_WRITE}},
+        {{&header[1], 1, I2C_WRITE}, {data[1], sizeof(data[1]), I2C_WRITE}},
+    };
+
+    i2c_transfer_t t[2];
+
+    for(uint32_t i=0; i<2; i++)
+    {
+        t[i] = (i2c_transfer_t)
+        {
+            .address = ADDRESS,
+            .segments = segments[i],
+            .n_segments = 2,
+            .callback = done_callback,
+            .context = (void *)&done[i],
+        };
+    }
+
+    sim_i2c_resetstats(0);
+
+    const uint64_t start = sim_time();
+
+    TEST_CHECK(i2c_submit(I2C_BUS0, &t[0]));
+    TEST_CHECK(i2c_submit(I2C_BUS0, &t[1]));
+    TEST_EQUAL(t[1].status, I2C_PENDING);
+
+    while(!done[1])
+    {
+        vTaskDelay(1);
+    }
+
+    TEST_CHECK(done[0]);
+    TEST_EQUAL(t[0].status, I2C_OK);
+    TEST_EQUAL(t[1].status, I2C_OK);
+    TEST_CHECK(memcmp(&memory[0].memory[0x10], data[0], sizeof(data[0])) == 0);
+    TEST_CHECK(memcmp(&memory[0].memory[0x20], data[1], sizeof(data[1])) == 0);
+
+    // Back to back, without an extra interrupt to start the second transfer
+    sim_i2c_getstats(0, &s);
+    TEST_EQUAL(s.bytes, 2 * 10);
+    TEST_EQUAL(s.status_reads, s.bytes + 2);
+    TEST_EQUAL(s.busy, 2 * transfer_time(10));
+    TEST_CHECK((sim_time() - start) < (2 * transfer_time(10) + SIM_MS));
+}
+
+static void test_speed(void)
+{
+    uint8_t data[8] = {0};
+    sim_i2c_stats_t s;
+
+    sim_i2c_resetstats(0);
+
+    // A slower device on the same bus gets its own rate
+    TEST_EQUAL(i2c_setspeed(I2C_BUS0, SLOW_ADDRESS, 100000), 100000);
+
+    TEST_EQUAL(i2c_write(I2C_BUS0, SLOW_ADDRESS, 0x00, data, sizeof(data)), I2C_OK);
+    sim_i2c_getstats(0, &s);
+    TEST_EQUAL(s.bitrate, 100000);
+
+    TEST_EQUAL(i2c_write(I2C_BUS0, ADDRESS, 0x00, data, sizeof(data)), I2C_OK);
+    sim_i2c_getstats(0, &s);
+    TEST_EQUAL(s.bitrate, 375000);
+    TEST_EQUAL(s.overspeed, 0);
+
+    // Overclocking a device is possible, the model counts the bytes
+    TEST_EQUAL(i2c_setspeed(I2C_BUS0, ADDRESS, 1000000), 1000000);
+
+    const uint64_t start = sim_time();
+    TEST_EQUAL(i2c_write(I2C_BUS0, ADDRESS, 0x00, data, sizeof(data)), I2C_OK);
+    TEST_EQUAL(sim_time() - start, (1 + 10 * 9 + 1) * 1000);
+
+    sim_i2c_getstats(0, &s);
+    TEST_EQUAL(s.bitrate, 1000000);
+    TEST_EQUAL(s.overspeed, 10);
+
+    TEST_EQUAL(i2c_setspeed(I2C_BUS0, ADDRESS, I2C_BITRATE), 375000);
+}
+
+static void test_nak(void)
+{
+    uint8_t data[2] = {0};
+    i2c_stats_t before, after;
+
+    i2c_getstats(I2C_BUS0, &before);
+
+    // A NAK is retried
+    sim_i2c_nak(0, 1);
+    TEST_EQUAL(i2c_write(I2C_BUS0, ADDRESS, 0x00, data, sizeof(data)), I2C_OK);
+
+    i2c_getstats(I2C_BUS0, &after);
+    TEST_EQUAL(after.nacks - before.nacks, 1);
+    TEST_EQUAL(after.retries - before.retries, 1);
+
+    // But not forever
+    sim_i2c_nak(0, I2C_RETRIES + 1);
+    TEST_EQUAL(i2c_write(I2C_BUS0, ADDRESS, 0x00, data, sizeof(data)), I2C_NACK);
+
+    i2c_getstats(I2C_BUS0, &before);
+    TEST_EQUAL(before.nacks - after.nacks, I2C_RETRIES + 1);
+    TEST_EQUAL(before.retries - after.retries, I2C_RETRIES);
+
+    // Nothing answers at this address
+    TEST_EQUAL(i2c_write(I2C_BUS0, 0xB0, 0x00, data, sizeof(data)), I2C_NACK);
+    TEST_EQUAL(i2c_read(I2C_BUS0, 0xB0, 0x00, data, sizeof(data)), I2C_NACK);
+}
+
+/*!
+ * \brief A slave that holds SDA is released by the bus clear
+ */
+static void test_stuck_sda(void)
+{
+    uint8_t data[2] = {0};
+    i2c_stats_t before, after;
+    sim_i2c_stats_t s;
+
+    i2c_getstats(I2C_BUS0, &before);
+    sim_i2c_resetstats(0);
+
+    sim_i2c_stuck_sda(0, 5);
+    TEST_EQUAL(i2c_write(I2C_BUS0, ADDRESS, 0x00, data, sizeof(data)), I2C_OK);
+
+    i2c_getstats(I2C_BUS0, &after);
+    TEST_EQUAL(after.arblost - before.arblost, 1);
+    TEST_EQUAL(after.recoveries - before.recoveries, 1);
+    TEST_EQUAL(after.stuck - before.stuck, 0);
+    TEST_EQUAL(after.retries - before.retries, 1);
+
+    sim_i2c_getstats(0, &s);
+    TEST_EQUAL(s.arblost, 1);
+    TEST_EQUAL(s.pulses, 5 + 1);
+    TEST_EQUAL(s.gpio_stops, 1);
+
+    // A slave that never releases SDA: at most 9 pulses per recovery
+    i2c_getstats(I2C_BUS0, &before);
+    sim_i2c_resetstats(0);
+
+    sim_i2c_stuck_sda(0, 100);
+    TEST_EQUAL(i2c_write(I2C_BUS0, ADDRESS, 0x00, data, sizeof(data)), I2C_ARBLOST);
+
+    i2c_getstats(I2C_BUS0, &after);
+    TEST_EQUAL(after.arblost - before.arblost, I2C_RETRIES + 1);
+    TEST_EQUAL(after.recoveries - before.recoveries, I2C_RETRIES);
+    TEST_EQUAL(after.stuck - before.stuck, I2C_RETRIES);
+
+    sim_i2c_getstats(0, &s);
+    TEST_EQUAL(s.pulses, I2C_RETRIES * (9 + 1));
+    TEST_EQUAL(s.bytes, 0);
+
+    sim_i2c_stuck_sda(0, 0);
+    TEST_CHECK(i2c_recover(I2C_BUS0));
+    TEST_EQUAL(i2c_write(I2C_BUS0, ADDRESS, 0x00, data, sizeof(data)), I2C_OK);
+}
+
+/*!
+ * \brief A slave that holds SCL makes the transfer time out
+ *
+ * The transfer is aborted after I2C_TIMEOUT_MS and retried. A wedged bus
+ * doesn't stall the other bus.
+ */
+static void test_scl_hold(void)
+{
+    uint8_t data[2] = {0};
+    i2c_stats_t before, after;
+
+    i2c_getstats(I2C_BUS0, &before);
+
+    sim_i2c_hold_scl(0, 70 * SIM_MS);
+
+    uint64_t start = sim_time();
+    TEST_EQUAL(i2c_write(I2C_BUS0, ADDRESS, 0x00, data, sizeof(data)), I2C_OK);
+    uint64_t elapsed = sim_time() - start;
+
+    i2c_getstats(I2C_BUS0, &after);
+    TEST_EQUAL(after.timeouts - before.timeouts, 1);
+    TEST_EQUAL(after.recoveries - before.recoveries, 1);
+    TEST_EQUAL(after.stuck - before.stuck, 1);
+    TEST_EQUAL(after.retries - before.retries, 1);
+
+    // Aborted after the timeout, then the retry waits for SCL
+    TEST_CHECK(elapsed >= (70 * SIM_MS));
+    TEST_CHECK(elapsed < (71 * SIM_MS));
+
+    // The other bus runs while this bus is held
+    volatile bool done = false;
+
+    uint8_t header = 0;
+    const i2c_segment_t segments[] = {{&header, 1, I2C_WRITE}};
+
+    i2c_transfer_t t =
+    {
+        .address = ADDRESS,
+        .segments = segments,
+        .n_segments = 1,
+        .callback = done_callback,
+        .context = (void *)&done,
+    };
+
+    sim_i2c_hold_scl(0, 200 * SIM_MS);
+    TEST_CHECK(i2c_submit(I2C_BUS0, &t));
+
+    start = sim_time();
+    TEST_EQUAL(i2c_write(I2C_BUS1, ADDRESS, 0x00, data, sizeof(data)), I2C_OK);
+    TEST_EQUAL(sim_time() - start, transfer_time(4));
+    TEST_CHECK(!done);
+
+    while(!done)
+    {
+        vTaskDelay(1);
+    }
+
+    TEST_EQUAL(t.status, I2C_OK);
+}
+
+static void tests(void)
+{
+    i2c_init(I2C_BUS0);
+    i2c_init(I2C_BUS1);
+
+    TEST_RUN(test_write_read);
+    TEST_RUN(test_scatter);
+    TEST_RUN(test_interrupt_driven);
+    TEST_RUN(test_concurrent);
+    TEST_RUN(test_queued);
+    TEST_RUN(test_speed);
+    TEST_RUN(test_nak);
+    TEST_RUN(test_stuck_sda);
+    TEST_RUN(test_scl_hold);
+}
+
+int main(void)
+{
+    sim_init();
+    sim_i2c_init();
+
+    for(uint32_t i=0; i<SIM_I2C_BUSES; i++)
+    {
+        memory[i].slave = (sim_i2c_slave_t){ADDRESS, 400000, memory_start,
+                                            memory_write, memory_read, memory_stop, NULL};
+        sim_i2c_attach(i, &memory[i].slave);
+    }
+
+    slow.slave = (sim_i2c_slave_t){SLOW_ADDRESS, 100000, memory_start,
+                                   memory_write, memory_read, memory_stop, NULL};
+    sim_i2c_attach(0, &slow.slave);
+
+    sim_run(tests);
+
+    return test_report();
+}
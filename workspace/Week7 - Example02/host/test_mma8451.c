@@ -0,0 +1,390 @@
+/*! ***************************************************************************
+ *
+ * \brief     Tests of the MMA8451Q driver against the model
+ * \file      test_mma8451.c
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "flash_ram.h"
+#include "mma8451.h"
+#include "sim.h"
+#include "sim_i2c.h"
+#include "sim_mma8451.h"
+#include "test.h"
+
+static sim_mma8451_t sensor;
+
+/// Batches received by the callback of the driver task
+static struct
+{
+    uint32_t batches;
+    uint32_t samples;
+    uint32_t n;                 ///< Samples in the last batch
+    mma8451_data_t last[MMA8451_FIFO_SIZE];
+} received;
+
+static void callback(const mma8451_data_t data[], const uint32_t n)
+{
+    received.batches++;
+    received.samples += n;
+    received.n = n;
+    memcpy(received.last, data, n * sizeof(data[0]));
+}
+
+static void test_init(void)
+{
+    // Another device at the address
+    sensor.regs[WHO_AM_I_REG] = 0x2A;
+    TEST_CHECK(!mma8451_init());
+    sensor.regs[WHO_AM_I_REG] = WHO_AM_I_VAL;
+
+    // The reset is polled until the device responds again
+    sensor.regs[OFF_X_REG] = 0x55;
+    const uint64_t start = sim_time();
+    TEST_CHECK(mma8451_init());
+    TEST_CHECK((sim_time() - start) >= sensor.reset_time);
+    TEST_CHECK((sim_time() - start) < (sensor.reset_time + 2 * SIM_MS));
+
+    TEST_EQUAL(sensor.regs[OFF_X_REG], 0);
+    TEST_EQUAL(sensor.regs[XYZ_DATA_CFG_REG], 0x00);
+    TEST_EQUAL(sensor.regs[CTRL_REG2], 0x02);
+    TEST_EQUAL(sensor.regs[CTRL_REG1], 0x1D);
+    TEST_EQUAL(sensor.errors, 0);
+}
+
+/*!
+ * \brief A device that doesn't finish its reset doesn't hang the driver
+ */
+static void test_reset_timeout(void)
+{
+    sensor.reset_time = 500 * SIM_MS;
+
+    const uint64_t start = sim_time();
+    TEST_CHECK(!mma8451_init());
+    const uint64_t elapsed = sim_time() - start;
+
+    // The timeout is counted in ticks
+    TEST_CHECK(elapsed >= ((MMA8451_TIMEOUT_MS - 1) * SIM_MS));
+    TEST_CHECK(elapsed < ((MMA8451_TIMEOUT_MS + 5) * SIM_MS));
+
+    // Wait for the reset to finish
+    sensor.reset_time = 1 * SIM_MS;
+    vTaskDelay(pdMS_TO_TICKS(500));
+    TEST_CHECK(mma8451_init());
+}
+
+static void test_calibrate(void)
+{
+    mma8451_sample_t sample;
+    flash_ram_stats_t stats;
+
+    flash_ram_reset();
+    TEST_CHECK(!mma8451_load_calibration());
+
+    // Offsets of a board that is not quite flat
+    sim_mma8451_set(&sensor, 80, -40, 4000);
+    TEST_CHECK(mma8451_calibrate());
+
+    TEST_EQUAL((int8_t)sensor.regs[OFF_X_REG], -10);
+    TEST_EQUAL((int8_t)sensor.regs[OFF_Y_REG], 5);
+    TEST_EQUAL((int8_t)sensor.regs[OFF_Z_REG], 12);
+
+    // Wait for a calibrated sample
+    vTaskDelay(pdMS_TO_TICKS(20));
+    TEST_CHECK(mma8451_read(&sample));
+    TEST_EQUAL(sample.x, 0);
+    TEST_EQUAL(sample.y, 0);
+    TEST_EQUAL(sample.z, COUNTS_PER_G);
+
+    // The offsets are stored
+    flash_ram_getstats(&stats);
+    TEST_EQUAL(stats.erases, 1);
+
+    TEST_CHECK(mma8451_init());
+    TEST_EQUAL(sensor.regs[OFF_X_REG], 0);
+    TEST_CHECK(mma8451_load_calibration());
+    TEST_EQUAL((int8_t)sensor.regs[OFF_X_REG], -10);
+    TEST_EQUAL((int8_t)sensor.regs[OFF_Y_REG], 5);
+    TEST_EQUAL((int8_t)sensor.regs[OFF_Z_REG], 12);
+
+    // Calibrating only enables the data, not the data ready interrupt
+    TEST_EQUAL(sensor.regs[CTRL_REG4], 0);
+    TEST_CHECK(sim_pin_level(SIM_PORTA, 14));
+    TEST_CHECK(sim_pin_level(SIM_PORTA, 15));
+}
+
+static void test_fifo(void)
+{
+    static mma8451_sample_t samples[MMA8451_FIFO_SIZE];
+    sim_i2c_stats_t s;
+    bool overflow;
+
+    TEST_CHECK(!mma8451_fifo_init(MMA8451_ODR_400HZ, 0));
+    TEST_CHECK(mma8451_fifo_init(MMA8451_ODR_400HZ, 16));
+    TEST_EQUAL(sensor.errors, 0);
+
+    // The watermark interrupt after 16 samples of 2.5 ms
+    vTaskDelay(pdMS_TO_TICKS(39));
+    TEST_CHECK(sim_pin_level(SIM_PORTA, 14));
+    vTaskDelay(pdMS_TO_TICKS(2));
+    TEST_CHECK(!sim_pin_level(SIM_PORTA, 14));
+
+    // The batch is read in a single burst after the status
+    sim_i2c_resetstats(0);
+    TEST_EQUAL(mma8451_fifo_read(samples, MMA8451_FIFO_SIZE, &overflow), 16);
+    TEST_CHECK(!overflow);
+    TEST_CHECK(sim_pin_level(SIM_PORTA, 14));
+
+    sim_i2c_getstats(0, &s);
+    TEST_EQUAL(s.stops, 2);
+    TEST_EQUAL(s.bytes, (3 + 1) + (3 + 16 * 6));
+
+    for(uint32_t i=0; i<16; i++)
+    {
+        TEST_EQUAL(samples[i].x, 0);
+        TEST_EQUAL(samples[i].y, 0);
+        TEST_EQUAL(samples[i].z, COUNTS_PER_G);
+    }
+
+    // The circular FIFO keeps the newest samples
+    vTaskDelay(pdMS_TO_TICKS(100));
+    sim_mma8451_set(&sensor, 800, 0, 4000);
+    vTaskDelay(pdMS_TO_TICKS(3));
+    TEST_EQUAL(mma8451_fifo_read(samples, MMA8451_FIFO_SIZE, &overflow), MMA8451_FIFO_SIZE);
+    TEST_CHECK(overflow);
+    TEST_EQUAL(samples[MMA8451_FIFO_SIZE - 1].x, 800 - 80);
+    TEST_EQUAL(samples[0].x, 0);
+
+    // Sampling continued during the burst of 32 * 6 bytes, about 5 ms
+    TEST_EQUAL(mma8451_fifo_read(samples, MMA8451_FIFO_SIZE, &overflow), 2);
+    TEST_CHECK(!overflow);
+    sim_mma8451_set(&sensor, 80, -40, 4000);
+}
+
+/*!
+ * \brief The driver task delivers batches and recovers from bus errors
+ */
+static void test_task(void)
+{
+    flash_ram_stats_t before, after;
+
+    const mma8451_events_t events =
+    {
+        .transient_threshold = 8,
+        .task = xTaskGetCurrentTaskHandle(),
+    };
+
+    flash_ram_getstats(&before);
+
+    TEST_CHECK(mma8451_start(MMA8451_ODR_100HZ, 10, callback, &events));
+
+    vTaskDelay(pdMS_TO_TICKS(1000));
+
+    // The stored calibration is loaded
+    flash_ram_getstats(&after);
+    TEST_EQUAL(after.erases, before.erases);
+    TEST_EQUAL((int8_t)sensor.regs[OFF_Z_REG], 12);
+
+    // A batch every 100 ms
+    TEST_CHECK(received.batches >= 9);
+    TEST_CHECK(received.batches <= 10);
+    TEST_EQUAL(received.n, 10);
+    TEST_EQUAL(received.last[0].z, COUNTS_PER_G);
+    TEST_EQUAL(received.last[9].timestamp - received.last[0].timestamp, pdMS_TO_TICKS(90));
+
+    // Events are read and notified
+    uint32_t notified = 0;
+    sim_mma8451_event(&sensor, 0x20);
+    TEST_CHECK(xTaskNotifyWait(0, 0xFFFFFFFF, &notified, pdMS_TO_TICKS(10)) == pdPASS);
+    TEST_EQUAL(notified, MMA8451_EVENT_TRANSIENT);
+    TEST_CHECK(sim_pin_level(SIM_PORTA, 15));
+
+    // A slave that holds SDA is recovered and the batches continue
+    i2c_stats_t s;
+    i2c_getstats(I2C_BUS0, &s);
+    const uint32_t recoveries = s.recoveries;
+
+    sim_i2c_stuck_sda(0, 3);
+    const uint32_t batches = received.batches;
+    vTaskDelay(pdMS_TO_TICKS(500));
+
+    i2c_getstats(I2C_BUS0, &s);
+    TEST_EQUAL(s.recoveries, recoveries + 1);
+    TEST_CHECK(received.batches >= (batches + 4));
+}
+
+/// Results reported by the driver task after mma8451_recalibrate()
+static struct
+{
+    uint32_t calls;
+    bool success;
+} calibrated;
+
+static void calibrated_callback(const bool success)
+{
+    calibrated.calls++;
+    calibrated.success = success;
+}
+
+/*!
+ * \brief A requested calibration is reported, and retried until it succeeds
+ *        instead of falling back to the stored offsets
+ */
+static void test_recalibrate(void)
+{
+    flash_ram_stats_t before, after;
+
+    flash_ram_getstats(&before);
+
+    // The board is tilted a little on the X axis
+    sim_mma8451_set(&sensor, 160, 0, COUNTS_PER_G);
+    mma8451_recalibrate(calibrated_callback);
+    vTaskDelay(pdMS_TO_TICKS(500));
+
+    flash_ram_getstats(&after);
+    TEST_EQUAL(calibrated.calls, 1);
+    TEST_CHECK(calibrated.success);
+    TEST_EQUAL(after.erases, before.erases + 1);
+    TEST_EQUAL((int8_t)sensor.regs[OFF_X_REG], -20);
+    TEST_EQUAL((int8_t)sensor.regs[OFF_Z_REG], 0);
+
+    // The sensor doesn't respond: the failure is reported once
+    const uint32_t batches = received.batches;
+
+    sim_i2c_nak(0, UINT32_MAX);
+    sim_mma8451_set(&sensor, 0, 0, COUNTS_PER_G);
+    mma8451_recalibrate(calibrated_callback);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+
+    TEST_EQUAL(calibrated.calls, 2);
+    TEST_CHECK(!calibrated.success);
+
+    // When the sensor responds again, the calibration is done instead of
+    // loading the offsets of the first calibration
+    sim_i2c_nak(0, 0);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+
+    flash_ram_getstats(&after);
+    TEST_EQUAL(calibrated.calls, 3);
+    TEST_CHECK(calibrated.success);
+    TEST_EQUAL(after.erases, before.erases + 2);
+    TEST_EQUAL((int8_t)sensor.regs[OFF_X_REG], 0);
+    TEST_CHECK(received.batches > batches);
+}
+
+/*!
+ * \brief Roll and pitch in degrees match the floating-point computation
+ *
+ * The error is dominated by the error of q16_atan2(), 0.0016 rad or 0.09
+ * degrees. The rounded square root adds little, down to 0.25 g.
+ */
+static void test_rollpitch(void)
+{
+    double max_error = 0;
+
+    srand(8451);
+
+    for(uint32_t i = 0; i < 200000; i++)
+    {
+        mma8451_data_t data;
+
+        if(i < 100000)
+        {
+            // Random counts over the full range
+            data.x = (int16_t)((rand() % 16384) - 8192);
+            data.y = (int16_t)((rand() % 16384) - 8192);
+            data.z = (int16_t)((rand() % 16384) - 8192);
+        }
+        else
+        {
+            // Random orientations at 1 g and 0.25 g
+            const double g = (i & 1) ? COUNTS_PER_G : COUNTS_PER_G / 4;
+            const double a = rand() * (2 * M_PI / RAND_MAX);
+            const double b = rand() * (M_PI / RAND_MAX) - M_PI / 2;
+
+            data.x = (int16_t)lround(g * sin(b));
+            data.y = (int16_t)lround(g * cos(b) * sin(a));
+            data.z = (int16_t)lround(g * cos(b) * cos(a));
+        }
+
+        q16_t roll;
+        q16_t pitch;
+
+        mma8451_rollpitch(&data, &roll, &pitch);
+
+        const double y = data.y;
+        const double z = data.z;
+        const double expected_roll = atan2(y, z) * 180 / M_PI;
+        const double expected_pitch = atan2(data.x, sqrt(y*y + z*z)) * 180 / M_PI;
+
+        max_error = fmax(max_error, fabs(expected_roll - (double)roll / Q16_ONE));
+        max_error = fmax(max_error, fabs(expected_pitch - (double)pitch / Q16_ONE));
+    }
+
+    TEST_CHECK(max_error < 0.1);
+
+    // Flat, on its side and upside down
+    const mma8451_data_t flat = {.x = 0, .y = 0, .z = COUNTS_PER_G};
+    const mma8451_data_t side = {.x = COUNTS_PER_G, .y = 0, .z = 0};
+    const mma8451_data_t down = {.x = 0, .y = 0, .z = -COUNTS_PER_G};
+    q16_t roll;
+    q16_t pitch;
+
+    mma8451_rollpitch(&flat, &roll, &pitch);
+    TEST_EQUAL(roll, 0);
+    TEST_EQUAL(pitch, 0);
+
+    mma8451_rollpitch(&side, &roll, &pitch);
+    TEST_EQUAL(Q16_TO_INT(pitch + Q16(0.5)), 90);
+
+    mma8451_rollpitch(&down, &roll, &pitch);
+    TEST_EQUAL(Q16_TO_INT(roll + Q16(0.5)), 180);
+}
+
+static void tests(void)
+{
+    TEST_RUN(test_init);
+    TEST_RUN(test_reset_timeout);
+    TEST_RUN(test_calibrate);
+    TEST_RUN(test_fifo);
+    TEST_RUN(test_task);
+    TEST_RUN(test_recalibrate);
+    TEST_RUN(test_rollpitch);
+}
+
+int main(void)
+{
+    sim_init();
+    sim_i2c_init();
+    sim_mma8451_init(&sensor, 0);
+
+    sim_run(tests);
+
+    return test_report();
+}
@@ -0,0 +1,321 @@
+/*! ***************************************************************************
+ *
+ * \brief     Tests of the waveforms of the RGB LED effects engine
+ * \file      test_rgb.c
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include <stddef.h>
+
+#include "rgb.h"
+#include "sim.h"
+#include "test.h"
+
+void TPM2_IRQHandler(void);
+
+/// Overflows of TPM2 in a step of period_ms, 48 MHz / 65536 = 732.4 Hz
+#define OVERFLOWS(ms) ((double)(ms) * 48000 / 65536)
+
+static const rgb_color_t white = {255, 255, 255};
+
+/*!
+ * \brief A fade is sampled from the first to the second colour
+ */
+static void test_fade(void)
+{
+    static const rgb_color_t colors[] = {{0, 0, 0}, {255, 128, 0}};
+    const rgb_effect_t e =
+    {
+        .type = RGB_EFFECT_FADE, .colors = colors, .n = 2, .period_ms = 1000,
+        .channels = RGB_RED | RGB_GREEN | RGB_BLUE,
+    };
+    static rgb_waveform_t w;
+
+    TEST_CHECK(rgb_waveform(&e, &w));
+    TEST_EQUAL(w.samples, RGB_WAVEFORM_SAMPLES);
+    TEST_CHECK(w.interpolate);
+    TEST_CHECK(!w.repeat);
+    TEST_EQUAL(w.channels, RGB_RED | RGB_GREEN | RGB_BLUE);
+
+    // Gamma-corrected end points, 65535 * (i / 255)^2.2
+    TEST_EQUAL(w.pwm[0][0], 0);
+    TEST_EQUAL(w.pwm[RGB_WAVEFORM_SAMPLES][0], 0xFFFF);
+    TEST_EQUAL(w.pwm[RGB_WAVEFORM_SAMPLES][1], 0x3832);
+    TEST_EQUAL(w.pwm[RGB_WAVEFORM_SAMPLES][2], 0);
+
+    // Half way the perceived brightness is half, 127 of 255
+    TEST_EQUAL(w.pwm[RGB_WAVEFORM_SAMPLES/2][0], 0x373C);
+
+    uint32_t errors = 0;
+    for(uint32_t j=1; j<=w.samples; j++)
+    {
+        errors += (w.pwm[j][0] <= w.pwm[j-1][0]);
+        errors += (w.pwm[j][1] < w.pwm[j-1][1]);
+    }
+    TEST_EQUAL(errors, 0);
+
+    // 64 samples in 1000 ms
+    TEST_EQUAL(w.increment, ((uint64_t)RGB_WAVEFORM_SAMPLES << 48) / (1000 * 48000));
+}
+
+/*!
+ * \brief A breathe is a symmetric triangle of the colour
+ */
+static void test_breathe(void)
+{
+    static const rgb_color_t color = {0, 0, 255};
+    const rgb_effect_t e =
+    {
+        .type = RGB_EFFECT_BREATHE, .colors = &color, .n = 1, .period_ms = 2000,
+        .repeat = true, .channels = RGB_BLUE,
+    };
+    static rgb_waveform_t w;
+
+    TEST_CHECK(rgb_waveform(&e, &w));
+    TEST_EQUAL(w.samples, RGB_WAVEFORM_SAMPLES);
+    TEST_CHECK(w.repeat);
+
+    TEST_EQUAL(w.pwm[0][2], 0);
+    TEST_EQUAL(w.pwm[w.samples/2][2], 0xFFFF);
+    TEST_EQUAL(w.pwm[w.samples][2], 0);
+
+    uint32_t errors = 0;
+    for(uint32_t j=0; j<=w.samples; j++)
+    {
+        errors += (w.pwm[j][2] != w.pwm[w.samples-j][2]);
+        errors += (w.pwm[j][0] != 0) || (w.pwm[j][1] != 0);
+        errors += (j > 0) && (j <= w.samples/2) && (w.pwm[j][2] <= w.pwm[j-1][2]);
+    }
+    TEST_EQUAL(errors, 0);
+}
+
+/*!
+ * \brief A blink has one sample per bit and is not interpolated
+ */
+static void test_blink(void)
+{
+    const rgb_effect_t e =
+    {
+        .type = RGB_EFFECT_BLINK, .colors = &white, .n = 1, .period_ms = 100,
+        .pattern = 0x0000000D, .pattern_length = 5, .channels = RGB_GREEN,
+    };
+    static rgb_waveform_t w;
+
+    TEST_CHECK(rgb_waveform(&e, &w));
+    TEST_EQUAL(w.samples, 5);
+    TEST_CHECK(!w.interpolate);
+
+    static const uint16_t expected[] = {0xFFFF, 0, 0xFFFF, 0xFFFF, 0, 0};
+    uint32_t errors = 0;
+    for(uint32_t j=0; j<=w.samples; j++)
+    {
+        errors += (w.pwm[j][1] != expected[j]);
+    }
+    TEST_EQUAL(errors, 0);
+
+    // One sample in 100 ms
+    TEST_EQUAL(w.increment, (1ULL << 48) / (100 * 48000));
+}
+
+/*!
+ * \brief A sequence has an equal number of samples per colour
+ */
+static void test_sequence(void)
+{
+    static const rgb_color_t colors[] = {{255, 0, 0}, {0, 255, 0}, {0, 0, 255}};
+    rgb_effect_t e =
+    {
+        .type = RGB_EFFECT_SEQUENCE, .colors = colors, .n = 3, .period_ms = 500,
+        .repeat = true, .channels = RGB_RED | RGB_GREEN | RGB_BLUE,
+    };
+    static rgb_waveform_t w;
+    const uint32_t spp = RGB_WAVEFORM_SAMPLES / 3;
+
+    TEST_CHECK(rgb_waveform(&e, &w));
+    TEST_EQUAL(w.samples, 3 * spp);
+
+    for(uint32_t k=0; k<3; k++)
+    {
+        TEST_EQUAL(w.pwm[k*spp][k], 0xFFFF);
+        TEST_EQUAL(w.pwm[k*spp][(k+1)%3], 0);
+    }
+
+    // The last colour fades to the first
+    TEST_CHECK(w.pwm[w.samples-1][0] > 0);
+    TEST_CHECK(w.pwm[w.samples-1][0] > w.pwm[w.samples-1][2]);
+    TEST_EQUAL(w.pwm[w.samples][0], 0xFFFF);
+
+    // Without repeat the last colour is held
+    e.repeat = false;
+    TEST_CHECK(rgb_waveform(&e, &w));
+    TEST_EQUAL(w.pwm[w.samples-1][2], 0xFFFF);
+    TEST_EQUAL(w.pwm[w.samples-1][0], 0);
+    TEST_EQUAL(w.pwm[w.samples][2], 0xFFFF);
+    TEST_EQUAL(w.increment, ((uint64_t)spp << 48) / (500 * 48000));
+}
+
+/*!
+ * \brief Invalid effects are rejected
+ */
+static void test_invalid(void)
+{
+    static const rgb_color_t colors[RGB_WAVEFORM_SAMPLES + 1];
+    const rgb_effect_t valid =
+    {
+        .type = RGB_EFFECT_SEQUENCE, .colors = colors, .n = RGB_WAVEFORM_SAMPLES,
+        .period_ms = 1, .pattern_length = 32,
+    };
+    static rgb_waveform_t w;
+    rgb_effect_t e;
+
+    TEST_CHECK(rgb_waveform(&valid, &w));
+    TEST_EQUAL(w.samples, RGB_WAVEFORM_SAMPLES);
+
+    e = valid; e.n = RGB_WAVEFORM_SAMPLES + 1;
+    TEST_CHECK(!rgb_waveform(&e, &w));
+    e = valid; e.colors = NULL;
+    TEST_CHECK(!rgb_waveform(&e, &w));
+    e = valid; e.n = 0;
+    TEST_CHECK(!rgb_waveform(&e, &w));
+    e = valid; e.period_ms = 0;
+    TEST_CHECK(!rgb_waveform(&e, &w));
+    e = valid; e.type = RGB_EFFECT_FADE; e.n = 1;
+    TEST_CHECK(!rgb_waveform(&e, &w));
+    e = valid; e.type = RGB_EFFECT_BLINK; e.pattern_length = 0;
+    TEST_CHECK(!rgb_waveform(&e, &w));
+    e = valid; e.type = RGB_EFFECT_BLINK; e.pattern_length = 33;
+    TEST_CHECK(!rgb_waveform(&e, &w));
+    TEST_CHECK(!rgb_effect_start(&e));
+}
+
+/*!
+ * \brief A fade played by the interrupt ends after period_ms on the second
+ *        colour and never decreases
+ */
+static void test_play_fade(void)
+{
+    static const rgb_color_t colors[] = {{0, 0, 0}, {255, 255, 255}};
+    const rgb_effect_t e =
+    {
+        .type = RGB_EFFECT_FADE, .colors = colors, .n = 2, .period_ms = 100,
+        .channels = RGB_RED | RGB_GREEN | RGB_BLUE,
+    };
+
+    rgb_init();
+    TEST_CHECK(rgb_effect_start(&e));
+    TEST_CHECK(rgb_effect_running());
+    TEST_CHECK(TPM2->SC & TPM_SC_TOIE_MASK);
+
+    uint32_t overflows = 0;
+    uint32_t errors = 0;
+    uint16_t previous = 0;
+
+    while(rgb_effect_running() && (overflows < 1000))
+    {
+        TPM2_IRQHandler();
+        overflows++;
+
+        errors += (TPM2->CONTROLS[0].CnV < previous);
+        errors += (TPM2->CONTROLS[1].CnV != TPM2->CONTROLS[0].CnV);
+        errors += (TPM0->CONTROLS[1].CnV != TPM2->CONTROLS[0].CnV);
+        previous = TPM2->CONTROLS[0].CnV;
+    }
+
+    // The last update is in the overflow after 100 ms
+    TEST_EQUAL(errors, 0);
+    TEST_EQUAL(overflows, (uint32_t)OVERFLOWS(100) + 2);
+    TEST_EQUAL(TPM2->CONTROLS[0].CnV, 0xFFFF);
+    TEST_CHECK(!(TPM2->SC & TPM_SC_TOIE_MASK));
+
+    // Further overflows don't change the LEDs
+    TPM2_IRQHandler();
+    TEST_EQUAL(TPM2->CONTROLS[0].CnV, 0xFFFF);
+}
+
+/*!
+ * \brief The heartbeat of main() blinks blue without drift and leaves the
+ *        other channels alone
+ */
+static void test_play_heartbeat(void)
+{
+    static const rgb_color_t color = {0, 0, 64};
+    const rgb_effect_t e =
+    {
+        .type = RGB_EFFECT_BLINK, .colors = &color, .n = 1, .period_ms = 100,
+        .pattern = 0x00000001, .pattern_length = 20, .repeat = true,
+        .channels = RGB_BLUE,
+    };
+
+    rgb_init();
+    rgb_pwmcontrol(1234, 4321, 0);
+    TEST_CHECK(rgb_effect_start(&e));
+
+    const uint32_t cycles = 100;
+    uint32_t on = 0;
+    uint32_t last_on = 0;
+    const uint32_t n = (uint32_t)(cycles * OVERFLOWS(2000));
+
+    for(uint32_t i=0; i<n; i++)
+    {
+        TPM2_IRQHandler();
+
+        if(TPM0->CONTROLS[1].CnV != 0)
+        {
+            TEST_EQUAL(TPM0->CONTROLS[1].CnV, 0x0C3B);
+            on++;
+            last_on = i;
+        }
+    }
+
+    TEST_CHECK(rgb_effect_running());
+    TEST_EQUAL(TPM2->CONTROLS[0].CnV, 1234);
+    TEST_EQUAL(TPM2->CONTROLS[1].CnV, 4321);
+
+    // 100 ms on every 2 s, within one overflow per cycle
+    TEST_CHECK(on >= (uint32_t)(cycles * OVERFLOWS(100)) - cycles);
+    TEST_CHECK(on <= (uint32_t)(cycles * OVERFLOWS(100)) + cycles);
+
+    // The last on period ends 100 ms after the start of the last cycle
+    TEST_CHECK(last_on + 1 >= (uint32_t)((cycles - 1) * OVERFLOWS(2000) + OVERFLOWS(100)) - 1);
+    TEST_CHECK(last_on + 1 <= (uint32_t)((cycles - 1) * OVERFLOWS(2000) + OVERFLOWS(100)) + 1);
+
+    rgb_effect_stop();
+    TEST_CHECK(!rgb_effect_running());
+}
+
+int main(void)
+{
+    sim_init();
+
+    TEST_RUN(test_fade);
+    TEST_RUN(test_breathe);
+    TEST_RUN(test_blink);
+    TEST_RUN(test_sequence);
+    TEST_RUN(test_invalid);
+    TEST_RUN(test_play_fade);
+    TEST_RUN(test_play_heartbeat);
+
+    return test_report();
+}
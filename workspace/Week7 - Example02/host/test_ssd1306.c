@@ -0,0 +1,301 @@
+/*! ***************************************************************************
+ *
+ * \brief     Tests of the SSD1306 driver against the model
+ * \file      test_ssd1306.c
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include <string.h>
+
+#include "ssd1306.h"
+#include "sim.h"
+#include "sim_i2c.h"
+#include "sim_ssd1306.h"
+#include "test.h"
+
+static sim_ssd1306_t display;
+
+/*!
+ * \brief Returns the time of a transfer of n bytes at 375 kbps in ns
+ *
+ * A byte takes 9 bits of 2.67 us, the START and the STOP take another bit
+ * each.
+ */
+static uint64_t transfer_time(const uint32_t n)
+{
+    const uint64_t bit = (64 * 1000000000ULL) / 24000000;
+    const uint64_t byte = (9 * 64 * 1000000000ULL) / 24000000;
+
+    return bit + n * byte + bit;
+}
+
+static bool gddram_equal(const uint32_t first_page, const uint32_t last_page)
+{
+    for(uint32_t page=first_page; page<=last_page; page++)
+    {
+        if(memcmp(display.gddram[page], &ssd1306_framebuffer[page * SSD1306_WIDTH],
+                  SSD1306_WIDTH) != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void test_init(void)
+{
+    sim_i2c_stats_t s;
+
+    ssd1306_init();
+
+    TEST_CHECK(display.on);
+    TEST_CHECK(display.charge_pump);
+    TEST_CHECK(display.remap);
+    TEST_CHECK(display.comscan);
+    TEST_EQUAL(display.mode, 0);
+    TEST_EQUAL(display.column_start, 0);
+    TEST_EQUAL(display.column_end, SSD1306_WIDTH - 1);
+    TEST_EQUAL(display.page_start, 0);
+    TEST_EQUAL(display.page_end, SSD1306_PAGES - 1);
+    TEST_EQUAL(display.multiplex, SSD1306_HEIGHT - 1);
+    TEST_EQUAL(display.contrast, 0xFF);
+    TEST_EQUAL(display.errors, 0);
+
+    // SSD1306_BITRATE gives the highest rate within the datasheet
+    sim_i2c_getstats(1, &s);
+    TEST_EQUAL(s.bitrate, 375000);
+    TEST_EQUAL(s.overspeed, 0);
+}
+
+/*!
+ * \brief The complete framebuffer is sent in one transfer of 1038 bytes
+ */
+static void test_update_full(void)
+{
+    sim_i2c_stats_t s;
+
+    for(uint32_t i=0; i<SSD1306_SIZE; i++)
+    {
+        ssd1306_framebuffer[i] = (uint8_t)(i * 7 + 3);
+    }
+
+    ssd1306_markdirty(0, SSD1306_PAGES - 1);
+    sim_i2c_resetstats(1);
+
+    const uint64_t start = sim_time();
+    ssd1306_update();
+    const uint64_t elapsed = sim_time() - start;
+
+    sim_i2c_getstats(1, &s);
+    TEST_EQUAL(s.starts, 1);
+    TEST_EQUAL(s.stops, 1);
+    TEST_EQUAL(s.bytes, 1038);
+    TEST_EQUAL(elapsed, transfer_time(1038));
+    TEST_CHECK(elapsed < (25 * SIM_MS));
+
+    TEST_CHECK(gddram_equal(0, SSD1306_PAGES - 1));
+    TEST_EQUAL(display.errors, 0);
+
+    // Nothing changed, nothing is sent
+    ssd1306_update();
+    sim_i2c_getstats(1, &s);
+    TEST_EQUAL(s.starts, 1);
+}
+
+/*!
+ * \brief Only the span of dirty pages is sent
+ */
+static void test_update_page(void)
+{
+    sim_i2c_stats_t s;
+
+    // Drawing marks the page dirty
+    ssd1306_setpixel(10, 3 * 8 + 5, ON);
+    TEST_EQUAL(ssd1306_dirty, 1 << 3);
+
+    sim_i2c_resetstats(1);
+
+    const uint64_t start = sim_time();
+    ssd1306_update();
+    const uint64_t elapsed = sim_time() - start;
+
+    sim_i2c_getstats(1, &s);
+    TEST_EQUAL(s.starts, 1);
+    TEST_EQUAL(s.bytes, 142);
+    TEST_EQUAL(elapsed, transfer_time(142));
+    TEST_CHECK(elapsed < (3500 * SIM_US));
+
+    TEST_CHECK(gddram_equal(0, SSD1306_PAGES - 1));
+
+    // Two pages apart send the span between them
+    ssd1306_markdirty(1, 1);
+    ssd1306_markdirty(4, 4);
+    sim_i2c_resetstats(1);
+    ssd1306_update();
+
+    sim_i2c_getstats(1, &s);
+    TEST_EQUAL(s.bytes, 1 + 12 + 1 + 4 * SSD1306_WIDTH);
+}
+
+/*!
+ * \brief An overclocked display is faster, the model counts the bytes that
+ * exceed its datasheet limit
+ */
+static void test_overclock(void)
+{
+    sim_i2c_stats_t s;
+
+    TEST_EQUAL(i2c_setspeed(I2C_BUS1, SSD1306_SLAVE_ADDRESS, 800000), 800000);
+
+    ssd1306_markdirty(0, SSD1306_PAGES - 1);
+    sim_i2c_resetstats(1);
+
+    const uint64_t start = sim_time();
+    ssd1306_update();
+    const uint64_t elapsed = sim_time() - start;
+
+    sim_i2c_getstats(1, &s);
+    TEST_EQUAL(s.overspeed, 1038);
+    TEST_EQUAL(elapsed, ((2 + 1038 * 9) * 1000000000ULL) / 800000);
+    TEST_CHECK(gddram_equal(0, SSD1306_PAGES - 1));
+
+    TEST_EQUAL(i2c_setspeed(I2C_BUS1, SSD1306_SLAVE_ADDRESS, SSD1306_BITRATE), 375000);
+}
+
+/*!
+ * \brief The display RAM is not written during a hardware scroll
+ */
+static void test_scroll(void)
+{
+    sim_i2c_stats_t s;
+
+    ssd1306_scroll(SCROLL_LEFT, 2, 5, SCROLL_2_FRAMES, 0);
+    TEST_CHECK(display.scrolling);
+
+    ssd1306_setpixel(0, 0, ON);
+    ssd1306_markdirty(0, 0);
+
+    sim_i2c_resetstats(1);
+    ssd1306_update();
+    sim_i2c_getstats(1, &s);
+    TEST_EQUAL(s.bytes, 0);
+
+    // Stopping sends the complete framebuffer
+    ssd1306_scroll_stop();
+    TEST_CHECK(!display.scrolling);
+    TEST_EQUAL(display.start_line, 0);
+    TEST_CHECK(gddram_equal(0, SSD1306_PAGES - 1));
+    TEST_EQUAL(display.errors, 0);
+}
+
+static void test_fade_in(void)
+{
+    ssd1306_setcontrast(0xC0);
+    ssd1306_fade(FADE_OUT, 2);
+    TEST_EQUAL(display.fade, 0x22);
+
+    display.n_contrast = 0;
+    ssd1306_fade(FADE_IN, 0);
+
+    // The hardware fade is disabled at contrast 0 and the call returns at
+    // once. The timer task sends 16 steps of 8 frames.
+    TEST_EQUAL(display.fade, 0x00);
+    TEST_EQUAL(display.n_contrast, 1);
+    TEST_EQUAL(display.contrast_log[0], 0);
+
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    TEST_EQUAL(display.n_contrast, 17);
+
+    for(uint32_t i=1; i<=16; i++)
+    {
+        TEST_EQUAL(display.contrast_log[i], (0xC0 * i) / 16);
+        TEST_EQUAL((display.contrast_time[i] - display.contrast_time[i-1]) / SIM_MS, 52);
+    }
+
+    TEST_EQUAL(display.contrast, 0xC0);
+}
+
+/*!
+ * \brief Setting the contrast during a fade in cancels the remaining steps
+ */
+static void test_fade_in_cancel(void)
+{
+    ssd1306_setcontrast(0xC0);
+
+    display.n_contrast = 0;
+    ssd1306_fade(FADE_IN, 0);
+    vTaskDelay(pdMS_TO_TICKS(120));
+    TEST_EQUAL(display.n_contrast, 3);
+
+    ssd1306_setcontrast(0x40);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    TEST_EQUAL(display.n_contrast, 4);
+    TEST_EQUAL(display.contrast, 0x40);
+}
+
+/*!
+ * \brief A display that stops responding is initialised again by the next
+ * update, which sends the complete framebuffer
+ */
+static void test_recovery(void)
+{
+    sim_i2c_nak(1, I2C_RETRIES + 1);
+    ssd1306_setpixel(127, 63, ON);
+    ssd1306_markdirty(7, 7);
+    ssd1306_update();
+
+    // The display lost its state meanwhile
+    memset(display.gddram, 0, sizeof(display.gddram));
+    display.on = false;
+
+    ssd1306_update();
+    TEST_CHECK(display.on);
+    TEST_CHECK(gddram_equal(0, SSD1306_PAGES - 1));
+    TEST_EQUAL(display.errors, 0);
+}
+
+static void tests(void)
+{
+    TEST_RUN(test_init);
+    TEST_RUN(test_update_full);
+    TEST_RUN(test_update_page);
+    TEST_RUN(test_overclock);
+    TEST_RUN(test_scroll);
+    TEST_RUN(test_fade_in);
+    TEST_RUN(test_fade_in_cancel);
+    TEST_RUN(test_recovery);
+}
+
+int main(void)
+{
+    sim_init();
+    sim_i2c_init();
+    sim_ssd1306_init(&display, 1, SSD1306_SLAVE_ADDRESS);
+
+    sim_run(tests);
+
+    return test_report();
+}
@@ -0,0 +1,170 @@
+/*! ***************************************************************************
+ *
+ * \brief     Tests of the debouncing of the switches on the shield
+ * \file      test_switches.c
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include "sim.h"
+#include "switches.h"
+#include "test.h"
+
+/// Pin of SW1 on PORTD
+#define SW1_PIN (3)
+
+static QueueHandle_t events;
+
+/*!
+ * \brief Sets the level of SW1, scheduled by bounce()
+ */
+static void sw1_level(void *context)
+{
+    sim_pin_input(SIM_PORTD, SW1_PIN, context != NULL);
+}
+
+/*!
+ * \brief Schedules the edges of a bouncing contact
+ *
+ * SW1 toggles every 200 us for the given number of edges and ends at the
+ * level. Pressed is low.
+ *
+ * \return Simulated time of the first edge
+ */
+static uint64_t bounce(const uint32_t edges, const bool pressed)
+{
+    for(uint32_t i=0; i<edges; i++)
+    {
+        // The last edge ends at the level
+        const bool high = (((edges - 1 - i) & 1) == 0) ? !pressed : pressed;
+        sim_schedule((i + 1) * 200 * SIM_US, sw1_level, high ? (void *)1 : NULL);
+    }
+
+    return sim_time() + 200 * SIM_US;
+}
+
+/*!
+ * \brief A bouncing press and release give one event each, read
+ *        SW_DEBOUNCE_MS after the first edge
+ */
+static void test_bounce(void)
+{
+    sw_event_t event;
+
+    // 40 edges are many more than the timer command queue holds
+    const uint64_t first = bounce(41, true);
+    vTaskDelay(pdMS_TO_TICKS(100));
+
+    TEST_CHECK(xQueueReceive(events, &event, 0) == pdPASS);
+    TEST_EQUAL(event.sw, SW1);
+    TEST_EQUAL(event.type, SW_PRESS);
+    TEST_EQUAL(event.timestamp, (first / SIM_MS) + SW_DEBOUNCE_MS);
+    TEST_CHECK(xQueueReceive(events, &event, 0) != pdPASS);
+    TEST_CHECK(sw_pressed(SW1));
+
+    // The interrupt is enabled again
+    TEST_EQUAL((PORTD->PCR[SW1_PIN] & PORT_PCR_IRQC_MASK) >> PORT_PCR_IRQC_SHIFT, 0xB);
+
+    bounce(41, false);
+    vTaskDelay(pdMS_TO_TICKS(100));
+
+    TEST_CHECK(xQueueReceive(events, &event, 0) == pdPASS);
+    TEST_EQUAL(event.type, SW_RELEASE);
+    TEST_CHECK(xQueueReceive(events, &event, 0) != pdPASS);
+}
+
+/*!
+ * \brief A glitch that ends before the switch is read gives no event
+ */
+static void test_glitch(void)
+{
+    sw_event_t event;
+
+    bounce(2, false);
+    vTaskDelay(pdMS_TO_TICKS(100));
+
+    TEST_CHECK(xQueueReceive(events, &event, 0) != pdPASS);
+}
+
+/*!
+ * \brief A change right after the switch was read starts a new debounce
+ *        period
+ */
+static void test_late_edge(void)
+{
+    sw_event_t event;
+
+    // Pressed at 0.2 ms, read at about 20 ms, released at 25 ms
+    bounce(1, true);
+    sim_schedule(25 * SIM_MS, sw1_level, (void *)1);
+    vTaskDelay(pdMS_TO_TICKS(100));
+
+    TEST_CHECK(xQueueReceive(events, &event, 0) == pdPASS);
+    TEST_EQUAL(event.type, SW_PRESS);
+    TEST_CHECK(xQueueReceive(events, &event, 0) == pdPASS);
+    TEST_EQUAL(event.type, SW_RELEASE);
+    TEST_CHECK(!sw_pressed(SW1));
+}
+
+/*!
+ * \brief Holding the switch gives a long press
+ */
+static void test_long_press(void)
+{
+    sw_event_t event;
+
+    bounce(5, true);
+    vTaskDelay(pdMS_TO_TICKS(SW_DEBOUNCE_MS + SW_LONG_PRESS_MS + 100));
+
+    TEST_CHECK(xQueueReceive(events, &event, 0) == pdPASS);
+    TEST_EQUAL(event.type, SW_PRESS);
+    TEST_CHECK(xQueueReceive(events, &event, 0) == pdPASS);
+    TEST_EQUAL(event.type, SW_LONG_PRESS);
+
+    bounce(5, false);
+    vTaskDelay(pdMS_TO_TICKS(100));
+    TEST_CHECK(xQueueReceive(events, &event, 0) == pdPASS);
+    TEST_EQUAL(event.type, SW_RELEASE);
+}
+
+static void tests(void)
+{
+    events = xQueueCreate(5, sizeof(sw_event_t));
+
+    sw_init();
+    TEST_CHECK(sw_start(events));
+
+    TEST_RUN(test_bounce);
+    TEST_RUN(test_glitch);
+    TEST_RUN(test_late_edge);
+    TEST_RUN(test_long_press);
+}
+
+int main(void)
+{
+    sim_init();
+    sim_run(tests);
+
+    return test_report();
+}
@@ -0,0 +1,1019 @@
+/*! ***************************************************************************
+ *
+ * \brief     Interrupt driven I2C master driver
+ * \file      i2c.c
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include "i2c.h"
+
+#include "queue.h"
+
+/// States of the transfer state machine
+typedef enum
+{
+    STATE_IDLE = 0,     ///< No transfer in progress
+    STATE_WRITE,        ///< Address or data byte sent, waiting for the ACK
+    STATE_READ_ADDRESS, ///< Read address sent, waiting for the ACK
+    STATE_READ,         ///< Waiting for a received byte
+    STATE_STOP,         ///< STOP sent, waiting for the stop detection
+} i2c_state_t;
+
+/// Static configuration of a bus
+typedef struct
+{
+    I2C_Type *i2c;      ///< I2C peripheral
+    IRQn_Type irq;      ///< Interrupt of the I2C peripheral
+    uint32_t scgc4;     ///< Clock gate mask of the I2C peripheral
+    PORT_Type *port;    ///< Port of the SCL and SDA pins
+    GPIO_Type *gpio;    ///< GPIO of the SCL and SDA pins, used for recovery
+    uint8_t scl;        ///< SCL pin number
+    uint8_t sda;        ///< SDA pin number
+    uint8_t mux;        ///< Pin mux value for the I2C function
+} i2c_config_t;
+
+/// Speed profile of a device
+typedef struct
+{
+    uint8_t address;    ///< 8-bit slave address, R/W bit 0
+    uint8_t f;          ///< Frequency divider register value
+} i2c_profile_t;
+
+/// Runtime state of a bus
+typedef struct
+{
+    QueueHandle_t queue;          ///< Transfers waiting for the bus
+    i2c_transfer_t *volatile current; ///< Transfer in progress
+    i2c_state_t state;            ///< State of the state machine
+    i2c_status_t result;          ///< Status after the STOP
+    uint32_t segment;             ///< Current segment
+    uint32_t index;               ///< Current byte in the segment
+    uint32_t rx_remaining;        ///< Bytes left to read
+    TickType_t started;           ///< Tick count at the START
+    bool recovering;              ///< Bus recovery in progress
+    i2c_stats_t stats;            ///< Error and retry counters
+    uint8_t f;                    ///< Frequency divider for other devices
+    uint32_t n_profiles;          ///< Number of speed profiles
+    i2c_profile_t profiles[I2C_MAX_PROFILES]; ///< Speed profiles
+} i2c_busstate_t;
+
+static const i2c_config_t config[I2C_N_BUSES] =
+{
+    {I2C0, I2C0_IRQn, SIM_SCGC4_I2C0_MASK, PORTE, PTE, 24, 25, 5},
+    {I2C1, I2C1_IRQn, SIM_SCGC4_I2C1_MASK, PORTE, PTE,  1,  0, 6},
+};
+
+static i2c_busstate_t busstate[I2C_N_BUSES];
+
+/// SCL divider for every ICR value (KL25 Sub-Family Reference Manual, table
+/// "I2C divider and hold values")
+static const uint16_t scl_divider[64] =
+{
+      20,   22,   24,   26,   28,   30,   34,   40,
+      28,   32,   36,   40,   44,   48,   56,   68,
+      48,   56,   64,   72,   80,   88,  104,  128,
+      80,   96,  112,  128,  144,  160,  192,  240,
+     160,  192,  224,  256,  288,  320,  384,  480,
+     320,  384,  448,  512,  576,  640,  768,  960,
+     640,  768,  896, 1024, 1152, 1280, 1536, 1920,
+    1280, 1536, 1792, 2048, 2304, 2560, 3072, 3840,
+};
+
+// Local function prototypes
+static void i2c_hwinit(const i2c_config_t *c, const i2c_busstate_t *b);
+static uint8_t i2c_divider(const uint32_t bitrate, uint32_t *achieved);
+
+/*!
+ * \brief Initialises an I2C bus
+ *
+ * Initialises the I2C peripheral in master mode with interrupts enabled.
+ * The bit rate is set to the highest rate that doesn't exceed I2C_BITRATE,
+ * which is 375000 bps with a 24 MHz bus clock. Calling this function for a
+ * bus that has already been initialised has no effect, so every driver on a
+ * bus can call this function.
+ *
+ * \param[in]  bus  The bus to initialise
+ */
+void i2c_init(const i2c_bus_t bus)
+{
+    const i2c_config_t *c = &config[bus];
+    i2c_busstate_t *b = &busstate[bus];
+
+    if(b->queue != NULL)
+    {
+        return;
+    }
+
+    b->queue = xQueueCreate(I2C_QUEUE_LENGTH, sizeof(i2c_transfer_t *));
+    configASSERT(b->queue != NULL);
+
+    // Clock i2c peripheral and port
+    SIM->SCGC4 |= c->scgc4;
+    SIM->SCGC5 |= SIM_SCGC5_PORTE_MASK;
+
+    b->current = NULL;
+    b->state = STATE_IDLE;
+    b->f = i2c_divider(I2C_BITRATE, NULL);
+
+    i2c_hwinit(c, b);
+
+    NVIC_SetPriority(c->irq, 64);
+    NVIC_ClearPendingIRQ(c->irq);
+    NVIC_EnableIRQ(c->irq);
+}
+
+/*!
+ * \brief Initialises the I2C peripheral and its pins
+ */
+static void i2c_hwinit(const i2c_config_t *c, const i2c_busstate_t *b)
+{
+    // Set pins to I2C function
+    c->port->PCR[c->scl] = PORT_PCR_MUX(c->mux);
+    c->port->PCR[c->sda] = PORT_PCR_MUX(c->mux);
+
+    // Make sure i2c is disabled
+    c->i2c->C1 &= ~(I2C_C1_IICEN_MASK);
+
+    // Bit rate for devices without a speed profile
+    c->i2c->F = b->f;
+
+    // Enable the stop detection interrupt. The next transfer is started when
+    // the STOP of the previous transfer has been detected on the bus.
+    c->i2c->FLT = I2C_FLT_STOPIE_MASK | I2C_FLT_STOPF_MASK;
+
+    // Clear any flags
+    c->i2c->S = (I2C_S_ARBL_MASK | I2C_S_IICIF_MASK);
+
+    // Enable i2c and interrupts
+    c->i2c->C1 = (I2C_C1_IICEN_MASK | I2C_C1_IICIE_MASK);
+}
+
+/*!
+ * \brief Counts the bytes that are read from the current segment onwards
+ */
+static uint32_t i2c_rx_bytes(const i2c_busstate_t *b)
+{
+    uint32_t n = 0;
+
+    for(uint32_t i=b->segment; i<b->current->n_segments; i++)
+    {
+        n += b->current->segments[i].n;
+    }
+
+    return n;
+}
+
+/*!
+ * \brief Generates a START and sends the address of the current transfer
+ *
+ * The time between the STOP of the previous transfer and this START includes
+ * the interrupt latency and reading the transfer from the queue, which is more
+ * than the bus free time t_BUF (1.3 us) of the slaves.
+ *
+ * \param[in]  started  Tick count at the START, for the timeout. The caller
+ *                      reads it with the API of its context.
+ */
+static void i2c_start(const i2c_config_t *c, i2c_busstate_t *b, const TickType_t started)
+{
+    i2c_transfer_t *t = b->current;
+
+    // Select the bit rate of the device
+    uint8_t f = b->f;
+    for(uint32_t i=0; i<b->n_profiles; i++)
+    {
+        if(b->profiles[i].address == t->address)
+        {
+            f = b->profiles[i].f;
+            break;
+        }
+    }
+
+    if(c->i2c->F != f)
+    {
+        c->i2c->F = f;
+    }
+
+    b->segment = 0;
+    b->index = 0;
+    b->started = started;
+
+    // Set to transmit mode and generate start condition
+    c->i2c->C1 |= I2C_C1_TX_MASK;
+    c->i2c->C1 |= I2C_C1_MST_MASK;
+
+    if((t->n_segments > 0) && (t->segments[0].dir == I2C_READ))
+    {
+        b->rx_remaining = i2c_rx_bytes(b);
+        b->state = STATE_READ_ADDRESS;
+        c->i2c->D = t->address | 0x01;
+    }
+    else
+    {
+        b->state = STATE_WRITE;
+        c->i2c->D = t->address;
+    }
+}
+
+/*!
+ * \brief Generates a STOP
+ *
+ * The transfer completes when the STOP has been detected on the bus.
+ */
+static void i2c_stop(const i2c_config_t *c, i2c_busstate_t *b, const i2c_status_t result)
+{
+    c->i2c->C1 &= ~(I2C_C1_MST_MASK | I2C_C1_TX_MASK | I2C_C1_TXAK_MASK);
+
+    b->result = result;
+    b->state = STATE_STOP;
+}
+
+/*!
+ * \brief Reports the result of a transfer
+ *
+ * Updates the counters of the bus, calls the callback and notifies the task.
+ */
+static void i2c_finish(i2c_busstate_t *b, i2c_transfer_t *t, const i2c_status_t result,
+                       BaseType_t *pxHigherPriorityTaskWoken)
+{
+    b->stats.transfers++;
+
+    switch(result)
+    {
+        case I2C_NACK:    b->stats.nacks++;    break;
+        case I2C_ARBLOST: b->stats.arblost++;  break;
+        case I2C_TIMEOUT: b->stats.timeouts++; break;
+        default: break;
+    }
+
+    t->status = result;
+
+    if(t->callback != NULL)
+    {
+        t->callback(t, pxHigherPriorityTaskWoken);
+    }
+
+    if(t->task != NULL)
+    {
+        vTaskNotifyGiveIndexedFromISR(t->task, I2C_NOTIFY_INDEX, pxHigherPriorityTaskWoken);
+    }
+}
+
+/*!
+ * \brief Starts the next queued transfer, if any, called from the interrupt
+ *
+ * No transfer is started while the bus is being recovered.
+ */
+static void i2c_next(const i2c_config_t *c, i2c_busstate_t *b, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    i2c_transfer_t *next;
+
+    if(!b->recovering && (xQueueReceiveFromISR(b->queue, &next, pxHigherPriorityTaskWoken) == pdPASS))
+    {
+        b->current = next;
+        i2c_start(c, b, xTaskGetTickCountFromISR());
+    }
+}
+
+/*!
+ * \brief Lets the interrupt start the next queued transfer if the bus is idle
+ *
+ * Tasks do not read the queue themselves. A transfer can be queued while the
+ * interrupt completes the previous one and finds the queue empty, or while
+ * the bus is being recovered. Setting the interrupt pending starts it.
+ */
+static void i2c_kick(const i2c_config_t *c, const i2c_busstate_t *b)
+{
+    taskENTER_CRITICAL();
+
+    if((b->current == NULL) && !b->recovering)
+    {
+        NVIC_SetPendingIRQ(c->irq);
+    }
+
+    taskEXIT_CRITICAL();
+}
+
+/*!
+ * \brief Completes the current transfer and starts the next one
+ */
+static void i2c_complete(const i2c_config_t *c, i2c_busstate_t *b, const i2c_status_t result,
+                         BaseType_t *pxHigherPriorityTaskWoken)
+{
+    i2c_transfer_t *t = b->current;
+
+    b->current = NULL;
+    b->state = STATE_IDLE;
+
+    i2c_finish(b, t, result, pxHigherPriorityTaskWoken);
+    i2c_next(c, b, pxHigherPriorityTaskWoken);
+}
+
+/*!
+ * \brief Interrupt handler of a bus
+ *
+ * Every byte on the bus raises an interrupt. This function implements the
+ * state machine that moves through the segments of the current transfer.
+ */
+static void i2c_irq(const i2c_bus_t bus)
+{
+    const i2c_config_t *c = &config[bus];
+    i2c_busstate_t *b = &busstate[bus];
+    I2C_Type *i2c = c->i2c;
+
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    uint8_t status = i2c->S;
+
+    // Stop detected?
+    if(i2c->FLT & I2C_FLT_STOPF_MASK)
+    {
+        i2c->FLT |= I2C_FLT_STOPF_MASK;
+        i2c->S = I2C_S_IICIF_MASK;
+
+        if(b->state == STATE_STOP)
+        {
+            i2c_complete(c, b, b->result, &xHigherPriorityTaskWoken);
+        }
+
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+        return;
+    }
+
+    // Set pending by i2c_kick()
+    if(!(status & I2C_S_IICIF_MASK))
+    {
+        if(b->current == NULL)
+        {
+            i2c_next(c, b, &xHigherPriorityTaskWoken);
+        }
+
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+        return;
+    }
+
+    // Clear the flag
+    i2c->S = I2C_S_IICIF_MASK;
+
+    if(b->current == NULL)
+    {
+        return;
+    }
+
+    // Arbitration lost? The peripheral has already left master mode, so no
+    // STOP is generated by this master.
+    if(status & I2C_S_ARBL_MASK)
+    {
+        i2c->S = I2C_S_ARBL_MASK;
+        i2c->C1 &= ~(I2C_C1_MST_MASK | I2C_C1_TX_MASK);
+        i2c_complete(c, b, I2C_ARBLOST, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+        return;
+    }
+
+    const i2c_transfer_t *t = b->current;
+
+    switch(b->state)
+    {
+        case STATE_WRITE:
+        {
+            if(status & I2C_S_RXAK_MASK)
+            {
+                i2c_stop(c, b, I2C_NACK);
+                break;
+            }
+
+            // Skip the write segments that have been sent
+            while((b->segment < t->n_segments) &&
+                  (t->segments[b->segment].dir == I2C_WRITE) &&
+                  (b->index >= t->segments[b->segment].n))
+            {
+                b->segment++;
+                b->index = 0;
+            }
+
+            if(b->segment >= t->n_segments)
+            {
+                // All segments sent
+                i2c_stop(c, b, I2C_OK);
+            }
+            else if(t->segments[b->segment].dir == I2C_WRITE)
+            {
+                // Send the next byte
+                i2c->D = t->segments[b->segment].data[b->index++];
+            }
+            else
+            {
+                b->rx_remaining = i2c_rx_bytes(b);
+
+                if(b->rx_remaining == 0)
+                {
+                    i2c_stop(c, b, I2C_OK);
+                    break;
+                }
+
+                // Repeated start and send device address (read)
+                i2c->C1 |= I2C_C1_RSTA_MASK;
+                i2c->D = t->address | 0x01;
+                b->state = STATE_READ_ADDRESS;
+            }
+            break;
+        }
+
+        case STATE_READ_ADDRESS:
+        {
+            if(status & I2C_S_RXAK_MASK)
+            {
+                i2c_stop(c, b, I2C_NACK);
+                break;
+            }
+
+            // Receive mode
+            i2c->C1 &= ~I2C_C1_TX_MASK;
+
+            // NACK after the first byte if it is the only byte
+            if(b->rx_remaining == 1)
+            {
+                i2c->C1 |= I2C_C1_TXAK_MASK;
+            }
+            else
+            {
+                i2c->C1 &= ~I2C_C1_TXAK_MASK;
+            }
+
+            // Dummy read starts the reception of the first byte
+            (void)i2c->D;
+            b->state = STATE_READ;
+            break;
+        }
+
+        case STATE_READ:
+        {
+            // Skip the read segments that have been filled
+            while(b->index >= t->segments[b->segment].n)
+            {
+                b->segment++;
+                b->index = 0;
+            }
+
+            uint8_t *data = &t->segments[b->segment].data[b->index++];
+
+            if(b->rx_remaining == 1)
+            {
+                // Send stop before reading the last byte, so no further byte
+                // is clocked in
+                i2c_stop(c, b, I2C_OK);
+            }
+            else if(b->rx_remaining == 2)
+            {
+                // NACK after the next byte
+                i2c->C1 |= I2C_C1_TXAK_MASK;
+            }
+
+            // Read data, this starts the reception of the next byte
+            *data = i2c->D;
+            b->rx_remaining--;
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/*!
+ * \brief Submits a transfer
+ *
+ * The transfer is started immediately if the bus is idle, otherwise it is
+ * queued. The transfer is not aborted if it does not complete in time, unless
+ * a task waits for a transfer on the same bus with i2c_transfer(). The
+ * function returns without waiting for the transfer to complete. On
+ * completion the callback is called from the interrupt and the task in the
+ * descriptor is notified. The descriptor and all buffers must remain valid
+ * until then.
+ *
+ * \param[in]  bus       The bus
+ * \param[in]  transfer  Transfer descriptor
+ *
+ * \return True if the transfer was started or queued, false if the queue is
+ *         full
+ */
+bool i2c_submit(const i2c_bus_t bus, i2c_transfer_t *transfer)
+{
+    const i2c_config_t *c = &config[bus];
+    i2c_busstate_t *b = &busstate[bus];
+
+    transfer->status = I2C_PENDING;
+
+    // Read before the critical section, no FreeRTOS API is called in it
+    const TickType_t now = xTaskGetTickCount();
+
+    // Start the transfer if the bus is idle. This only writes the registers.
+    taskENTER_CRITICAL();
+
+    const bool idle = (b->current == NULL) && !b->recovering;
+
+    if(idle)
+    {
+        b->current = transfer;
+        i2c_start(c, b, now);
+    }
+
+    taskEXIT_CRITICAL();
+
+    if(idle)
+    {
+        return true;
+    }
+
+    // Otherwise queue it
+    if(xQueueSendToBack(b->queue, &transfer, 0) != pdPASS)
+    {
+        transfer->status = I2C_QUEUE_FULL;
+        return false;
+    }
+
+    // The bus may have become idle meanwhile
+    i2c_kick(c, b);
+
+    return true;
+}
+
+/*!
+ * \brief Busy waits for at least 5 us
+ *
+ * This is half the SCL period during a bus recovery, so the bus is clocked at
+ * 100 kHz or less. The accuracy is not important.
+ */
+static void i2c_delay(void)
+{
+    for(volatile uint32_t i=0; i<60; i++)
+    {
+    }
+}
+
+/*!
+ * \brief Clears the bus by toggling SCL as GPIO
+ *
+ * A slave that was interrupted in the middle of a transfer, for example by a
+ * reset of the microcontroller, can hold SDA low while it waits for the rest
+ * of a byte. Up to nine SCL pulses are clocked out until the slave releases
+ * SDA, followed by a STOP.
+ *
+ * The lines are driven as open-drain: the output latches are low, a line is
+ * driven low by making the pin an output and released by making it an input.
+ *
+ * \return True if both lines are high, false otherwise
+ */
+static bool i2c_busclear(const i2c_config_t *c)
+{
+    GPIO_Type *gpio = c->gpio;
+    const uint32_t scl = (1UL << c->scl);
+    const uint32_t sda = (1UL << c->sda);
+
+    // Make sure i2c is disabled
+    c->i2c->C1 &= ~(I2C_C1_IICEN_MASK);
+
+    // Set pins to GPIO inputs with pull-ups
+    gpio->PCOR = scl | sda;
+    gpio->PDDR &= ~(scl | sda);
+    c->port->PCR[c->scl] = PORT_PCR_MUX(1) | PORT_PCR_PE_MASK | PORT_PCR_PS_MASK;
+    c->port->PCR[c->sda] = PORT_PCR_MUX(1) | PORT_PCR_PE_MASK | PORT_PCR_PS_MASK;
+    i2c_delay();
+
+    // Clock out bits until the slave releases SDA
+    for(uint32_t i=0; (i<9) && ((gpio->PDIR & sda) == 0); i++)
+    {
+        gpio->PDDR |= scl;
+        i2c_delay();
+        gpio->PDDR &= ~scl;
+        i2c_delay();
+    }
+
+    // STOP: SDA from low to high while SCL is high
+    gpio->PDDR |= scl;
+    i2c_delay();
+    gpio->PDDR |= sda;
+    i2c_delay();
+    gpio->PDDR &= ~scl;
+    i2c_delay();
+    gpio->PDDR &= ~sda;
+    i2c_delay();
+
+    return ((gpio->PDIR & (scl | sda)) == (scl | sda));
+}
+
+/*!
+ * \brief Clears the bus and initialises the peripheral again
+ *
+ * The interrupt of the bus is disabled meanwhile. The caller must have set
+ * the recovering flag, so no transfer is started.
+ */
+static bool i2c_reset(const i2c_config_t *c, i2c_busstate_t *b)
+{
+    NVIC_DisableIRQ(c->irq);
+
+    bool ret = i2c_busclear(c);
+    i2c_hwinit(c, b);
+
+    b->stats.recoveries++;
+    if(!ret)
+    {
+        b->stats.stuck++;
+    }
+
+    NVIC_ClearPendingIRQ(c->irq);
+    NVIC_EnableIRQ(c->irq);
+
+    return ret;
+}
+
+/*!
+ * \brief Recovers a bus
+ *
+ * Clears the bus as described in the I2C specification (UM10204, section
+ * 3.1.16) and initialises the peripheral again. The recovery is skipped if a
+ * transfer is in progress. A transfer that is stuck is aborted and recovered
+ * by i2c_transfer().
+ *
+ * \param[in]  bus  The bus
+ *
+ * \return False if SCL or SDA is still low after the recovery, true otherwise
+ */
+bool i2c_recover(const i2c_bus_t bus)
+{
+    const i2c_config_t *c = &config[bus];
+    i2c_busstate_t *b = &busstate[bus];
+
+    taskENTER_CRITICAL();
+
+    if((b->current != NULL) || b->recovering)
+    {
+        taskEXIT_CRITICAL();
+        return true;
+    }
+
+    b->recovering = true;
+
+    taskEXIT_CRITICAL();
+
+    bool ret = i2c_reset(c, b);
+
+    taskENTER_CRITICAL();
+    b->recovering = false;
+    taskEXIT_CRITICAL();
+
+    // Start the transfers that were queued meanwhile
+    i2c_kick(c, b);
+
+    return ret;
+}
+
+/*!
+ * \brief Aborts the transfer in progress if it has exceeded the timeout
+ *
+ * The aborted transfer completes with I2C_TIMEOUT. The bus is recovered
+ * before the next queued transfer is started.
+ */
+static void i2c_abort(const i2c_bus_t bus)
+{
+    const i2c_config_t *c = &config[bus];
+    i2c_busstate_t *b = &busstate[bus];
+
+    taskENTER_CRITICAL();
+
+    i2c_transfer_t *t = b->current;
+
+    if((t == NULL) || b->recovering ||
+       ((xTaskGetTickCount() - b->started) < pdMS_TO_TICKS(I2C_TIMEOUT_MS)))
+    {
+        taskEXIT_CRITICAL();
+        return;
+    }
+
+    // Take the transfer away from the interrupt handler
+    b->current = NULL;
+    b->state = STATE_IDLE;
+    b->recovering = true;
+
+    taskEXIT_CRITICAL();
+
+    (void)i2c_reset(c, b);
+
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    taskENTER_CRITICAL();
+    b->recovering = false;
+    i2c_finish(b, t, I2C_TIMEOUT, &xHigherPriorityTaskWoken);
+    taskEXIT_CRITICAL();
+
+    // Start the transfers that were queued meanwhile
+    i2c_kick(c, b);
+
+    if(xHigherPriorityTaskWoken == pdTRUE)
+    {
+        taskYIELD();
+    }
+}
+
+/*!
+ * \brief Performs a transfer
+ *
+ * Submits the transfer and blocks the calling task until it has completed.
+ * The CPU is free for other tasks while the transfer is in progress.
+ *
+ * If the transfer on the bus does not complete within I2C_TIMEOUT_MS, it is
+ * aborted and the bus is recovered. A failed transfer is retried up to
+ * I2C_RETRIES times. The calling task is therefore never blocked for more
+ * than approximately (I2C_RETRIES + 1) * (I2C_QUEUE_LENGTH + 1) *
+ * I2C_TIMEOUT_MS.
+ *
+ * \param[in]  bus       The bus
+ * \param[in]  transfer  Transfer descriptor
+ *
+ * \return Status of the transfer
+ */
+i2c_status_t i2c_transfer(const i2c_bus_t bus, i2c_transfer_t *transfer)
+{
+    i2c_busstate_t *b = &busstate[bus];
+
+    transfer->task = xTaskGetCurrentTaskHandle();
+
+    for(uint32_t attempt=0; ; attempt++)
+    {
+        // Make sure a stale notification does not end the wait early
+        ulTaskNotifyValueClearIndexed(NULL, I2C_NOTIFY_INDEX, 0xFFFFFFFF);
+
+        if(!i2c_submit(bus, transfer))
+        {
+            return transfer->status;
+        }
+
+        // A transfer that does not complete in time is stuck. This is either
+        // this transfer or a transfer that was started before it.
+        while(transfer->status == I2C_PENDING)
+        {
+            if(ulTaskNotifyTakeIndexed(I2C_NOTIFY_INDEX, pdTRUE,
+                                       pdMS_TO_TICKS(I2C_TIMEOUT_MS)) == 0)
+            {
+                i2c_abort(bus);
+            }
+        }
+
+        if((transfer->status == I2C_OK) || (attempt >= I2C_RETRIES))
+        {
+            break;
+        }
+
+        // There is only one master on the bus, so a lost arbitration means
+        // that a slave drives SDA. A timed out transfer has already been
+        // recovered.
+        if(transfer->status == I2C_ARBLOST)
+        {
+            (void)i2c_recover(bus);
+        }
+
+        taskENTER_CRITICAL();
+        b->stats.retries++;
+        taskEXIT_CRITICAL();
+    }
+
+    return transfer->status;
+}
+
+/*!
+ * \brief Gets the error and retry counters of a bus
+ *
+ * \param[in]  bus    The bus
+ * \param[out] stats  Copy of the counters
+ */
+void i2c_getstats(const i2c_bus_t bus, i2c_stats_t *stats)
+{
+    taskENTER_CRITICAL();
+    *stats = busstate[bus].stats;
+    taskEXIT_CRITICAL();
+}
+
+/*!
+ * \brief Sets the bit rate of a device
+ *
+ * Transfers to the device are sent at the highest rate that doesn't exceed
+ * the requested rate, other devices on the bus keep their own rate. The rate
+ * changes between transfers, so a slow device doesn't slow down the others.
+ * Rates above 400 kHz are out of spec for the SSD1306 and the MMA8451Q,
+ * but some devices do work at higher rates.
+ *
+ * \param[in]  bus      The bus
+ * \param[in]  address  8-bit slave address
+ * \param[in]  bitrate  Requested bit rate in bits per second
+ *
+ * \return The achieved bit rate, or 0 if there is no free speed profile
+ */
+uint32_t i2c_setspeed(const i2c_bus_t bus, const uint8_t address, const uint32_t bitrate)
+{
+    i2c_busstate_t *b = &busstate[bus];
+    uint32_t achieved;
+    uint8_t f = i2c_divider(bitrate, &achieved);
+
+    taskENTER_CRITICAL();
+
+    uint32_t i;
+    for(i=0; i<b->n_profiles; i++)
+    {
+        if(b->profiles[i].address == address)
+        {
+            break;
+        }
+    }
+
+    if(i == I2C_MAX_PROFILES)
+    {
+        achieved = 0;
+    }
+    else
+    {
+        b->profiles[i].address = address;
+        b->profiles[i].f = f;
+
+        if(i == b->n_profiles)
+        {
+            b->n_profiles++;
+        }
+    }
+
+    taskEXIT_CRITICAL();
+
+    return achieved;
+}
+
+/*!
+ * \brief Calculates the frequency divider register for a bit rate
+ *
+ * The bit rate is bus clock / (mul * SCL divider). Only mul = 1 is used,
+ * because the I2C module can't generate a repeated START with MULT > 0
+ * (KL25Z erratum e6070). This limits the lowest rate to 6250 bps with a
+ * 24 MHz bus clock.
+ *
+ * \param[in]  bitrate   Requested bit rate in bits per second
+ * \param[out] achieved  The highest bit rate that doesn't exceed the
+ *                       requested rate, or NULL
+ *
+ * \return Value for the frequency divider register
+ */
+static uint8_t i2c_divider(const uint32_t bitrate, uint32_t *achieved)
+{
+    const uint32_t busclock = SystemCoreClock /
+        (((SIM->CLKDIV1 & SIM_CLKDIV1_OUTDIV4_MASK) >> SIM_CLKDIV1_OUTDIV4_SHIFT) + 1);
+
+    // Slowest rate if none of the dividers is large enough
+    uint32_t icr = 0x3F;
+    uint32_t divider = scl_divider[icr];
+
+    // Find the smallest divider that doesn't exceed the bit rate. The table
+    // is not sorted.
+    for(uint32_t i=0; i<64; i++)
+    {
+        if((scl_divider[i] < divider) &&
+           ((uint64_t)scl_divider[i] * bitrate >= busclock))
+        {
+            icr = i;
+            divider = scl_divider[i];
+        }
+    }
+
+    if(achieved != NULL)
+    {
+        *achieved = busclock / divider;
+    }
+
+    return (uint8_t)(I2C_F_MULT(0) | I2C_F_ICR(icr));
+}
+
+/*!
+ * \brief Writes a header byte followed by data in a single transfer
+ *
+ * The header is for example a register address or a control byte.
+ *
+ * \param[in]  bus      The bus
+ * \param[in]  address  8-bit slave address
+ * \param[in]  header   Byte that is sent before the data
+ * \param[in]  data     Data bytes
+ * \param[in]  n        Number of data bytes
+ *
+ * \return Status of the transfer
+ */
+i2c_status_t i2c_write(const i2c_bus_t bus, const uint8_t address, const uint8_t header,
+                       const uint8_t data[], const uint32_t n)
+{
+    uint8_t h = header;
+
+    i2c_segment_t segments[] =
+    {
+        {&h, 1, I2C_WRITE},
+        {(uint8_t *)data, n, I2C_WRITE},
+    };
+
+    i2c_transfer_t transfer =
+    {
+        .address = address,
+        .segments = segments,
+        .n_segments = 2,
+    };
+
+    return i2c_transfer(bus, &transfer);
+}
+
+/*!
+ * \brief Writes a list of segments in a single transfer
+ *
+ * All segments are sent back to back after a single START and address byte,
+ * for example a header with control bytes followed by a data buffer. The
+ * segments must all be write segments.
+ *
+ * \param[in]  bus       The bus
+ * \param[in]  address   8-bit slave address
+ * \param[in]  segments  List of write segments
+ * \param[in]  n         Number of segments
+ *
+ * \return Status of the transfer
+ */
+i2c_status_t i2c_writev(const i2c_bus_t bus, const uint8_t address,
+                        const i2c_segment_t segments[], const uint32_t n)
+{
+    i2c_transfer_t transfer =
+    {
+        .address = address,
+        .segments = segments,
+        .n_segments = n,
+    };
+
+    return i2c_transfer(bus, &transfer);
+}
+
+/*!
+ * \brief Reads consecutive registers
+ *
+ * Writes the register address, followed by a repeated start and the read of
+ * \p n bytes.
+ *
+ * \param[in]  bus      The bus
+ * \param[in]  address  8-bit slave address
+ * \param[in]  reg      First register
+ * \param[out] data     Buffer for the data
+ * \param[in]  n        Number of bytes to read
+ *
+ * \return Status of the transfer
+ */
+i2c_status_t i2c_read(const i2c_bus_t bus, const uint8_t address, const uint8_t reg,
+                      uint8_t data[], const uint32_t n)
+{
+    uint8_t r = reg;
+
+    i2c_segment_t segments[] =
+    {
+        {&r, 1, I2C_WRITE},
+        {data, n, I2C_READ},
+    };
+
+    i2c_transfer_t transfer =
+    {
+        .address = address,
+        .segments = segments,
+        .n_segments = 2,
+    };
+
+    return i2c_transfer(bus, &transfer);
+}
+
+void I2C0_IRQHandler(void)
+{
+    i2c_irq(I2C_BUS0);
+}
+
+void I2C1_IRQHandler(void)
+{
+    i2c_irq(I2C_BUS1);
+}
@@ -0,0 +1,169 @@
+/*! ***************************************************************************
+ *
+ * \brief     Interrupt driven I2C master driver
+ * \file      i2c.h
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef I2C_H
+#define I2C_H
+
+#include <MKL25Z4.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*!
+ * \brief Definition for the number of transfers that can wait for a bus
+ */
+#define I2C_QUEUE_LENGTH  (4)
+
+/*!
+ * \brief Definition for the task notification index
+ *
+ * A task that waits for a transfer with i2c_transfer() is notified on this
+ * index, so the default index 0 remains available to the application.
+ */
+#define I2C_NOTIFY_INDEX  (1)
+
+/*!
+ * \brief Definition for the timeout of a transfer in milliseconds
+ *
+ * A transfer that has not completed this long after its START is aborted
+ * and the bus is recovered. The timeout must be longer than the longest
+ * transfer. Sending a complete 128 x 64 framebuffer to the Oled display
+ * takes approximately 25 ms at 375 kbps.
+ */
+#define I2C_TIMEOUT_MS    (50)
+
+/*!
+ * \brief Definition for the number of times i2c_transfer() retries a failed
+ * transfer
+ */
+#define I2C_RETRIES       (2)
+
+/*!
+ * \brief Definition for the default bit rate of a bus in bits per second
+ *
+ * Devices without a speed profile are accessed at the highest rate that
+ * doesn't exceed this rate. See i2c_setspeed().
+ */
+#define I2C_BITRATE       (400000)
+
+/*!
+ * \brief Definition for the number of devices per bus that can have their own
+ * bit rate
+ */
+#define I2C_MAX_PROFILES  (4)
+
+/// The I2C buses
+typedef enum
+{
+    I2C_BUS0 = 0, ///< I2C0: PTE24 (SCL), PTE25 (SDA), MMA8451
+    I2C_BUS1,     ///< I2C1: PTE1 (SCL), PTE0 (SDA), Oled display
+    I2C_N_BUSES,
+} i2c_bus_t;
+
+/// Status of a transfer
+typedef enum
+{
+    I2C_OK = 0,     ///< Transfer completed
+    I2C_PENDING,    ///< Transfer is queued or in progress
+    I2C_NACK,       ///< Slave did not acknowledge
+    I2C_ARBLOST,    ///< Arbitration lost
+    I2C_QUEUE_FULL, ///< Transfer could not be queued
+    I2C_TIMEOUT,    ///< Transfer did not complete in time and was aborted
+} i2c_status_t;
+
+/// Error and retry counters of a bus
+typedef struct
+{
+    uint32_t transfers;  ///< Completed transfers, including failed ones
+    uint32_t nacks;      ///< Transfers that ended with I2C_NACK
+    uint32_t arblost;    ///< Transfers that ended with I2C_ARBLOST
+    uint32_t timeouts;   ///< Transfers that ended with I2C_TIMEOUT
+    uint32_t retries;    ///< Retries by i2c_transfer()
+    uint32_t recoveries; ///< Bus recoveries
+    uint32_t stuck;      ///< Bus recoveries after which a line was still low
+} i2c_stats_t;
+
+/// Direction of a segment
+typedef enum
+{
+    I2C_WRITE = 0,
+    I2C_READ,
+} i2c_dir_t;
+
+/*!
+ * \brief Segment of a transfer
+ *
+ * All segments of a transfer are sent within a single START/STOP. Consecutive
+ * write segments are sent back to back, so a header and a data buffer can be
+ * sent without copying them into a single buffer. A read segment that follows
+ * a write segment is preceded by a repeated start. Read segments must be the
+ * last segments of a transfer.
+ */
+typedef struct
+{
+    uint8_t *data;   ///< Data to write or buffer to read into
+    uint32_t n;      ///< Number of bytes
+    i2c_dir_t dir;   ///< Direction
+} i2c_segment_t;
+
+/// Descriptor of a transfer
+typedef struct i2c_transfer_t
+{
+    uint8_t address;                  ///< 8-bit slave address, R/W bit 0
+    const i2c_segment_t *segments;    ///< List of segments
+    uint32_t n_segments;              ///< Number of segments
+
+    /// Called when the transfer has completed, or NULL. The callback is called
+    /// from the interrupt, or from the task that aborts a stuck transfer.
+    void (*callback)(struct i2c_transfer_t *transfer, BaseType_t *pxHigherPriorityTaskWoken);
+    void *context;                    ///< Free for use by the caller
+
+    TaskHandle_t task;                ///< Notified on completion, or NULL
+    volatile i2c_status_t status;     ///< Status of the transfer
+} i2c_transfer_t;
+
+// Function prototypes
+void i2c_init(const i2c_bus_t bus);
+
+bool i2c_submit(const i2c_bus_t bus, i2c_transfer_t *transfer);
+i2c_status_t i2c_transfer(const i2c_bus_t bus, i2c_transfer_t *transfer);
+bool i2c_recover(const i2c_bus_t bus);
+void i2c_getstats(const i2c_bus_t bus, i2c_stats_t *stats);
+uint32_t i2c_setspeed(const i2c_bus_t bus, const uint8_t address, const uint32_t bitrate);
+
+i2c_status_t i2c_write(const i2c_bus_t bus, const uint8_t address, const uint8_t header,
+                       const uint8_t data[], const uint32_t n);
+i2c_status_t i2c_writev(const i2c_bus_t bus, const uint8_t address,
+                        const i2c_segment_t segments[], const uint32_t n);
+i2c_status_t i2c_read(const i2c_bus_t bus, const uint8_t address, const uint8_t reg,
+                      uint8_t data[], const uint32_t n);
+
+#endif // I2C_H
@@ -57,6 +57,7 @@
 #define configUSE_APPLICATION_TASK_TAG	         0
 #define configUSE_COUNTING_SEMAPHORES	         1
 #define configUSE_TASK_NOTIFICATIONS             1
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES    2
 
 /* For generating runtime statistics */
 #define configGENERATE_RUN_TIME_STATS	         1
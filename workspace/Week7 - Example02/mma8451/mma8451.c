@@ -1,8 +1,4 @@
 #include <MKL25Z4.h>
-#include <math.h>
-
-#include "FreeRTOS.h"
-#include "task.h"
 
 #include "mma8451.h"
 
@@ -10,47 +6,65 @@
   #warning This driver does not work as designed
 #endif
 
-#define M_PI (3.14159265f)
+// Sample periods of the output data rates in microseconds
+static const uint32_t odr_period_us[] =
+{
+    1250, 2500, 5000, 10000, 20000, 80000, 160000, 640000,
+};
 
-extern TaskHandle_t xMma8451TaskHandler;
+// INT1 and INT2 of the MMA8451Q are connected to these pins of PORTA
+#define INT1_PIN (14)
+#define INT2_PIN (15)
 
-int16_t x_out_14_bit = 0,
-        y_out_14_bit = 0,
-        z_out_14_bit = 0;
-float x_out_g = 0,
-      y_out_g = 0,
-      z_out_g = 0;
-float roll = 0.0,
-      pitch = 0.0;
+// Job for the driver task, queued by the interrupt
+typedef struct
+{
+    TickType_t timestamp; // Tick count at the interrupt
+    uint8_t pin;          // INT1_PIN: FIFO, INT2_PIN: events, 0: wake up
+} mma8451_job_t;
 
-float dt = 0;
+// Calibration record in flash, a multiple of 4 bytes so it can be programmed
+// in longwords
+typedef struct
+{
+    flash_record_t header; // MMA8451_CALIBRATION_MAGIC and _VERSION
+    int8_t offset[3];      // OFF_X_REG, OFF_Y_REG and OFF_Z_REG
+    uint8_t reserved;
+    uint32_t crc;          // Written by flash_record_write()
+} mma8451_calibration_t;
 
-// Local function prototypes
+// Configuration of the driver task
+static mma8451_odr_t task_odr;
+static uint8_t task_watermark;
+static mma8451_callback_t task_callback;
+static mma8451_events_t task_events;
+static bool task_events_enabled = false;
 
-static void delay_us(uint32_t d)
-{
+// Jobs queued by the interrupt, received by the driver task
+static QueueHandle_t jobs = NULL;
 
-#if (CLOCK_SETUP != 1)
-#warning This delay function does not work as designed
-#endif
+// Most recent PL_STATUS
+static volatile uint8_t pl_status = 0;
 
-    volatile uint32_t t;
+// Set by mma8451_recalibrate(), cleared when the calibration succeeded
+static volatile bool calibration_requested = false;
+static volatile mma8451_calibrated_t calibration_callback = NULL;
 
-    for(t=4*d; t>0; t--)
-    {
-        __asm("nop");
-        __asm("nop");
-    }
-}
+// Local function prototypes
+static void mma8451_task(void *pvParameters);
+static bool mma8451_configure(const int8_t offset[3]);
+static bool mma8451_store_calibration(const int8_t offset[3]);
+static bool mma8451_write_reg(const uint8_t reg, const uint8_t value);
+static bool mma8451_read_regs(const uint8_t reg, uint8_t data[], const uint32_t n);
 
 bool mma8451_init(void)
 {
-    i2c0_init();
+    i2c_init(I2C_BUS0);
 
     uint8_t value;
 
     // Read the WHO_AM_I_REG register
-    if(!(i2c0_read_byte(MMA8451_ADDRESS, WHO_AM_I_REG, &value)))
+    if(!(mma8451_read_regs(WHO_AM_I_REG, &value, 1)))
     {
         return false;
     }
@@ -62,66 +76,82 @@ bool mma8451_init(void)
     }
 
     // Reset all register to POR values
-    if(!(i2c0_write_byte(MMA8451_ADDRESS, CTRL_REG2, 0x40)))
+    if(!(mma8451_write_reg(CTRL_REG2, 0x40)))
     {
         return false;
     }
 
-    // Wait for RST bit to clear
-    value = 0;
-    do
+    // Wait for RST bit to clear. The device doesn't acknowledge while it is
+    // resetting, so a failed read only means that it is not ready yet.
+    const TickType_t xStart = xTaskGetTickCount();
+    for(;;)
     {
-        // Read the register
-        if(!(i2c0_read_byte(MMA8451_ADDRESS, CTRL_REG2, &value)))
+        vTaskDelay(pdMS_TO_TICKS(1));
+
+        if(mma8451_read_regs(CTRL_REG2, &value, 1) && ((value & 0x40) == 0))
+        {
+            break;
+        }
+
+        if((xTaskGetTickCount() - xStart) >= pdMS_TO_TICKS(MMA8451_TIMEOUT_MS))
         {
             return false;
         }
     }
-    while((value & 0x40) == 0);
 
     // +/-2g range -> 1g = 16384/4 = 4096 counts
-    if(!(i2c0_write_byte(MMA8451_ADDRESS, XYZ_DATA_CFG_REG, 0x00)))
+    if(!(mma8451_write_reg(XYZ_DATA_CFG_REG, 0x00)))
     {
         return false;
     }
 
     // High Resolution mode
-    if(!(i2c0_write_byte(MMA8451_ADDRESS, CTRL_REG2, 0x02)))
+    if(!(mma8451_write_reg(CTRL_REG2, 0x02)))
     {
         return false;
     }
 
     // ODR = 100 Hz, Reduced noise, Active mode
-    if(!(i2c0_write_byte(MMA8451_ADDRESS, CTRL_REG1, 0x1D)))
+    if(!(mma8451_write_reg(CTRL_REG1, 0x1D)))
     {
         return false;
     }
 
-	// Configure the PTA14, connected to the INT1 of the MMA8451Q, for
-    // interrupts on falling edges
+	// Configure the PTA14 and PTA15, connected to the INT1 and INT2 of the
+    // MMA8451Q, for interrupts on falling edges
 	SIM->SCGC5 |= SIM_SCGC5_PORTA_MASK;
-	PORTA->PCR[14] = PORT_PCR_ISF_MASK | PORT_PCR_MUX(0x1) | PORT_PCR_IRQC(0xA);
+	PORTA->PCR[INT1_PIN] = PORT_PCR_ISF_MASK | PORT_PCR_MUX(0x1) | PORT_PCR_IRQC(0xA);
+	PORTA->PCR[INT2_PIN] = PORT_PCR_ISF_MASK | PORT_PCR_MUX(0x1) | PORT_PCR_IRQC(0xA);
 
 	// Enable interrupts
     NVIC_SetPriority(PORTA_IRQn, 64);
     NVIC_ClearPendingIRQ(PORTA_IRQn);
     NVIC_EnableIRQ(PORTA_IRQn);
 
-    // Make sure the time between I2C transfers is > t_BUF (1.3 us)
-    delay_us(10);
-
     return true;
 }
 
+// Calibrates the offsets with the board lying flat, as described in AN4069,
+// and stores them in flash, so the next boot can load them with
+// mma8451_load_calibration(). A failure to store the offsets is not an error,
+// the sensor is calibrated for now. Storing blocks all interrupts for up to
+// 114 ms, see mma8451_recalibrate().
 bool mma8451_calibrate(void)
 {
     uint8_t value = 0;
+    mma8451_sample_t sample;
 
     // Wait for data
+    const TickType_t xStart = xTaskGetTickCount();
     do
     {
+        if((xTaskGetTickCount() - xStart) >= pdMS_TO_TICKS(MMA8451_TIMEOUT_MS))
+        {
+            return false;
+        }
+
         // Read the status register
-        if(!(i2c0_read_byte(MMA8451_ADDRESS, STATUS_REG, &value)))
+        if(!(mma8451_read_regs(STATUS_REG, &value, 1)))
         {
             return false;
         }
@@ -129,129 +159,656 @@ bool mma8451_calibrate(void)
     while((value & 0x08) == 0);
 
     // Read values
-    mma8451_read();
+    if(!mma8451_read(&sample))
+    {
+        return false;
+    }
 
     // Calculate offsets as described in AN4069
-    signed char x_offset = -1 * (x_out_14_bit >> 3);
-    signed char y_offset = -1 * (y_out_14_bit >> 3);
-    signed char z_offset = COUNTS_PER_G - (z_out_14_bit >> 3);
+    int8_t offset[3] =
+    {
+        -1 * (sample.x >> 3),
+        -1 * (sample.y >> 3),
+        COUNTS_PER_G - (sample.z >> 3),
+    };
 
-    // Standby mode
-    if(!(i2c0_write_byte(MMA8451_ADDRESS, CTRL_REG1, 0x00)))
+    if(!mma8451_configure(offset))
     {
         return false;
     }
 
-    // Offsets
-    if(!(i2c0_write_byte(MMA8451_ADDRESS, OFF_X_REG, x_offset)))
+    mma8451_store_calibration(offset);
+
+    return true;
+}
+
+// Loads the offsets stored by mma8451_calibrate() from flash and configures
+// the sensor like mma8451_calibrate() does.
+//
+// Returns false if there is no valid calibration record, or if the sensor
+// doesn't respond
+bool mma8451_load_calibration(void)
+{
+    mma8451_calibration_t record =
+    {
+        .header = {MMA8451_CALIBRATION_MAGIC, MMA8451_CALIBRATION_VERSION},
+    };
+
+    // An erased sector or a record of another version is rejected
+    if(!flash_record_read(MMA8451_CALIBRATION_FLASH, MMA8451_CALIBRATION_ADDRESS,
+                          &record, sizeof(record)))
+    {
+        return false;
+    }
+
+    return mma8451_configure(record.offset);
+}
+
+// Requests the driver task to calibrate the sensor again and replace the
+// stored offsets. The board must be lying flat. Before mma8451_start() is
+// called, the request makes the task calibrate instead of loading the stored
+// offsets.
+//
+// calibrated is called by the driver task when the calibration succeeded. If
+// it failed, it is called once with false and the task keeps trying until it
+// succeeds. calibrated may be NULL.
+//
+// Storing the offsets erases the flash sector with interrupts disabled,
+// typically for 14 ms and up to 114 ms. All interrupts are delayed for this
+// time: the FreeRTOS tick falls behind, received serial characters and
+// results of the TPM triggered ADC scans may be lost and I2C transfers of
+// other tasks stall. Only request a recalibration when the application can
+// tolerate this, e.g. on a button press as in main.c.
+void mma8451_recalibrate(mma8451_calibrated_t calibrated)
+{
+    calibration_callback = calibrated;
+    calibration_requested = true;
+
+    if(jobs != NULL)
+    {
+        // Wake the driver task. If the queue is full, the task is woken by
+        // the next job anyway.
+        mma8451_job_t job = {xTaskGetTickCount(), 0};
+        xQueueSendToFront(jobs, &job, 0);
+    }
+}
+
+bool mma8451_read(mma8451_sample_t *sample)
+{
+	uint8_t data[6];
+
+    // Read the six output registers in a single transfer
+	if(!(mma8451_read_regs(OUT_X_MSB_REG, data, sizeof(data))))
     {
         return false;
     }
 
-    if(!(i2c0_write_byte(MMA8451_ADDRESS, OFF_Y_REG, y_offset)))
+    // Combine the read bytes to 16-bit values and compute 14-bit signed
+    // results
+    sample->x = (int16_t)((data[0]<<8) | data[1]) >> 2;
+    sample->y = (int16_t)((data[2]<<8) | data[3]) >> 2;
+    sample->z = (int16_t)((data[4]<<8) | data[5]) >> 2;
+
+    return true;
+}
+
+// Enables the FIFO in circular mode. The samples are read in batches with
+// mma8451_fifo_read(). The FIFO watermark interrupt on INT1 - PTA14
+// notifies the task once every watermark samples instead of every sample.
+// Call this function after mma8451_calibrate().
+//
+// odr:       output data rate, up to 800 Hz
+// watermark: number of samples that triggers the interrupt, 1 to 32
+bool mma8451_fifo_init(const mma8451_odr_t odr, const uint8_t watermark)
+{
+    if((watermark == 0) || (watermark > MMA8451_FIFO_SIZE) || (odr > MMA8451_ODR_1_56HZ))
     {
         return false;
     }
 
-    if(!(i2c0_write_byte(MMA8451_ADDRESS, OFF_Z_REG, z_offset)))
+    // Standby mode, the FIFO can only be configured in standby mode
+    if(!(mma8451_write_reg(CTRL_REG1, 0x00)))
     {
         return false;
     }
 
-    // Push-pull, active low interrupt
-    if(!(i2c0_write_byte(MMA8451_ADDRESS, CTRL_REG3, 0x00)))
+    // The FIFO must be disabled before its mode can be changed
+    if(!(mma8451_write_reg(F_SETUP_REG, 0x00)))
     {
         return false;
     }
 
-    // Enable DRDY interrupt
-    if(!(i2c0_write_byte(MMA8451_ADDRESS, CTRL_REG4, 0x01)))
+    // Circular mode, the oldest sample is discarded when the FIFO overflows
+    if(!(mma8451_write_reg(F_SETUP_REG, 0x40 | (watermark & 0x3F))))
     {
         return false;
     }
 
-    // DRDY interrupt routed to INT1 - PTA14
-    if(!(i2c0_write_byte(MMA8451_ADDRESS, CTRL_REG5, 0x01)))
+    // Enable FIFO interrupt
+    if(!(mma8451_write_reg(CTRL_REG4, 0x40)))
     {
         return false;
     }
 
-    // ODR = 100 Hz, Reduced noise, Active mode
-    // Notice that delta dt is fixed, because it is set by ODR and DRDY
-    // interrupts are enabled. This doesn't require a timer to measure delta t.
-    dt = 0.010f;
-    if(!(i2c0_write_byte(MMA8451_ADDRESS, CTRL_REG1, 0x1D)))
+    // FIFO interrupt routed to INT1 - PTA14
+    if(!(mma8451_write_reg(CTRL_REG5, 0x40)))
     {
         return false;
     }
 
-    // Make sure the time between I2C transfers is > t_BUF (1.3 us)
-    delay_us(10);
+    // ODR, Reduced noise, Active mode
+    // Notice that F_READ must be cleared, because the FIFO holds 14-bit data
+    if(!(mma8451_write_reg(CTRL_REG1, (odr << 3) | 0x05)))
+    {
+        return false;
+    }
 
     return true;
 }
 
-void mma8451_read(void)
+// Reads up to n samples from the FIFO in a single I2C transfer. In FIFO mode
+// the register address wraps from OUT_Z_LSB_REG to OUT_X_MSB_REG, so a burst
+// read of n * 6 bytes drains n samples. The FIFO interrupt is only generated
+// again after the number of samples dropped below the watermark, so n should
+// be at least the watermark.
+//
+// samples:  buffer for n samples
+// n:        size of the buffer
+// overflow: set if samples were lost since the previous read, can be NULL
+//
+// Returns the number of samples read, 0 on an error or if the FIFO is empty
+uint32_t mma8451_fifo_read(mma8451_sample_t samples[], const uint32_t n, bool *overflow)
 {
-	int i;
-	uint8_t data[6];
+    uint8_t status;
 
-    i2c0_start();
+    if(!(mma8451_read_regs(F_STATUS_REG, &status, 1)))
+    {
+        return 0;
+    }
 
-	if(!(i2c0_read_setup(MMA8451_ADDRESS, OUT_X_MSB_REG)))
+    if(overflow != NULL)
     {
-        mma8451_init();
-        return;
+        *overflow = (status & 0x80) != 0;
+    }
+
+    uint32_t count = status & 0x3F;
+    count = (count > n) ? n : count;
+
+    if(count == 0)
+    {
+        return 0;
+    }
+
+    // The bytes are received in the buffer of the caller. Every sample is
+    // converted in place, as a sample has the same size as its raw data.
+    uint8_t *data = (uint8_t *)samples;
+
+    if(!(mma8451_read_regs(OUT_X_MSB_REG, data, count * 6)))
+    {
+        return 0;
+    }
+
+    for(uint32_t i=0; i<count; i++)
+    {
+        const uint8_t *p = &data[i * 6];
+
+        // Combine the read bytes to 16-bit values and compute 14-bit
+        // signed results
+        int16_t x = (int16_t)((p[0]<<8) | p[1]) >> 2;
+        int16_t y = (int16_t)((p[2]<<8) | p[3]) >> 2;
+        int16_t z = (int16_t)((p[4]<<8) | p[5]) >> 2;
+
+        samples[i].x = x;
+        samples[i].y = y;
+        samples[i].z = z;
+    }
+
+    return count;
+}
+
+// Calculates roll and pitch in degrees
+void mma8451_rollpitch(const mma8451_data_t *data, q16_t *roll, q16_t *pitch)
+{
+    // The arctangent only depends on the ratio of its arguments, so the raw
+    // counts are used. The sum of squares of two 14-bit values is at most
+    // 2^27, so it is scaled by 16 to get two more bits from the square
+    // root. x is scaled by 4 to match.
+    uint32_t sq = ((uint32_t)((int32_t)data->y * data->y) +
+                   (uint32_t)((int32_t)data->z * data->z)) << 4;
+    uint32_t yz = isqrt32(sq);
+
+    // Round to nearest, (yz + 0.5)^2 = yz^2 + yz + 0.25
+    if((sq - yz * yz) > yz)
+    {
+        yz++;
+    }
+
+    *roll = q16_mul(q16_atan2(data->y, data->z), Q16_RAD2DEG);
+    *pitch = q16_mul(q16_atan2((int32_t)data->x * 4, (int32_t)yz), Q16_RAD2DEG);
+}
+
+// Configures the motion, transient and orientation detection and routes their
+// interrupts to INT2. The interrupts of other functions are not changed. The
+// configuration is changed in standby mode, after which the previous mode is
+// restored.
+//
+// events: configuration of the event functions
+//
+// Returns false on a communication error
+bool mma8451_events_init(const mma8451_events_t *events)
+{
+    uint8_t ctrl1;
+    uint8_t ctrl45[2];
+
+    if(!(mma8451_read_regs(CTRL_REG1, &ctrl1, 1)) ||
+       !(mma8451_read_regs(CTRL_REG4, ctrl45, 2)))
+    {
+        return false;
+    }
+
+    // Standby mode
+    if(!(mma8451_write_reg(CTRL_REG1, ctrl1 & ~0x01)))
+    {
+        return false;
     }
 
-	// Read five bytes in repeated mode
-	for(i=0; i<5; i++)
+    // Disable the transient, orientation and motion interrupts. A cleared
+    // bit in CTRL_REG5 routes the interrupt to INT2.
+    ctrl45[0] &= ~0x34;
+    ctrl45[1] &= ~0x34;
+
+    if(events->motion_threshold > 0)
     {
-        if(!(i2c0_repeated_read(false, &data[i])))
+        // Event latch, motion (OR of the axes), X and Y axes
+        // Debounce counter is cleared when the condition is not met
+        if(!(mma8451_write_reg(FF_MT_CFG_REG, 0xD8)) ||
+           !(mma8451_write_reg(FF_MT_THS_REG, 0x80 | (events->motion_threshold & 0x7F))) ||
+           !(mma8451_write_reg(FF_MT_COUNT_REG, events->motion_count)))
         {
-            mma8451_init();
-            return;
+            return false;
         }
-	}
 
-	// Read last byte ending repeated mode
-	if(!(i2c0_repeated_read(true, &data[i])))
+        ctrl45[0] |= 0x04;
+    }
+
+    if(events->transient_threshold > 0)
     {
-        mma8451_init();
-        return;
+        // Event latch, X, Y and Z axes through the high-pass filter
+        // Debounce counter is cleared when the condition is not met
+        if(!(mma8451_write_reg(TRANSIENT_CFG_REG, 0x1E)) ||
+           !(mma8451_write_reg(TRANSIENT_THS_REG, 0x80 | (events->transient_threshold & 0x7F))) ||
+           !(mma8451_write_reg(TRANSIENT_COUNT_REG, events->transient_count)))
+        {
+            return false;
+        }
+
+        ctrl45[0] |= 0x20;
+    }
+
+    if(events->orientation_count > 0)
+    {
+        // Debounce counter is cleared when the condition is not met,
+        // portrait/landscape detection enabled
+        if(!(mma8451_write_reg(PL_CFG_REG, 0xC0)) ||
+           !(mma8451_write_reg(PL_COUNT_REG, events->orientation_count)))
+        {
+            return false;
+        }
+
+        ctrl45[0] |= 0x10;
+    }
+
+    if(!(mma8451_write_reg(CTRL_REG4, ctrl45[0])) ||
+       !(mma8451_write_reg(CTRL_REG5, ctrl45[1])))
+    {
+        return false;
+    }
+
+    // Restore the previous mode
+    if(!(mma8451_write_reg(CTRL_REG1, ctrl1)))
+    {
+        return false;
     }
 
-    // Combine the read bytes to 16-bit values
-    x_out_14_bit = (int16_t)((data[0]<<8) | data[1]);
-    y_out_14_bit = (int16_t)((data[2]<<8) | data[3]);
-    z_out_14_bit = (int16_t)((data[4]<<8) | data[5]);
+    return true;
+}
+
+// Reads and clears the event sources. The event interrupt on INT2 is
+// released when all sources have been read. Sources are read again until
+// none is left, so an event that occurs meanwhile doesn't keep INT2 asserted.
+//
+// Returns the MMA8451_EVENT_* bits of the events that occurred
+uint32_t mma8451_read_events(void)
+{
+    uint32_t events = 0;
+    uint8_t source;
+    uint8_t value;
+
+    for(uint32_t i=0; i<4; i++)
+    {
+        if(!(mma8451_read_regs(INT_SOURCE_REG, &source, 1)) || ((source & 0x34) == 0))
+        {
+            break;
+        }
+
+        if((source & 0x04) && mma8451_read_regs(FF_MT_SRC_REG, &value, 1))
+        {
+            events |= MMA8451_EVENT_MOTION;
+        }
+
+        if((source & 0x20) && mma8451_read_regs(TRANSIENT_SRC_REG, &value, 1))
+        {
+            events |= MMA8451_EVENT_TRANSIENT;
+        }
+
+        if((source & 0x10) && mma8451_read_regs(PL_STATUS_REG, &value, 1))
+        {
+            pl_status = value;
+            events |= MMA8451_EVENT_ORIENTATION;
+        }
+    }
+
+    return events;
+}
+
+// Returns the PL_STATUS register at the most recent orientation event. Bit 7
+// indicates a valid reading, bits 2:1 the portrait/landscape orientation and
+// bit 0 back (1) or front (0) facing.
+uint8_t mma8451_orientation(void)
+{
+    return pl_status;
+}
+
+// Creates the driver task. The task initialises the sensor, loads the
+// offsets stored in flash or calibrates the sensor if there are none, enables
+// the FIFO and calls the callback with every batch of samples. If the
+// sensor stops responding, it is initialised again. The task is the only
+// user of the sensor, so the other functions must not be called once the
+// task is started.
+//
+// The event functions are handled by the driver task as well. If an idle time
+// is configured, the task stops reading batches when the board doesn't move
+// and blocks until a motion or transient event occurs.
+//
+// odr:       output data rate, up to 800 Hz
+// watermark: number of samples per batch, 1 to 32
+// callback:  called from the driver task with every batch, see
+//            MMA8451_CALLBACK_STACK_SIZE
+// events:    configuration of the event functions, or NULL
+//
+// Returns false if the task could not be created
+bool mma8451_start(const mma8451_odr_t odr, const uint8_t watermark,
+                   mma8451_callback_t callback, const mma8451_events_t *events)
+{
+    task_odr = odr;
+    task_watermark = watermark;
+    task_callback = callback;
+
+    if(events != NULL)
+    {
+        task_events = *events;
+        task_events_enabled = true;
+    }
+
+    jobs = xQueueCreate(MMA8451_JOB_QUEUE_LENGTH, sizeof(mma8451_job_t));
+    if(jobs == NULL)
+    {
+        return false;
+    }
 
-    // Compute 14-bit signed result
-    x_out_14_bit >>= 2;
-    y_out_14_bit >>= 2;
-    z_out_14_bit >>= 2;
+    vQueueAddToRegistry(jobs, "mma8451");
 
-    // Compute result in g's
-    x_out_g = (float)x_out_14_bit / COUNTS_PER_G;
-    y_out_g = (float)y_out_14_bit / COUNTS_PER_G;
-    z_out_g = (float)z_out_14_bit / COUNTS_PER_G;
+    return (xTaskCreate(mma8451_task, "MMA8451", MMA8451_TASK_STACK_SIZE, NULL,
+                        MMA8451_TASK_PRIORITY, NULL) == pdPASS);
 }
 
-void mma8451_rollpitch(void)
+static void mma8451_task(void *pvParameters)
 {
-	roll = atan2(y_out_g, z_out_g)*180/M_PI;
-	pitch = atan2(x_out_g, sqrt(y_out_g*y_out_g + z_out_g*z_out_g))*180/M_PI;
+    // Static, because the task's stack is too small
+    static mma8451_sample_t samples[MMA8451_FIFO_SIZE];
+    static mma8451_data_t data[MMA8451_FIFO_SIZE];
+
+    const int32_t period_us = (int32_t)odr_period_us[task_odr];
+    const int32_t tick_us = 1000000 / configTICK_RATE_HZ;
+
+    // A batch is expected every watermark samples
+    const TickType_t timeout = pdMS_TO_TICKS((task_watermark * period_us) / 1000 +
+                                             MMA8451_TIMEOUT_MS);
+
+    const TickType_t idle = pdMS_TO_TICKS(task_events.idle_ms);
+
+    bool ready = false;
+    bool sleeping = false;
+    bool calibration_failed = false;
+    TickType_t last_motion = 0;
+
+    for(;;)
+    {
+        if(!ready)
+        {
+            // Initialise the sensor. This is repeated until the sensor
+            // responds. The I2C driver limits the time every attempt takes.
+            // The stored offsets are used, unless there are none or a
+            // calibration was requested.
+            const bool calibrate = calibration_requested;
+
+            ready = mma8451_init() &&
+                    ((!calibrate && mma8451_load_calibration()) || mma8451_calibrate());
+
+            // A requested calibration remains requested until it succeeded,
+            // so a failure doesn't fall back to the stored offsets. The
+            // failure is reported once.
+            if(calibrate)
+            {
+                const mma8451_calibrated_t callback = calibration_callback;
+
+                if(ready)
+                {
+                    calibration_requested = false;
+                }
+
+                if((ready || !calibration_failed) && (callback != NULL))
+                {
+                    callback(ready);
+                }
+
+                calibration_failed = !ready;
+            }
+
+            ready = ready &&
+                    mma8451_fifo_init(task_odr, task_watermark) &&
+                    (!task_events_enabled || mma8451_events_init(&task_events));
+
+            if(!ready)
+            {
+                vTaskDelay(pdMS_TO_TICKS(MMA8451_TIMEOUT_MS));
+                continue;
+            }
+
+            sleeping = false;
+            last_motion = xTaskGetTickCount();
+        }
+
+        // Wait for an interrupt. While sleeping there are no FIFO
+        // interrupts, so only an event ends the wait.
+        mma8451_job_t job;
+        if(xQueueReceive(jobs, &job, sleeping ? portMAX_DELAY : timeout) != pdPASS)
+        {
+            // The sensor stopped responding
+            ready = false;
+            continue;
+        }
+
+        if(calibration_requested)
+        {
+            // Initialise and calibrate the sensor again
+            ready = false;
+            continue;
+        }
+
+        TickType_t timestamp = job.timestamp;
+
+        if(job.pin == INT2_PIN)
+        {
+            uint32_t events = mma8451_read_events();
+
+            if(events & (MMA8451_EVENT_MOTION | MMA8451_EVENT_TRANSIENT))
+            {
+                last_motion = timestamp;
+
+                if(sleeping)
+                {
+                    // Enable the FIFO interrupt again before the FIFO is
+                    // drained, so the next watermark causes a falling edge.
+                    // The samples in the FIFO are outdated and discarded.
+                    sleeping = false;
+                    PORTA->PCR[INT1_PIN] = PORT_PCR_ISF_MASK | PORT_PCR_MUX(0x1) | PORT_PCR_IRQC(0xA);
+                    mma8451_fifo_read(samples, MMA8451_FIFO_SIZE, NULL);
+                }
+            }
+
+            if((events != 0) && (task_events.task != NULL))
+            {
+                xTaskNotify(task_events.task, events, eSetBits);
+            }
+
+            continue;
+        }
+
+        // Drain the FIFO in a single transfer
+        uint32_t n = mma8451_fifo_read(samples, MMA8451_FIFO_SIZE, NULL);
+
+        if(n == 0)
+        {
+            continue;
+        }
+
+        // The interrupt was generated when sample number watermark was taken.
+        // The other samples are timestamped relative to that sample.
+        for(uint32_t i=0; i<n; i++)
+        {
+            int32_t offset = ((int32_t)i - (task_watermark - 1)) * period_us;
+
+            data[i].timestamp = timestamp + offset / tick_us;
+            data[i].x = samples[i].x;
+            data[i].y = samples[i].y;
+            data[i].z = samples[i].z;
+        }
+
+        if(task_callback != NULL)
+        {
+            task_callback(data, n);
+        }
+
+        // Stop reading batches if the board didn't move for a while. The
+        // sensor continues sampling in its circular FIFO, but the FIFO
+        // interrupt is ignored.
+        if((idle > 0) && ((xTaskGetTickCount() - last_motion) >= idle))
+        {
+            sleeping = true;
+            PORTA->PCR[INT1_PIN] = PORT_PCR_MUX(0x1) | PORT_PCR_IRQC(0x0);
+        }
+    }
 }
 
 void PORTA_IRQHandler(void)
 {
     NVIC_ClearPendingIRQ(PORTA_IRQn);
 
-    // Clear the interrupt
-    PORTA->PCR[14] |= PORT_PCR_ISF_MASK;
+    // Clear the interrupts
+    uint32_t flags = PORTA->ISFR & ((1 << INT1_PIN) | (1 << INT2_PIN));
+    PORTA->ISFR = flags;
 
-    // Notify the task
+    if(jobs == NULL)
+    {
+        return;
+    }
+
+    // Queue a job for the driver task with the time of the interrupt. If the
+    // queue is full, the samples are read by one of the queued jobs.
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    vTaskNotifyGiveFromISR(xMma8451TaskHandler, &xHigherPriorityTaskWoken);
+    mma8451_job_t job = {xTaskGetTickCountFromISR(), 0};
+
+    if(flags & (1 << INT1_PIN))
+    {
+        job.pin = INT1_PIN;
+        xQueueSendFromISR(jobs, &job, &xHigherPriorityTaskWoken);
+    }
+
+    if(flags & (1 << INT2_PIN))
+    {
+        job.pin = INT2_PIN;
+        xQueueSendFromISR(jobs, &job, &xHigherPriorityTaskWoken);
+    }
+
     portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
+
+// Writes the offsets and activates the sensor again, so the samples can be
+// read with mma8451_read(). No interrupt is enabled: the driver task selects
+// its output data rate and enables the FIFO watermark interrupt with
+// mma8451_fifo_init().
+static bool mma8451_configure(const int8_t offset[3])
+{
+    // Standby mode
+    if(!(mma8451_write_reg(CTRL_REG1, 0x00)))
+    {
+        return false;
+    }
+
+    // Offsets
+    if(!(mma8451_write_reg(OFF_X_REG, offset[0])))
+    {
+        return false;
+    }
+
+    if(!(mma8451_write_reg(OFF_Y_REG, offset[1])))
+    {
+        return false;
+    }
+
+    if(!(mma8451_write_reg(OFF_Z_REG, offset[2])))
+    {
+        return false;
+    }
+
+    // Push-pull, active low interrupt
+    if(!(mma8451_write_reg(CTRL_REG3, 0x00)))
+    {
+        return false;
+    }
+
+    // ODR = 100 Hz as set by mma8451_init(), Reduced noise, Active mode
+    if(!(mma8451_write_reg(CTRL_REG1, 0x1D)))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+
+// Replaces the calibration record in flash. Interrupts are disabled while
+// the flash sector is erased, which can take up to 114 ms.
+static bool mma8451_store_calibration(const int8_t offset[3])
+{
+    mma8451_calibration_t record =
+    {
+        .header = {MMA8451_CALIBRATION_MAGIC, MMA8451_CALIBRATION_VERSION},
+        .offset = {offset[0], offset[1], offset[2]},
+        .reserved = 0xFF,
+    };
+
+    return (flash_record_write(MMA8451_CALIBRATION_FLASH, MMA8451_CALIBRATION_ADDRESS,
+                               &record, sizeof(record)) == FLASH_OK);
+}
+
+static bool mma8451_write_reg(const uint8_t reg, const uint8_t value)
+{
+    return (i2c_write(I2C_BUS0, MMA8451_ADDRESS, reg, &value, 1) == I2C_OK);
+}
+
+static bool mma8451_read_regs(const uint8_t reg, uint8_t data[], const uint32_t n)
+{
+    return (i2c_read(I2C_BUS0, MMA8451_ADDRESS, reg, data, n) == I2C_OK);
+}
@@ -1,11 +1,18 @@
 #ifndef MMA8451_H
 #define MMA8451_H
 
-#include "i2c0.h"
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "task.h"
+
+#include "fixmath.h"
+#include "flash.h"
+#include "i2c.h"
 
 #define MMA8451_ADDRESS  (0x3A)
 
 #define STATUS_REG       (0x00)
+#define F_STATUS_REG     (0x00)
 
 #define OUT_X_MSB_REG    (0x01)
 #define OUT_X_LSB_REG    (0x02)
@@ -14,9 +21,26 @@
 #define OUT_Z_MSB_REG    (0x05)
 #define OUT_Z_LSB_REG    (0x06)
 
+#define F_SETUP_REG      (0x09)
+
+#define INT_SOURCE_REG   (0x0C)
 #define XYZ_DATA_CFG_REG (0x0E)
 #define WHO_AM_I_REG     (0x0D)
 
+#define PL_STATUS_REG    (0x10)
+#define PL_CFG_REG       (0x11)
+#define PL_COUNT_REG     (0x12)
+
+#define FF_MT_CFG_REG    (0x15)
+#define FF_MT_SRC_REG    (0x16)
+#define FF_MT_THS_REG    (0x17)
+#define FF_MT_COUNT_REG  (0x18)
+
+#define TRANSIENT_CFG_REG   (0x1D)
+#define TRANSIENT_SRC_REG   (0x1E)
+#define TRANSIENT_THS_REG   (0x1F)
+#define TRANSIENT_COUNT_REG (0x20)
+
 #define CTRL_REG1        (0x2A)
 #define CTRL_REG2        (0x2B)
 #define CTRL_REG3        (0x2C)
@@ -31,15 +55,132 @@
 
 #define COUNTS_PER_G     (4096)
 
-extern int16_t x_out_14_bit, y_out_14_bit, z_out_14_bit;
-extern float x_out_g, y_out_g, z_out_g;
-extern float roll, pitch;
-extern float dt;
-extern bool mma8451_ready_flag;
+// Maximum time to wait for the device to reset or to have new data
+#define MMA8451_TIMEOUT_MS (100)
+
+// Number of samples the FIFO can hold
+#define MMA8451_FIFO_SIZE  (32)
+
+// Stack in words that the callback of mma8451_start() may use. The driver
+// task itself fits in configMINIMAL_STACK_SIZE. The median, IIR and atan2
+// stages of the example callback use less than half of this budget, because
+// their buffers are static. A callback that formats strings with sprintf()
+// needs a larger budget. Check the budget with uxTaskGetStackHighWaterMark()
+// when the callback is changed.
+#ifndef MMA8451_CALLBACK_STACK_SIZE
+#define MMA8451_CALLBACK_STACK_SIZE (96)
+#endif
+
+// Driver task created by mma8451_start()
+#define MMA8451_TASK_PRIORITY    (4)
+#define MMA8451_TASK_STACK_SIZE  (configMINIMAL_STACK_SIZE + MMA8451_CALLBACK_STACK_SIZE)
+
+// Number of FIFO interrupts that can wait for the driver task
+#define MMA8451_JOB_QUEUE_LENGTH (4)
+
+// Event bits, notified to the task in mma8451_events_t
+#define MMA8451_EVENT_MOTION      (1UL << 0)
+#define MMA8451_EVENT_TRANSIENT   (1UL << 1)
+#define MMA8451_EVENT_ORIENTATION (1UL << 2)
+
+// Calibration record stored in the flash data sector. The version must be
+// incremented when the layout of the record changes, so a record written by
+// older firmware is not used. MMA8451_CALIBRATION_FLASH is the flash_t that
+// holds the sector, a host test can replace it by a model.
+#ifndef MMA8451_CALIBRATION_FLASH
+#define MMA8451_CALIBRATION_FLASH   (&flash_ftfa)
+#endif
+#define MMA8451_CALIBRATION_ADDRESS (FLASH_DATA_ADDRESS)
+#define MMA8451_CALIBRATION_MAGIC   (0x4D4D4138) // "MMA8"
+#define MMA8451_CALIBRATION_VERSION (1)
+
+// Converts 14-bit counts to g in Q16.16
+#define MMA8451_TO_G(counts) (((q16_t)(counts) * Q16_ONE) / COUNTS_PER_G)
+
+// Output data rates, the values are the DR bits in CTRL_REG1
+typedef enum
+{
+    MMA8451_ODR_800HZ = 0,
+    MMA8451_ODR_400HZ,
+    MMA8451_ODR_200HZ,
+    MMA8451_ODR_100HZ,
+    MMA8451_ODR_50HZ,
+    MMA8451_ODR_12_5HZ,
+    MMA8451_ODR_6_25HZ,
+    MMA8451_ODR_1_56HZ,
+} mma8451_odr_t;
+
+// Raw 14-bit sample
+typedef struct
+{
+    int16_t x;
+    int16_t y;
+    int16_t z;
+} mma8451_sample_t;
+
+// Sample delivered by the driver task
+typedef struct
+{
+    TickType_t timestamp; // Tick count at which the sample was taken
+    int16_t x;            // 14-bit counts
+    int16_t y;
+    int16_t z;
+} mma8451_data_t;
+
+// Configuration of the embedded event functions. The events are routed to
+// INT2 - PTA15. Thresholds are in steps of 0.063 g and debounce counts in
+// samples at the output data rate.
+typedef struct
+{
+    // Motion is detected when the X or Y axis exceeds the threshold. The Z
+    // axis is not used, so gravity doesn't trigger it when the board is lying
+    // flat. 0 disables motion detection.
+    uint8_t motion_threshold;
+    uint8_t motion_count;
+
+    // A transient is detected when any high-pass filtered axis exceeds the
+    // threshold. 0 disables transient detection.
+    uint8_t transient_threshold;
+    uint8_t transient_count;
+
+    // Portrait/landscape detection. 0 disables orientation detection.
+    uint8_t orientation_count;
+
+    // The driver task stops reading batches if there was no motion or
+    // transient event for this time, and continues at the next event.
+    // 0 keeps reading batches.
+    uint32_t idle_ms;
+
+    // Task that is notified with the MMA8451_EVENT_* bits on notification
+    // index 0, or NULL
+    TaskHandle_t task;
+} mma8451_events_t;
+
+// Called by the driver task with the samples of a FIFO batch, oldest first.
+// The data is only valid during the call. The callback runs on the stack of
+// the driver task and may use up to MMA8451_CALLBACK_STACK_SIZE words.
+typedef void (*mma8451_callback_t)(const mma8451_data_t data[], const uint32_t n);
+
+// Called by the driver task with the result of a calibration that was
+// requested with mma8451_recalibrate(). The callback runs on the stack of the
+// driver task, like mma8451_callback_t.
+typedef void (*mma8451_calibrated_t)(const bool success);
 
 bool mma8451_init(void);
 bool mma8451_calibrate(void);
-void mma8451_read(void);
-void mma8451_rollpitch(void);
+bool mma8451_load_calibration(void);
+void mma8451_recalibrate(mma8451_calibrated_t calibrated);
+bool mma8451_read(mma8451_sample_t *sample);
+void mma8451_rollpitch(const mma8451_data_t *data, q16_t *roll, q16_t *pitch);
+
+bool mma8451_fifo_init(const mma8451_odr_t odr, const uint8_t watermark);
+uint32_t mma8451_fifo_read(mma8451_sample_t samples[], const uint32_t n, bool *overflow);
+
+bool mma8451_events_init(const mma8451_events_t *events);
+uint32_t mma8451_read_events(void);
+uint8_t mma8451_orientation(void);
+
+bool mma8451_start(const mma8451_odr_t odr, const uint8_t watermark,
+                   mma8451_callback_t callback, const mma8451_events_t *events);
 
 #endif
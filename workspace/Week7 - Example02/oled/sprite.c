@@ -0,0 +1,192 @@
+/*! ***************************************************************************
+ *
+ * \brief     Sprites for the SSD1306 driver
+ * \file      sprite.c
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include "ssd1306.h"
+
+/*!
+ * \brief Circle with a diameter of 5 pixels
+ *
+ * Can be used as a cursor. The center of the circle is at (2,2).
+ */
+static const uint8_t sprite_circle_data[] =
+{
+    0x0E, 0x11, 0x11, 0x11, 0x0E,
+};
+
+const sprite_bitmap_t sprite_circle =
+{
+    .width = 5,
+    .height = 5,
+    .data = sprite_circle_data,
+};
+
+/*!
+ * \brief XORs a bitmap into the framebuffer at (x,y)
+ *
+ * Only the byte-aligned bounding box of the bitmap is touched and only the
+ * pages in that bounding box are marked dirty. Applying the same bitmap twice
+ * at the same location restores the original framebuffer content.
+ *
+ * \param[in]  bitmap  Bitmap to apply
+ * \param[in]  x       x-value of the top-left pixel
+ * \param[in]  y       y-value of the top-left pixel
+ */
+static void sprite_xor(const sprite_bitmap_t *bitmap, const uint8_t x, const uint8_t y)
+{
+    if((x >= SSD1306_WIDTH) || (y >= SSD1306_HEIGHT))
+    {
+        return;
+    }
+
+    // Clip the sprite at the right side of the display
+    uint8_t width = bitmap->width;
+    if(width > (SSD1306_WIDTH - x))
+    {
+        width = SSD1306_WIDTH - x;
+    }
+
+    uint8_t page = y >> 3;
+    uint8_t shift = y & 7;
+    uint8_t n_pages = (bitmap->height + 7) >> 3;
+
+    for(uint8_t p=0; p<n_pages; p++)
+    {
+        const uint8_t *src = &bitmap->data[p * bitmap->width];
+
+        // A sprite page that is not page-aligned covers two framebuffer
+        // pages: the lower bits go to the first and the upper bits to the
+        // second page
+        if((page + p) < SSD1306_PAGES)
+        {
+            uint8_t *dst = &ssd1306_framebuffer[(page + p) * SSD1306_WIDTH + x];
+
+            for(uint8_t c=0; c<width; c++)
+            {
+                dst[c] ^= (uint8_t)(src[c] << shift);
+            }
+        }
+
+        if((shift != 0) && ((page + p + 1) < SSD1306_PAGES))
+        {
+            uint8_t *dst = &ssd1306_framebuffer[(page + p + 1) * SSD1306_WIDTH + x];
+
+            for(uint8_t c=0; c<width; c++)
+            {
+                dst[c] ^= (uint8_t)(src[c] >> (8 - shift));
+            }
+        }
+    }
+
+    // Mark the pages covered by the bounding box dirty
+    uint8_t last = (y + bitmap->height - 1) >> 3;
+    if(last >= SSD1306_PAGES)
+    {
+        last = SSD1306_PAGES - 1;
+    }
+
+    ssd1306_markdirty(page, last);
+}
+
+/*!
+ * \brief Shows a sprite
+ *
+ * The sprite is XORed into the framebuffer at its current location, so any
+ * content below the sprite is restored when the sprite is hidden or moved.
+ * Call the function ssd1306_update() to actually show the result.
+ *
+ * \param[in]  sprite  Sprite to show
+ */
+void ssd1306_sprite_show(sprite_t *sprite)
+{
+    if(!sprite->visible)
+    {
+        sprite_xor(sprite->bitmap, sprite->x, sprite->y);
+        sprite->visible = true;
+    }
+}
+
+/*!
+ * \brief Hides a sprite
+ *
+ * Restores the framebuffer content below the sprite.
+ * Call the function ssd1306_update() to actually show the result.
+ *
+ * \param[in]  sprite  Sprite to hide
+ */
+void ssd1306_sprite_hide(sprite_t *sprite)
+{
+    if(sprite->visible)
+    {
+        sprite_xor(sprite->bitmap, sprite->x, sprite->y);
+        sprite->visible = false;
+    }
+}
+
+/*!
+ * \brief Moves a sprite to (x,y)
+ *
+ * If the sprite is visible, it is removed from its old location and drawn at
+ * the new location. Only the pages covered by both locations are marked dirty.
+ * Call the function ssd1306_update() to actually show the result.
+ *
+ * \param[in]  sprite  Sprite to move
+ * \param[in]  x       x-value of the new top-left pixel
+ * \param[in]  y       y-value of the new top-left pixel
+ */
+void ssd1306_sprite_move(sprite_t *sprite, const uint8_t x, const uint8_t y)
+{
+    if((x == sprite->x) && (y == sprite->y))
+    {
+        return;
+    }
+
+    if(sprite->visible)
+    {
+        sprite_xor(sprite->bitmap, sprite->x, sprite->y);
+        sprite_xor(sprite->bitmap, x, y);
+    }
+
+    sprite->x = x;
+    sprite->y = y;
+}
+
+/*!
+ * \brief Invalidates a sprite
+ *
+ * Call this function after the area below a visible sprite has been
+ * overwritten, for example by ssd1306_clearscreen() or ssd1306_drawbitmap().
+ * The sprite is marked as hidden without touching the framebuffer, so it can
+ * be shown again with ssd1306_sprite_show().
+ *
+ * \param[in]  sprite  Sprite to invalidate
+ */
+void ssd1306_sprite_invalidate(sprite_t *sprite)
+{
+    sprite->visible = false;
+}
@@ -1,22 +1,9 @@
 /*! ***************************************************************************
  *
- * \brief     I2C low level peripheral driver
- * \file      i2c1.h
- * \author    Hugo Arends
- * \date      April 2021
+ * \brief     Sprites for the SSD1306 driver
+ * \file      sprite.h
  *
- * \remark    Hardware connection
- * <pre>                                SSD1306 Oled display             </pre>
- * <pre>                           Vdd +-------------+                   </pre>
- * <pre>      FRDM-KL25Z            |  |             |                   </pre>
- * <pre>      -------------+        +--+Vcc          |                   </pre>
- * <pre>                   |   GND|----+GND          |                   </pre>
- * <pre>      I2C1_SCL/PTE1+-----------+SCL          |                   </pre>
- * <pre>      I2C1_SDA/PTE0+-----------+SDA          |                   </pre>
- * <pre>                   |           |             |                   </pre>
- * <pre>      -------------+           +-------------+                   </pre>
- *
- * \copyright 2021 HAN University of Applied Sciences. All Rights Reserved.
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
  *            \n\n
  *            Permission is hereby granted, free of charge, to any person
  *            obtaining a copy of this software and associated documentation
@@ -40,24 +27,44 @@
  *            OTHER DEALINGS IN THE SOFTWARE.
  *
  *****************************************************************************/
-#ifndef I2C1_H
-#define I2C1_H
+#ifndef SPRITE_H
+#define SPRITE_H
 
 #include <stdint.h>
 #include <stdbool.h>
 
 /*!
- * \brief Definition for the I2C timeout
+ * \brief Sprite bitmap
  *
- * This timeout value is used in loops to wait for a bit to set/reset. If the
- * bit doesn't get set, the function returns.
+ * The bitmap data uses the same layout as the framebuffer: \p height is
+ * rounded up to whole pages of 8 pixels, and each page holds \p width column
+ * bytes. The LSB of a column byte is the top pixel. Unused bits in the last
+ * page must be 0.
  */
-#define I2C_TIMEOUT (10000)
+typedef struct
+{
+    uint8_t width;        ///< Width in pixels
+    uint8_t height;       ///< Height in pixels
+    const uint8_t *data;  ///< Column bytes, page by page
+}
+sprite_bitmap_t;
 
-// Function prototypes
-void i2c1_init(void);
+/// A sprite instance on the display
+typedef struct
+{
+    const sprite_bitmap_t *bitmap; ///< Bitmap of the sprite
+    uint8_t x;                     ///< x-value of the top-left pixel
+    uint8_t y;                     ///< y-value of the top-left pixel
+    bool visible;                  ///< True if the sprite is in the framebuffer
+}
+sprite_t;
 
-bool i2c1_write_cmd(const uint8_t address, const uint8_t cmd[], const uint32_t n);
-bool i2c1_write_data(const uint8_t address, const uint8_t data[], const uint32_t n);
+extern const sprite_bitmap_t sprite_circle;
+
+// Function prototypes
+void ssd1306_sprite_show(sprite_t *sprite);
+void ssd1306_sprite_hide(sprite_t *sprite);
+void ssd1306_sprite_move(sprite_t *sprite, const uint8_t x, const uint8_t y);
+void ssd1306_sprite_invalidate(sprite_t *sprite);
 
-#endif // I2C1_H
+#endif // SPRITE_H
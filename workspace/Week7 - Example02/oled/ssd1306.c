@@ -29,33 +29,138 @@
  *            OTHER DEALINGS IN THE SOFTWARE.
  *
  *****************************************************************************/
+#include <MKL25Z4.h>
 #include "ssd1306.h"
 
+#include "semphr.h"
+#include "timers.h"
+
+#include <stdint.h>
 #include <string.h>
 
-static void delay_us(uint32_t d)
-{
+// Local function prototypes
+static bool ssd1306_write_cmd(const uint8_t cmd[], const uint32_t n);
+static bool ssd1306_write_data(const uint8_t data[], const uint32_t n);
+static bool ssd1306_write_cmd_data(const uint8_t cmd[], const uint32_t n_cmd,
+                                   const uint8_t data[], const uint32_t n_data);
+static void ssd1306_fade_callback(TimerHandle_t xTimer);
 
-#if (CLOCK_SETUP != 1)
-#warning This delay function does not work as designed
+/*!
+ * \brief Framebuffers
+ *
+ * A framebuffer holds all the data of a panel. The framebuffer is only written
+ * to the Oled display when the function ssd1306_update() is called.
+ */
+uint8_t ssd1306_framebuffers[SSD1306_PANELS][SSD1306_SIZE];
+
+/*!
+ * \brief Dirty pages
+ *
+ * Bit n is set if page n of the framebuffer has changed since the last call to
+ * ssd1306_update(). Only the pages from the first up to and including the last
+ * dirty page are transferred to the Oled display.
+ */
+volatile uint8_t ssd1306_dirtypages[SSD1306_PANELS];
+
+/*!
+ * \brief Slave addresses of the panels
+ */
+static const uint8_t ssd1306_addresses[SSD1306_PANELS] = SSD1306_ADDRESSES;
+
+#if (SSD1306_PANELS > 1)
+/*!
+ * \brief Selected panel
+ */
+uint8_t ssd1306_panel = 0;
 #endif
 
-    volatile uint32_t t;
+/// Slave address of the selected panel
+#define SSD1306_ADDRESS (ssd1306_addresses[ssd1306_panel])
 
-    for(t=4*d; t>0; t--)
-    {
-        __asm("nop");
-        __asm("nop");
-    }
-}
+/*!
+ * \brief Control bytes
+ *
+ * Datasheet 8.1.5.2: A control byte mainly consists of Co and D/C# bits
+ *                    following by six '0's
+ * Bit 7 Co:   If the Co bit is set as logic '0', the transmission of the
+ *             following information will contain data bytes only.
+ * Bit 6 D/C#: The D/C# bit determines the next data byte is acted as a
+ *             command or a data. If the D/C# bit is set to logic '0', it
+ *             defines the following data byte as a command. If the D/C# bit
+ *             is set to logic '1', it defines the following data byte as a
+ *             data which will be stored at the GDDRAM.
+ *             The GDDRAM column address pointer will be increased by one
+ *             automatically after each data write.
+ */
+#define SSD1306_CONTROL_CMD        (0x00)
+#define SSD1306_CONTROL_CMD_SINGLE (0x80)
+#define SSD1306_CONTROL_DATA       (0x40)
+
+/*!
+ * \brief Definition for the maximum number of commands that can precede the
+ * data in a single transfer
+ */
+#define SSD1306_MAX_CMD_DATA (8)
+
+/*!
+ * \brief Hardware scroll state of the panels
+ *
+ * The display RAM must not be written while a hardware scroll is active, so
+ * ssd1306_update() holds back all dirty pages until the scroll is stopped.
+ */
+static bool ssd1306_scrolling[SSD1306_PANELS];
+
+/*!
+ * \brief Panels that must be reinitialised
+ *
+ * A panel is marked when a transfer to it fails, for example because the
+ * display was disconnected or lost its power. The next ssd1306_update()
+ * sends the initialisation commands again, instead of the function that
+ * detected the error.
+ */
+static bool ssd1306_failed[SSD1306_PANELS];
+
+/*!
+ * \brief Contrast of the panels set with ssd1306_setcontrast()
+ *
+ * FADE_IN ramps the contrast up to this value.
+ */
+static uint8_t ssd1306_contrast[SSD1306_PANELS];
 
 /*!
- * \brief Framebuffer
+ * \brief Definition for the approximate frame period in microseconds
  *
- * The framebuffer holds all the data. The framebuffer is only written to the
- * Oled display when the function ssd1306_update() is called.
+ * With the oscillator frequency and divide ratio of the initialisation
+ * commands, the display refreshes at roughly 150 Hz.
+ */
+#define SSD1306_FRAME_US (6500)
+
+/*!
+ * \brief Definition for the number of contrast steps of a FADE_IN
  */
-uint8_t ssd1306_framebuffer[SSD1306_SIZE];
+#define SSD1306_FADE_STEPS (16)
+
+/*!
+ * \brief Timers that send the contrast steps of a FADE_IN, one per panel
+ */
+static TimerHandle_t ssd1306_fade_timer[SSD1306_PANELS];
+
+/*!
+ * \brief Contrast steps of a FADE_IN that have been sent
+ *
+ * SSD1306_FADE_STEPS if no fade in is running. Setting it to
+ * SSD1306_FADE_STEPS cancels a running fade in.
+ */
+static uint32_t ssd1306_fade_step[SSD1306_PANELS];
+
+/*!
+ * \brief Serialises the contrast writes of the fade timers and the tasks
+ *
+ * A task that sets the contrast or the fade mode takes the mutex, cancels a
+ * running fade in and writes the display. So a contrast step can not be sent
+ * after it.
+ */
+static SemaphoreHandle_t ssd1306_fade_mutex = NULL;
 
 /*!
  * \brief Pointer to the selected font
@@ -88,14 +193,20 @@ const uint8_t ssd1306_init_commands[] =
 {
     0xAE,             // Display OFF
     0x20, 0x00,       // Horizontal addressing mode
-    0x21, 0x00, 0x7F, // Column Address start and end (DEFAULT)
-    0x22, 0x00, 0x07, // Page address start and end (DEFAULT)
-    0xA8, 0x3F,       // Multiplex Ratio 63 (DEFAULT)
+    0x21, SSD1306_COLUMN_OFFSET,  // Column Address start and end
+          SSD1306_COLUMN_OFFSET + SSD1306_WIDTH - 1,
+    0x22, 0x00, SSD1306_PAGES-1,  // Page address start and end
+    0xA8, SSD1306_HEIGHT-1,       // Multiplex Ratio
     0xD3, 0x00,       // Display offset 0 (DEFAULT)
     0x40,             // Display start line 0 (DEFAULT)
+#if (SSD1306_ORIENTATION)
+    0xA1,             // Segment Re-map, column 127 is mapped to SEG0
+    0xC8,             // COM output scan direction remapped
+#else
     0xA0,             // Segment Re-map (DEFAULT)
     0xC0,             // COM output scan direction normal (DEFAULT)
-    0xDA, 0x12,       // COM pins alternative configuration
+#endif
+    0xDA, SSD1306_COMPINS, // COM pins hardware configuration
     0x81, 0xFF,       // Contrast control 256
     0xA4,             // Entire display on
     0xA6,             // Set normal display
@@ -106,25 +217,92 @@ const uint8_t ssd1306_init_commands[] =
 };
 
 /*!
- * \brief Sends a sequence of initialisation commands to the Oled display
+ * \brief Sends a sequence of initialisation commands to the Oled displays
+ *
+ * All panels in SSD1306_ADDRESSES are initialised and their framebuffers are
+ * cleared.
  *
  * Refer to the SSD1306 datasheet for a description of all possible commands
  */
 void ssd1306_init(void)
 {
-    // Clear the framebuffer
-    for(uint32_t i=0; i<SSD1306_SIZE; ++i)
+    // Clear the framebuffers
+    memset(ssd1306_framebuffers, 0x00, sizeof(ssd1306_framebuffers));
+
+    // A reset of the display stops any hardware scroll
+    memset(ssd1306_scrolling, 0x00, sizeof(ssd1306_scrolling));
+    memset(ssd1306_failed, 0x00, sizeof(ssd1306_failed));
+
+    // Contrast of the initialisation commands
+    memset(ssd1306_contrast, 0xFF, sizeof(ssd1306_contrast));
+
+    // The timers and the mutex are only created by the first call
+    if(ssd1306_fade_mutex == NULL)
+    {
+        ssd1306_fade_mutex = xSemaphoreCreateMutex();
+
+        for(uint32_t i=0; i<SSD1306_PANELS; ++i)
+        {
+            ssd1306_fade_timer[i] = xTimerCreate("Fade", 1, pdTRUE,
+                                                 (void *)(uintptr_t)i,
+                                                 ssd1306_fade_callback);
+        }
+    }
+
+    xSemaphoreTake(ssd1306_fade_mutex, portMAX_DELAY);
+
+    for(uint32_t i=0; i<SSD1306_PANELS; ++i)
+    {
+        ssd1306_fade_step[i] = SSD1306_FADE_STEPS;
+    }
+
+    xSemaphoreGive(ssd1306_fade_mutex);
+
+    // The contents of the display RAM is unknown, so all pages must be sent
+    for(uint32_t i=0; i<SSD1306_PANELS; ++i)
+    {
+        ssd1306_dirtypages[i] = (uint8_t)(0xFFU >> (8 - SSD1306_PAGES));
+    }
+
+    // Initialize the KL25Z I2C peripheral and the bit rate of the panels
+    i2c_init(I2C_BUS1);
+
+    for(uint32_t i=0; i<SSD1306_PANELS; ++i)
     {
-        ssd1306_framebuffer[i] = 0;
+        i2c_setspeed(I2C_BUS1, ssd1306_addresses[i], SSD1306_BITRATE);
     }
 
-    // Initialize the KL25Z I2C peripheral
-    i2c1_init();
+    // Initialize the SSD1306s. A panel that does not respond is initialised
+    // again by the next update.
+    for(uint32_t i=0; i<SSD1306_PANELS; ++i)
+    {
+        if(i2c_write(I2C_BUS1, ssd1306_addresses[i], SSD1306_CONTROL_CMD,
+                     ssd1306_init_commands,
+                     sizeof(ssd1306_init_commands)) != I2C_OK)
+        {
+            ssd1306_failed[i] = true;
+        }
+    }
+}
 
-    // Initialize the SSD1306
-    i2c1_write_cmd(SSD1306_SLAVE_ADDRESS,
-                  ssd1306_init_commands,
-                  sizeof(ssd1306_init_commands));
+/*!
+ * \brief Selects the panel
+ *
+ * All other functions operate on the selected panel. The index refers to the
+ * position of the panel's address in SSD1306_ADDRESSES.
+ *
+ * \param[in]  panel  Index of the panel
+ */
+void ssd1306_selectpanel(const uint8_t panel)
+{
+#if (SSD1306_PANELS > 1)
+    if(panel < SSD1306_PANELS)
+    {
+        ssd1306_panel = panel;
+    }
+#else
+    (void)panel;
+#endif
 }
 
 /*!
@@ -136,10 +314,9 @@ void ssd1306_init(void)
  */
 void ssd1306_command(const uint8_t cmd)
 {
-    if(!i2c1_write_cmd(SSD1306_SLAVE_ADDRESS, &cmd, 1))
+    if(!ssd1306_write_cmd(&cmd, 1))
     {
-        // Try to reinitialise the display if writing the command failed
-        ssd1306_init();
+        // The display is reinitialised by the next update
         return;
     }
 }
@@ -151,61 +328,127 @@ void ssd1306_command(const uint8_t cmd)
  */
 void ssd1306_data(const uint8_t data)
 {
-    if(!i2c1_write_data(SSD1306_SLAVE_ADDRESS, &data, 1))
+    if(!ssd1306_write_data(&data, 1))
     {
-        // Try to reinitialise the display if writing the data failed
-        ssd1306_init();
+        // The display is reinitialised by the next update
         return;
     }
 }
 
+/*!
+ * \brief Marks a range of pages as dirty
+ *
+ * Marks the pages \p first_page up to and including \p last_page as changed,
+ * so they are transferred to the Oled display by the next call to
+ * ssd1306_update(). Functions that write to the framebuffer mark the pages
+ * themselves. Call this function only if the framebuffer is written directly.
+ *
+ * \param[in]  first_page  First page that changed
+ * \param[in]  last_page   Last page that changed
+ */
+void ssd1306_markdirty(const uint8_t first_page, const uint8_t last_page)
+{
+    uint8_t mask = (uint8_t)((0xFFU << first_page) & (0xFFU >> (7 - last_page)));
+
+    ssd1306_dirty |= mask;
+}
+
 /*!
  * \brief Sends the framebuffer to the Oled display
  *
- * The column and page addresses are set to the inital position.
- * Then the framebuffer is transferred.
+ * The column and page addresses are set to the span of dirty pages.
+ * Then that part of the framebuffer is transferred. If no page has changed
+ * since the previous update, nothing is transferred.
  *
  * The total number of bytes to transfer is equal to:
- * - address byte + 6 command bytes
- * - address byte + (SSD1306_WIDTH * SSD1306_HEIGHT) / 8 data bytes
+ * - address byte
+ * - 6 command bytes, each preceded by a control byte
+ * - control byte + SSD1306_WIDTH data bytes for each page in the span
+ *
+ * All bytes are sent in a single transfer, so there is no bus idle time
+ * between the commands and the data.
  *
  * The transmission of a single byte takes 1/375000 * 9 = 24 us
  *
  * Example for 128 x 64 display:
  * \n
- * 24 us * 1032 bytes = 24.768 ms is the total theoretical minimum time it takes
- * to send the framebuffer to the Oled display. Measurements show that it
- * actually takes approximately 28 ms.
+ * 24 us * 1038 bytes = 24.912 ms is the total theoretical minimum time it takes
+ * to send the complete framebuffer to the Oled display. If only a single page
+ * is dirty, this time reduces to 24 us * 142 bytes = 3.408 ms.
  *
- * Notice that this is a non-blocking transfer.
+ * Notice that the calling task is blocked during the transfer, but the CPU
+ * is free for other tasks.
+ *
+ * If a previous transfer to the display failed, the display is initialised
+ * again and the complete framebuffer is sent.
  */
 void ssd1306_update(void)
 {
-    uint8_t data[] =
+    if(ssd1306_failed[ssd1306_panel])
     {
-        0x21, 0x00, 0x7F, // Column Address start and end (DEFAULT)
-        0x22, 0x00, 0x07, // Page address start and end (DEFAULT)
-    };
+        if(i2c_write(I2C_BUS1, SSD1306_ADDRESS, SSD1306_CONTROL_CMD,
+                     ssd1306_init_commands,
+                     sizeof(ssd1306_init_commands)) != I2C_OK)
+        {
+            // Still not responding, try again with the next update
+            return;
+        }
+
+        // The initialisation stops any hardware scroll and the contents of
+        // the display RAM is unknown
+        ssd1306_failed[ssd1306_panel] = false;
+        ssd1306_scrolling[ssd1306_panel] = false;
+        ssd1306_markdirty(0, SSD1306_PAGES-1);
+    }
+
+    // Take and clear the dirty pages. Pages that are marked dirty while the
+    // transfer is in progress will be sent by the next update.
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint8_t dirty = ssd1306_dirty;
+    ssd1306_dirty = 0;
+    __set_PRIMASK(primask);
 
+    if(dirty == 0)
+    {
+        return;
+    }
 
-    if(!i2c1_write_cmd(SSD1306_SLAVE_ADDRESS, data, sizeof(data)))
+    // Keep the pages dirty until the hardware scroll is stopped
+    if(ssd1306_scrolling[ssd1306_panel])
     {
-        // Try to reinitialise the display if writing the command failed
-        ssd1306_init();
+        ssd1306_dirty |= dirty;
         return;
     }
 
-    // The display requires an idle time of 1.3 us (see table 13-6 in the
-    // datasheet) between I2C transfers.
-    delay_us(2);
+    // Find the span of dirty pages
+    uint8_t first = 0;
+    while((dirty & (1 << first)) == 0)
+    {
+        first++;
+    }
+
+    uint8_t last = SSD1306_PAGES-1;
+    while((dirty & (1 << last)) == 0)
+    {
+        last--;
+    }
+
+    uint8_t cmd[] =
+    {
+        0x21, SSD1306_COLUMN_OFFSET, // Column Address start and end
+              SSD1306_COLUMN_OFFSET + SSD1306_WIDTH - 1,
+        0x22, first, last,           // Page address start and end
+    };
 
-    // Write the framebuffer to the device
-    if(!i2c1_write_data(SSD1306_SLAVE_ADDRESS,
-                   ssd1306_framebuffer,
-                   sizeof(ssd1306_framebuffer)))
+    // Set the address window and write the dirty part of the framebuffer in
+    // a single transfer
+    if(!ssd1306_write_cmd_data(cmd, sizeof(cmd),
+                               &ssd1306_framebuffer[first * SSD1306_WIDTH],
+                               (last - first + 1) * SSD1306_WIDTH))
     {
-        // Try to reinitialise the display if writing the data failed
-        ssd1306_init();
+        // Send the pages again after the display has been reinitialised
+        ssd1306_dirty |= dirty;
         return;
     }
 }
@@ -238,9 +481,6 @@ void ssd1306_setfont(const char *f)
  */
 void ssd1306_setorientation(const uint8_t orientation)
 {
-    // The display requires an idle time before updating the orientiation
-    delay_us(2);
-
     uint8_t data[2];
 
     if(orientation)
@@ -254,10 +494,9 @@ void ssd1306_setorientation(const uint8_t orientation)
         data[1] = 0xC0;
     }
 
-    if(!i2c1_write_cmd(SSD1306_SLAVE_ADDRESS, data, sizeof(data)))
+    if(!ssd1306_write_cmd(data, sizeof(data)))
     {
-        // Try to reinitialise the display if writing the command failed
-        ssd1306_init();
+        // The display is reinitialised by the next update
         return;
     }
 }
@@ -289,6 +528,7 @@ void ssd1306_setinverse(const uint8_t inv)
 void ssd1306_clearscreen(void)
 {
     memset(ssd1306_framebuffer, 0x00, sizeof(ssd1306_framebuffer));
+    ssd1306_markdirty(0, SSD1306_PAGES-1);
 }
 
 /*!
@@ -307,12 +547,226 @@ void ssd1306_setcontrast(const uint8_t contrast)
 
     data[1] = contrast;
 
-    if(!i2c1_write_cmd(SSD1306_SLAVE_ADDRESS, data, sizeof(data)))
+    ssd1306_contrast[ssd1306_panel] = contrast;
+
+    // Cancel a running fade in
+    xSemaphoreTake(ssd1306_fade_mutex, portMAX_DELAY);
+    ssd1306_fade_step[ssd1306_panel] = SSD1306_FADE_STEPS;
+
+    // On failure the display is reinitialised by the next update
+    (void)ssd1306_write_cmd(data, sizeof(data));
+
+    xSemaphoreGive(ssd1306_fade_mutex);
+}
+
+/*!
+ * \brief Starts a continuous hardware scroll
+ *
+ * The display scrolls the pages \p first_page up to and including
+ * \p last_page without any further I2C traffic. For the diagonal directions,
+ * the whole display also scrolls up by \p voffset rows every step.
+ *
+ * While the scroll is active, ssd1306_update() does not transfer the
+ * framebuffer, because writing the display RAM during a scroll corrupts it.
+ * Changes to the framebuffer are sent after ssd1306_scroll_stop().
+ *
+ * \param[in]  dir         Scroll direction
+ * \param[in]  first_page  First page that scrolls horizontally
+ * \param[in]  last_page   Last page that scrolls horizontally
+ * \param[in]  speed       Time between two scroll steps
+ * \param[in]  voffset     Vertical offset per step, ignored for horizontal
+ *                         scrolls
+ */
+void ssd1306_scroll(const scroll_dir_t dir, const uint8_t first_page, const uint8_t last_page,
+                    const scroll_speed_t speed, const uint8_t voffset)
+{
+    if((first_page > last_page) || (last_page >= SSD1306_PAGES))
+    {
+        return;
+    }
+
+    // Send everything that is pending, because the display RAM cannot be
+    // written once the scroll is active
+    ssd1306_update();
+
+    uint8_t data[13];
+    uint32_t n = 0;
+
+    // A scroll must be deactivated before the parameters are changed
+    data[n++] = 0x2E;
+
+    if((dir == SCROLL_RIGHT) || (dir == SCROLL_LEFT))
+    {
+        data[n++] = (dir == SCROLL_RIGHT) ? 0x26 : 0x27;
+        data[n++] = 0x00;       // Dummy byte
+        data[n++] = first_page; // Start page address
+        data[n++] = speed;      // Time interval between each scroll step
+        data[n++] = last_page;  // End page address
+        data[n++] = 0x00;       // Dummy byte
+        data[n++] = 0xFF;       // Dummy byte
+    }
+    else
+    {
+        data[n++] = 0xA3;           // Vertical scroll area
+        data[n++] = 0x00;           // No fixed rows
+        data[n++] = SSD1306_HEIGHT; // All rows scroll
+
+        data[n++] = (dir == SCROLL_UP_RIGHT) ? 0x29 : 0x2A;
+        data[n++] = 0x00;                       // Dummy byte
+        data[n++] = first_page;                 // Start page address
+        data[n++] = speed;                      // Time interval between each scroll step
+        data[n++] = last_page;                  // End page address
+        data[n++] = voffset % SSD1306_HEIGHT;   // Vertical scrolling offset
+    }
+
+    // Activate scroll
+    data[n++] = 0x2F;
+
+    if(!ssd1306_write_cmd(data, n))
+    {
+        // The display is reinitialised by the next update
+        return;
+    }
+
+    ssd1306_scrolling[ssd1306_panel] = true;
+}
+
+/*!
+ * \brief Stops a hardware scroll
+ *
+ * After deactivating the scroll, the display RAM no longer matches the
+ * framebuffer. The display start line is reset and the complete framebuffer is
+ * transferred immediately, so the display continues exactly where the
+ * software left off.
+ */
+void ssd1306_scroll_stop(void)
+{
+    uint8_t data[] =
+    {
+        0x2E, // Deactivate scroll
+        0x40, // Display start line 0
+    };
+
+    if(!ssd1306_write_cmd(data, sizeof(data)))
+    {
+        // The display is reinitialised by the next update
+        return;
+    }
+
+    ssd1306_scrolling[ssd1306_panel] = false;
+
+    ssd1306_markdirty(0, SSD1306_PAGES-1);
+    ssd1306_update();
+}
+
+/*!
+ * \brief Shows a scrolling text
+ *
+ * Writes a string into the pages that are covered by the current font,
+ * starting at row \p ys, and lets the display scroll these pages. Other pages
+ * are not affected. The pages are cleared before the string is written.
+ * Stop the marquee with ssd1306_scroll_stop().
+ *
+ * \param[in]  ys     y-value of the string
+ * \param[in]  str    '\0' terminated string
+ * \param[in]  dir    SCROLL_RIGHT or SCROLL_LEFT
+ * \param[in]  speed  Time between two scroll steps
+ */
+void ssd1306_marquee(const uint8_t ys, const char *str, const scroll_dir_t dir, const scroll_speed_t speed)
+{
+    if(ys >= SSD1306_HEIGHT)
+    {
+        return;
+    }
+
+    uint8_t first_page = ys >> 3;
+    uint8_t last_page = (ys + font[1] - 1) >> 3;
+
+    if(last_page >= SSD1306_PAGES)
+    {
+        last_page = SSD1306_PAGES-1;
+    }
+
+    // Clear the pages and write the string
+    memset(&ssd1306_framebuffer[first_page * SSD1306_WIDTH], 0x00,
+           (last_page - first_page + 1) * SSD1306_WIDTH);
+    ssd1306_markdirty(first_page, last_page);
+
+    ssd1306_putstring(0, ys, str);
+
+    ssd1306_scroll((dir == SCROLL_LEFT) ? SCROLL_LEFT : SCROLL_RIGHT,
+                   first_page, last_page, speed, 0);
+}
+
+/*!
+ * \brief Sets the display's hardware fade mode
+ *
+ * In FADE_OUT mode the contrast decreases step by step until the display is
+ * off. In FADE_BLINK mode the display fades out and in continuously. The
+ * steps are performed by the display itself, so no further I2C traffic is
+ * required. FADE_NONE immediately restores the contrast set with
+ * ssd1306_setcontrast().
+ *
+ * The SSD1306 has no hardware fade in. In FADE_IN mode the hardware fade is
+ * disabled at the lowest contrast, after which a FreeRTOS timer raises the
+ * contrast to the contrast set with ssd1306_setcontrast() in
+ * SSD1306_FADE_STEPS steps. The function returns at once. The steps are
+ * sent by the timer task, approximately 8 * (interval + 1) frames apart, so
+ * the fade in takes 0.8 s for interval 0. Another fade mode or contrast
+ * cancels it.
+ *
+ * \param[in]  mode      Fade mode
+ * \param[in]  interval  Time between two contrast steps is 8 * (interval + 1)
+ *                       frames, range [0..15]
+ */
+void ssd1306_fade(const fade_mode_t mode, const uint8_t interval)
+{
+    // In FADE_IN mode the hardware fade is disabled at the lowest contrast,
+    // so the display doesn't flash at the full contrast first
+    const uint8_t fade_in[] =
+    {
+        0x81, 0x00, // Contrast control 0
+        0x23, 0x00, // Fade disabled
+    };
+
+    const uint8_t fade[] =
+    {
+        0x23, (uint8_t)(mode | (interval & 0x0F)),
+    };
+
+    const uint8_t panel = ssd1306_panel;
+
+    xSemaphoreTake(ssd1306_fade_mutex, portMAX_DELAY);
+
+    // A running fade in is cancelled. The display is reinitialised by the
+    // next update if the write fails.
+    ssd1306_fade_step[panel] = SSD1306_FADE_STEPS;
+
+    const bool ok = (mode == FADE_IN) ?
+                    ssd1306_write_cmd(fade_in, sizeof(fade_in)) :
+                    ssd1306_write_cmd(fade, sizeof(fade));
+
+    if(ok && (mode == FADE_IN))
+    {
+        ssd1306_fade_step[panel] = 0;
+    }
+
+    xSemaphoreGive(ssd1306_fade_mutex);
+
+    if(!ok || (mode != FADE_IN))
     {
-        // Try to reinitialise the display if writing the command failed
-        i2c1_init();
         return;
     }
+
+    const TickType_t step = pdMS_TO_TICKS((8 * ((interval & 0x0F) + 1) *
+                                           SSD1306_FRAME_US) / 1000);
+
+    // Changing the period also (re)starts the timer. If the command queue of
+    // the timer task is full, the contrast is restored without a fade.
+    if(xTimerChangePeriod(ssd1306_fade_timer[panel], step, 0) != pdPASS)
+    {
+        ssd1306_setcontrast(ssd1306_contrast[panel]);
+    }
 }
 
 /*!
@@ -348,12 +802,14 @@ void ssd1306_setpixel(const uint8_t x, const uint8_t y, const pixel_value_t val)
 {
 	if(val == ON)
     {
-		ssd1306_framebuffer[x + (y / 8) * SSD1306_WIDTH] |= 1 << (y % 8);
+		ssd1306_framebuffer[x + (y >> 3) * SSD1306_WIDTH] |= 1 << (y & 7);
 	}
     else
     {
-		ssd1306_framebuffer[x + (y / 8) * SSD1306_WIDTH] &= ~(1 << (y % 8));
+		ssd1306_framebuffer[x + (y >> 3) * SSD1306_WIDTH] &= ~(1 << (y & 7));
 	}
+
+    ssd1306_dirty |= 1 << (y >> 3);
 }
 
 /*!
@@ -524,21 +980,28 @@ void ssd1306_terminal(const char *str)
     {
         if(str[i] == '\n')
         {
-            // Move the previous characters up
-            for(uint32_t yn = offset; yn < SSD1306_HEIGHT; yn++)
+            // Move the previous characters up. Each column is handled as a
+            // single SSD1306_HEIGHT bits value, so a column is moved with a
+            // single shift instead of pixel by pixel.
+            for(uint32_t xn = 0; xn < SSD1306_WIDTH; xn++)
             {
-                for(uint32_t xn = 0; xn < SSD1306_WIDTH; xn++)
+                uint64_t column = 0;
+
+                for(uint32_t p = 0; p < SSD1306_PAGES; p++)
                 {
-                    pixel_value_t val = OFF;
-                    if(ssd1306_framebuffer[xn + (yn / 8) * SSD1306_WIDTH] & (1 << (yn % 8)))
-                    {
-                        val = ON;
-                    }
+                    column |= (uint64_t)ssd1306_framebuffer[xn + p * SSD1306_WIDTH] << (p * 8);
+                }
+
+                column >>= offset;
 
-                    ssd1306_setpixel(xn, yn-offset, val);
+                for(uint32_t p = 0; p < SSD1306_PAGES; p++)
+                {
+                    ssd1306_framebuffer[xn + p * SSD1306_WIDTH] = (uint8_t)(column >> (p * 8));
                 }
             }
 
+            ssd1306_markdirty(0, SSD1306_PAGES-1);
+
             // Clear bottom
             for(uint32_t yn = SSD1306_HEIGHT-offset-1; yn < SSD1306_HEIGHT; yn++)
             {
@@ -647,10 +1110,149 @@ void ssd1306_drawline(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1)
  * Copies a bitmap to the framebuffer.
  * Call the function ssd1306_update() to actually show the result.
  * Bitmaps should be located in the files bitmaps.c and bitmaps.h.
+ * The bitmap must have the dimensions of the selected panel.
  *
  * \param[in]  bitmap  A pointer to a bitmap
  */
 void ssd1306_drawbitmap(const unsigned char *bitmap)
 {
     memcpy(ssd1306_framebuffer, bitmap, sizeof(ssd1306_framebuffer));
+    ssd1306_markdirty(0, SSD1306_PAGES-1);
+}
+
+/*!
+ * \brief Sends the next contrast step of a FADE_IN, called by the timer task
+ *
+ * The timer stops itself after the last step, after a failed write and when
+ * the fade in was cancelled.
+ *
+ * \param[in]  xTimer  Fade timer, its ID is the index of the panel
+ */
+static void ssd1306_fade_callback(TimerHandle_t xTimer)
+{
+    const uint32_t panel = (uint32_t)(uintptr_t)pvTimerGetTimerID(xTimer);
+
+    xSemaphoreTake(ssd1306_fade_mutex, portMAX_DELAY);
+
+    if(ssd1306_fade_step[panel] < SSD1306_FADE_STEPS)
+    {
+        ssd1306_fade_step[panel]++;
+
+        const uint8_t data[2] =
+        {
+            0x81,
+            (uint8_t)((ssd1306_contrast[panel] * ssd1306_fade_step[panel]) /
+                      SSD1306_FADE_STEPS),
+        };
+
+        // The panel is not necessarily the selected one
+        if(i2c_write(I2C_BUS1, ssd1306_addresses[panel], SSD1306_CONTROL_CMD,
+                     data, sizeof(data)) != I2C_OK)
+        {
+            // The display is reinitialised by the next update
+            ssd1306_failed[panel] = true;
+            ssd1306_fade_step[panel] = SSD1306_FADE_STEPS;
+        }
+    }
+
+    if(ssd1306_fade_step[panel] == SSD1306_FADE_STEPS)
+    {
+        xTimerStop(xTimer, 0);
+    }
+
+    xSemaphoreGive(ssd1306_fade_mutex);
+}
+
+/*!
+ * \brief Sends multiple commands to the selected Oled display
+ *
+ * All commands are transferred in a single I2C transfer.
+ *
+ * \param[in]  cmd  Pointer to the array of commands to be transmitted
+ * \param[in]  n    Number of commands
+ *
+ * \return True on successfull communication, false otherwise. On failure the
+ *         panel is marked for reinitialisation.
+ */
+static bool ssd1306_write_cmd(const uint8_t cmd[], const uint32_t n)
+{
+    if(i2c_write(I2C_BUS1, SSD1306_ADDRESS, SSD1306_CONTROL_CMD, cmd, n) != I2C_OK)
+    {
+        ssd1306_failed[ssd1306_panel] = true;
+        return false;
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Sends multiple data bytes to the selected Oled display
+ *
+ * All data bytes are transferred in a single I2C transfer.
+ *
+ * \param[in]  data  Pointer to the array of data bytes to be transmitted
+ * \param[in]  n     Number of data bytes
+ *
+ * \return True on successfull communication, false otherwise. On failure the
+ *         panel is marked for reinitialisation.
+ */
+static bool ssd1306_write_data(const uint8_t data[], const uint32_t n)
+{
+    if(i2c_write(I2C_BUS1, SSD1306_ADDRESS, SSD1306_CONTROL_DATA, data, n) != I2C_OK)
+    {
+        ssd1306_failed[ssd1306_panel] = true;
+        return false;
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Sends commands followed by data bytes to the selected Oled display
+ *
+ * Every command byte is preceded by a control byte with Co = 1, so the
+ * display expects another control byte after it. The last control byte has
+ * Co = 0 and D/C# = 1, so all remaining bytes are stored in the GDDRAM. The
+ * header with the control bytes and the data are sent as two segments of a
+ * single I2C transfer, so the data is not copied.
+ *
+ * \param[in]  cmd     Pointer to the array of commands
+ * \param[in]  n_cmd   Number of commands, at most SSD1306_MAX_CMD_DATA
+ * \param[in]  data    Pointer to the array of data bytes
+ * \param[in]  n_data  Number of data bytes
+ *
+ * \return True on successfull communication, false otherwise. On failure the
+ *         panel is marked for reinitialisation.
+ */
+static bool ssd1306_write_cmd_data(const uint8_t cmd[], const uint32_t n_cmd,
+                                   const uint8_t data[], const uint32_t n_data)
+{
+    uint8_t header[2 * SSD1306_MAX_CMD_DATA + 1];
+
+    if(n_cmd > SSD1306_MAX_CMD_DATA)
+    {
+        return false;
+    }
+
+    for(uint32_t i=0; i<n_cmd; ++i)
+    {
+        header[2*i]   = SSD1306_CONTROL_CMD_SINGLE;
+        header[2*i+1] = cmd[i];
+    }
+
+    header[2*n_cmd] = SSD1306_CONTROL_DATA;
+
+    const i2c_segment_t segments[] =
+    {
+        {header, 2*n_cmd + 1, I2C_WRITE},
+        {(uint8_t *)data, n_data, I2C_WRITE},
+    };
+
+    if(i2c_writev(I2C_BUS1, SSD1306_ADDRESS, segments, 2) != I2C_OK)
+    {
+        ssd1306_failed[ssd1306_panel] = true;
+        return false;
+    }
+
+    return true;
 }
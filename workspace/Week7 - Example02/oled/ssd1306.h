@@ -32,13 +32,44 @@
 #ifndef SSD1306_H
 #define SSD1306_H
 
-#include "i2c1.h"
+#include "i2c.h"
 #include "fonts.h"
 #include "bitmaps.h"
+#include "sprite.h"
 
 /// \name Definitions for SSD1306
 /// \{
 
+/*!
+ * \brief Definitions for the supported panels
+ *
+ * Select the panel at compile time by defining SSD1306_PANEL, for example with
+ * -DSSD1306_PANEL=SSD1306_PANEL_128X32. The framebuffer size, the
+ * initialisation commands and the address window follow from the selected
+ * geometry.
+ */
+#define SSD1306_PANEL_128X64  (0)
+#define SSD1306_PANEL_128X32  (1)
+#define SSD1306_PANEL_64X48   (2)
+
+#ifndef SSD1306_PANEL
+#define SSD1306_PANEL         SSD1306_PANEL_128X64
+#endif
+
+/*!
+ * \brief Definition for the display orientation
+ *
+ * If 0: default display orientation
+ *
+ * If 1: flipped both horizontally and vertically
+ *
+ * The orientation can still be changed at runtime with
+ * ssd1306_setorientation().
+ */
+#ifndef SSD1306_ORIENTATION
+#define SSD1306_ORIENTATION   (0)
+#endif
+
 /*!
  * \brief Definition for the logic value of the SA0 pin of the SSD1306 display
  */
@@ -46,18 +77,105 @@
 
 /*!
  * \brief Definition for the display dimensions
+ *
+ * SSD1306_COLUMN_OFFSET is the first SEG driver that is connected to the
+ * panel and SSD1306_COMPINS is the value for the COM pins hardware
+ * configuration command (0xDA).
  */
+#if (SSD1306_PANEL == SSD1306_PANEL_128X64)
 #define SSD1306_WIDTH         (128)
 #define SSD1306_HEIGHT        (64)
+#define SSD1306_COLUMN_OFFSET (0)
+#define SSD1306_COMPINS       (0x12)
+#elif (SSD1306_PANEL == SSD1306_PANEL_128X32)
+#define SSD1306_WIDTH         (128)
+#define SSD1306_HEIGHT        (32)
+#define SSD1306_COLUMN_OFFSET (0)
+#define SSD1306_COMPINS       (0x02)
+#elif (SSD1306_PANEL == SSD1306_PANEL_64X48)
+#define SSD1306_WIDTH         (64)
+#define SSD1306_HEIGHT        (48)
+#define SSD1306_COLUMN_OFFSET (32)
+#define SSD1306_COMPINS       (0x12)
+#else
+#error Unsupported SSD1306_PANEL
+#endif
+
+#define SSD1306_PAGES         (SSD1306_HEIGHT / 8)
 #define SSD1306_SIZE          (SSD1306_WIDTH * SSD1306_HEIGHT / 8)
 
 /*!
  * \brief Definition for the slave address
  */
-#define SSD1306_SLAVE_ADDRESS (0x78 | SSD1306_SA0)
+#define SSD1306_SLAVE_ADDRESS (0x78 | (SSD1306_SA0 << 1))
+
+/*!
+ * \brief Definitions for multiple panels on one bus
+ *
+ * SSD1306_PANELS is the number of panels of the selected geometry and
+ * SSD1306_ADDRESSES is the list of their slave addresses. Select the panel
+ * that all other functions operate on with ssd1306_selectpanel().
+ */
+#ifndef SSD1306_PANELS
+#define SSD1306_PANELS        (1)
+#endif
+
+#ifndef SSD1306_ADDRESSES
+#define SSD1306_ADDRESSES     {SSD1306_SLAVE_ADDRESS}
+#endif
+
+/*!
+ * \brief Definition for the I2C bit rate of the panels in bits per second
+ *
+ * The datasheet specifies a maximum of 400 kHz, which gives 375 kHz with a
+ * 24 MHz bus clock. Sending a 128 x 64 framebuffer then takes approximately
+ * 25 ms.
+ *
+ * Many panels also work at higher rates, for example 800 kHz cuts this time
+ * to approximately 14 ms. Such a rate is out of spec and has to be selected
+ * explicitly with -DSSD1306_BITRATE=800000. Go back to the default if a
+ * display shows corrupted pixels.
+ */
+#ifndef SSD1306_BITRATE
+#define SSD1306_BITRATE       (400000)
+#endif
 
 /// \}
 
+/// Direction of a hardware scroll
+typedef enum
+{
+    SCROLL_RIGHT,    ///< Horizontal scroll to the right
+    SCROLL_LEFT,     ///< Horizontal scroll to the left
+    SCROLL_UP_RIGHT, ///< Vertical and horizontal scroll to the right
+    SCROLL_UP_LEFT,  ///< Vertical and horizontal scroll to the left
+}
+scroll_dir_t;
+
+/// Time between two scroll steps in frames
+typedef enum
+{
+    SCROLL_2_FRAMES   = 0x07,
+    SCROLL_3_FRAMES   = 0x04,
+    SCROLL_4_FRAMES   = 0x05,
+    SCROLL_5_FRAMES   = 0x00,
+    SCROLL_25_FRAMES  = 0x06,
+    SCROLL_64_FRAMES  = 0x01,
+    SCROLL_128_FRAMES = 0x02,
+    SCROLL_256_FRAMES = 0x03,
+}
+scroll_speed_t;
+
+/// Hardware fade mode
+typedef enum
+{
+    FADE_NONE  = 0x00, ///< Fade disabled, contrast is restored
+    FADE_OUT   = 0x20, ///< Fade out to the lowest contrast and stay there
+    FADE_BLINK = 0x30, ///< Fade out and in continuously
+    FADE_IN    = 0x80, ///< Fade in from the lowest contrast, in software
+}
+fade_mode_t;
+
 /// Value for a pixel
 typedef enum
 {
@@ -66,13 +184,28 @@ typedef enum
 }
 pixel_value_t;
 
-extern uint8_t ssd1306_framebuffer[SSD1306_SIZE];
+extern uint8_t ssd1306_framebuffers[SSD1306_PANELS][SSD1306_SIZE];
+extern volatile uint8_t ssd1306_dirtypages[SSD1306_PANELS];
+
+#if (SSD1306_PANELS > 1)
+extern uint8_t ssd1306_panel;
+#else
+#define ssd1306_panel (0)
+#endif
+
+/// Framebuffer of the selected panel
+#define ssd1306_framebuffer (ssd1306_framebuffers[ssd1306_panel])
+
+/// Dirty pages of the selected panel
+#define ssd1306_dirty (ssd1306_dirtypages[ssd1306_panel])
 
 // Funtion prototypes
 void ssd1306_init(void);
+void ssd1306_selectpanel(const uint8_t panel);
 void ssd1306_command(const uint8_t cmd);
 void ssd1306_data(const uint8_t data);
 void ssd1306_update(void);
+void ssd1306_markdirty(const uint8_t first_page, const uint8_t last_page);
 
 void ssd1306_setfont(const char *f);
 void ssd1306_setorientation(const uint8_t orientation);
@@ -80,6 +213,12 @@ void ssd1306_setinverse(const uint8_t inv);
 
 void ssd1306_clearscreen(void);
 void ssd1306_setcontrast(const uint8_t contrast);
+
+void ssd1306_scroll(const scroll_dir_t dir, const uint8_t first_page, const uint8_t last_page,
+                    const scroll_speed_t speed, const uint8_t voffset);
+void ssd1306_scroll_stop(void);
+void ssd1306_marquee(const uint8_t ys, const char *str, const scroll_dir_t dir, const scroll_speed_t speed);
+void ssd1306_fade(const fade_mode_t mode, const uint8_t interval);
 void ssd1306_goto(const uint8_t new_x, const uint8_t new_y);
 void ssd1306_setpixel(const uint8_t x, const uint8_t y, const pixel_value_t val);
 
@@ -31,6 +31,68 @@
  *****************************************************************************/
 #include "rgb.h"
 
+#include <stddef.h>
+
+// The effects are updated on every overflow of TPM2, which is the PWM
+// frequency: 48 MHz / 65536 = 732.4 Hz. A step of period_ms takes
+// period_ms * 48000 TPM counts.
+#define RGB_COUNTS_PER_MS (48000U)
+
+// PWM value for a perceived brightness of 0 to 255, 65535 * (i / 255)^2.2.
+// The eye is more sensitive to changes at low brightness, so with this
+// table fades look linear.
+static const uint16_t gamma[256] =
+{
+    0x0000, 0x0000, 0x0002, 0x0004, 0x0007, 0x000B, 0x0011, 0x0018,
+    0x0020, 0x002A, 0x0035, 0x0041, 0x004F, 0x005E, 0x006F, 0x0081,
+    0x0094, 0x00A9, 0x00C0, 0x00D8, 0x00F2, 0x010E, 0x012B, 0x014A,
+    0x016A, 0x018C, 0x01B0, 0x01D5, 0x01FC, 0x0225, 0x024F, 0x027B,
+    0x02A9, 0x02D9, 0x030B, 0x033E, 0x0373, 0x03AA, 0x03E3, 0x041D,
+    0x0459, 0x0497, 0x04D7, 0x0519, 0x055D, 0x05A3, 0x05EA, 0x0633,
+    0x067F, 0x06CC, 0x071B, 0x076C, 0x07BF, 0x0814, 0x086B, 0x08C3,
+    0x091E, 0x097B, 0x09D9, 0x0A3A, 0x0A9D, 0x0B01, 0x0B68, 0x0BD0,
+    0x0C3B, 0x0CA8, 0x0D16, 0x0D87, 0x0DFA, 0x0E6E, 0x0EE5, 0x0F5E,
+    0x0FD9, 0x1056, 0x10D5, 0x1156, 0x11DA, 0x125F, 0x12E6, 0x1370,
+    0x13FB, 0x1489, 0x1519, 0x15AB, 0x163F, 0x16D5, 0x176E, 0x1808,
+    0x18A5, 0x1944, 0x19E5, 0x1A88, 0x1B2D, 0x1BD4, 0x1C7E, 0x1D2A,
+    0x1DD8, 0x1E88, 0x1F3A, 0x1FEF, 0x20A6, 0x215F, 0x221A, 0x22D7,
+    0x2397, 0x2459, 0x251D, 0x25E3, 0x26AC, 0x2776, 0x2843, 0x2913,
+    0x29E4, 0x2AB8, 0x2B8E, 0x2C66, 0x2D41, 0x2E1E, 0x2EFD, 0x2FDE,
+    0x30C2, 0x31A8, 0x3290, 0x337B, 0x3468, 0x3557, 0x3648, 0x373C,
+    0x3832, 0x392B, 0x3A25, 0x3B22, 0x3C22, 0x3D24, 0x3E28, 0x3F2E,
+    0x4037, 0x4142, 0x424F, 0x435F, 0x4471, 0x4586, 0x469D, 0x47B6,
+    0x48D2, 0x49F0, 0x4B10, 0x4C33, 0x4D58, 0x4E7F, 0x4FA9, 0x50D6,
+    0x5204, 0x5335, 0x5469, 0x559F, 0x56D7, 0x5812, 0x594F, 0x5A8E,
+    0x5BD0, 0x5D15, 0x5E5C, 0x5FA5, 0x60F1, 0x623F, 0x638F, 0x64E2,
+    0x6638, 0x6790, 0x68EA, 0x6A47, 0x6BA6, 0x6D08, 0x6E6C, 0x6FD3,
+    0x713C, 0x72A7, 0x7415, 0x7586, 0x76F9, 0x786E, 0x79E6, 0x7B61,
+    0x7CDE, 0x7E5D, 0x7FDF, 0x8164, 0x82EA, 0x8474, 0x8600, 0x878E,
+    0x891F, 0x8AB3, 0x8C49, 0x8DE1, 0x8F7C, 0x911A, 0x92BA, 0x945D,
+    0x9602, 0x97A9, 0x9954, 0x9B00, 0x9CB0, 0x9E62, 0xA016, 0xA1CD,
+    0xA386, 0xA542, 0xA701, 0xA8C2, 0xAA86, 0xAC4C, 0xAE15, 0xAFE1,
+    0xB1AF, 0xB37F, 0xB552, 0xB728, 0xB900, 0xBADB, 0xBCB9, 0xBE99,
+    0xC07B, 0xC261, 0xC449, 0xC633, 0xC820, 0xCA10, 0xCC02, 0xCDF7,
+    0xCFEE, 0xD1E8, 0xD3E5, 0xD5E4, 0xD7E6, 0xD9EB, 0xDBF2, 0xDDFC,
+    0xE008, 0xE217, 0xE429, 0xE63D, 0xE854, 0xEA6E, 0xEC8A, 0xEEA9,
+    0xF0CA, 0xF2EE, 0xF515, 0xF73F, 0xF96B, 0xFB9A, 0xFDCB, 0xFFFF,
+};
+
+// Waveform of the effect that is running
+static rgb_waveform_t waveform;
+static volatile bool running = false;
+
+// Position in the waveform in samples, Q32.32
+static uint64_t position;
+
+// Local function prototypes
+static bool rgb_effect_valid(const rgb_effect_t *e);
+static rgb_color_t rgb_effect_sample(const rgb_effect_t *e, const uint32_t j,
+                                     const uint32_t spp);
+static rgb_color_t rgb_mix(const rgb_color_t *a, const rgb_color_t *b,
+                           const uint32_t mix);
+static uint16_t rgb_lerp(const uint16_t a, const uint16_t b,
+                         const uint32_t frac);
+
 /*!
  * \brief Initialises the onboard RGB LED
  *
@@ -139,3 +201,297 @@ void rgb_blue_on(const bool b)
     // Set the channel compare value
     TPM0->CONTROLS[1].CnV = b ? blue : 0;
 }
+
+/*!
+ * \brief Calculates the waveform of an effect
+ *
+ * One cycle of the effect is sampled: a fade or breathe in
+ * RGB_WAVEFORM_SAMPLES samples, a blink pattern in one sample per bit and a
+ * sequence in an equal number of samples per colour. The increment per TPM2
+ * overflow follows from period_ms, so the interrupt only adds and shifts.
+ *
+ * \param[in]  e  Effect
+ * \param[out] w  Waveform
+ *
+ * \return False if the effect is not valid
+ */
+bool rgb_waveform(const rgb_effect_t *e, rgb_waveform_t *w)
+{
+    if(!rgb_effect_valid(e))
+    {
+        return false;
+    }
+
+    // Number of steps of period_ms and samples per step
+    uint32_t steps = 1;
+    uint32_t spp = RGB_WAVEFORM_SAMPLES;
+
+    switch(e->type)
+    {
+    case RGB_EFFECT_FADE:
+    case RGB_EFFECT_BREATHE:
+        break;
+
+    case RGB_EFFECT_BLINK:
+        steps = e->pattern_length;
+        spp = 1;
+        break;
+
+    case RGB_EFFECT_SEQUENCE:
+        steps = e->n;
+        spp = RGB_WAVEFORM_SAMPLES / e->n;
+        break;
+    }
+
+    w->samples = steps * spp;
+
+    for(uint32_t j=0; j<=w->samples; j++)
+    {
+        const rgb_color_t c = rgb_effect_sample(e, j, spp);
+
+        w->pwm[j][0] = gamma[c.r];
+        w->pwm[j][1] = gamma[c.g];
+        w->pwm[j][2] = gamma[c.b];
+    }
+
+    // A step of spp samples lasts period_ms * 48000 / 65536 overflows
+    w->increment = ((uint64_t)spp << 48) /
+                   ((uint32_t)e->period_ms * RGB_COUNTS_PER_MS);
+    w->interpolate = (e->type != RGB_EFFECT_BLINK);
+    w->repeat = e->repeat;
+    w->channels = e->channels;
+
+    return true;
+}
+
+/*!
+ * \brief Starts an effect
+ *
+ * The waveform of the effect is calculated once and then played in the TPM2
+ * overflow interrupt, so no task is involved after the effect is started.
+ * Every update writes the gamma-corrected colour to the channel value
+ * registers, which take effect at the start of the next PWM period. A
+ * running effect is replaced. The channels of the effect must not be set
+ * with the other functions while the effect is running.
+ *
+ * \param[in]  e  Effect
+ *
+ * \return False if the effect is not valid
+ */
+bool rgb_effect_start(const rgb_effect_t *e)
+{
+    if(!rgb_effect_valid(e))
+    {
+        return false;
+    }
+
+    // Stop the updates while the waveform is changed
+    TPM2->SC &= ~TPM_SC_TOIE_MASK;
+
+    rgb_waveform(e, &waveform);
+    position = 0;
+    running = true;
+
+    // Enable the interrupt in the NVIC
+    NVIC_SetPriority(TPM2_IRQn, 128);
+    NVIC_ClearPendingIRQ(TPM2_IRQn);
+    NVIC_EnableIRQ(TPM2_IRQn);
+
+    // Timer overflow interrupt enable
+    TPM2->SC |= TPM_SC_TOIE(1);
+
+    return true;
+}
+
+/*!
+ * \brief Stops the effect
+ *
+ * The LEDs keep the last colour of the effect.
+ */
+void rgb_effect_stop(void)
+{
+    TPM2->SC &= ~TPM_SC_TOIE_MASK;
+    running = false;
+}
+
+/*!
+ * \brief Checks if an effect is running
+ *
+ * \return True if an effect is running, false if there is no effect or the
+ * effect has ended
+ */
+bool rgb_effect_running(void)
+{
+    return running;
+}
+
+/*!
+ * \brief Checks an effect
+ *
+ * \param[in]  e  Effect
+ *
+ * \return False if the effect is not valid
+ */
+static bool rgb_effect_valid(const rgb_effect_t *e)
+{
+    return !((e->colors == NULL) || (e->n == 0) || (e->period_ms == 0) ||
+             ((e->type == RGB_EFFECT_FADE) && (e->n < 2)) ||
+             ((e->type == RGB_EFFECT_BLINK) &&
+              ((e->pattern_length == 0) || (e->pattern_length > 32))) ||
+             ((e->type == RGB_EFFECT_SEQUENCE) && (e->n > RGB_WAVEFORM_SAMPLES)));
+}
+
+/*!
+ * \brief Mixes two colours
+ *
+ * \param[in]  a    First colour
+ * \param[in]  b    Second colour
+ * \param[in]  mix  Weight of b, 0 to 256
+ *
+ * \return Mixed colour
+ */
+static rgb_color_t rgb_mix(const rgb_color_t *a, const rgb_color_t *b,
+                           const uint32_t mix)
+{
+    rgb_color_t c;
+
+    c.r = (uint8_t)((a->r * (256 - mix) + b->r * mix) >> 8);
+    c.g = (uint8_t)((a->g * (256 - mix) + b->g * mix) >> 8);
+    c.b = (uint8_t)((a->b * (256 - mix) + b->b * mix) >> 8);
+
+    return c;
+}
+
+/*!
+ * \brief Calculates a sample of an effect
+ *
+ * \param[in]  e    Effect
+ * \param[in]  j    Sample, the sample after the last is the end colour
+ * \param[in]  spp  Samples per step
+ *
+ * \return Colour
+ */
+static rgb_color_t rgb_effect_sample(const rgb_effect_t *e, const uint32_t j,
+                                     const uint32_t spp)
+{
+    static const rgb_color_t black = {0, 0, 0};
+
+    const uint32_t step = j / spp;
+    const uint32_t phase = j % spp;
+
+    switch(e->type)
+    {
+    case RGB_EFFECT_FADE:
+        return rgb_mix(&e->colors[0], &e->colors[1], (j << 8) / spp);
+
+    case RGB_EFFECT_BREATHE:
+    {
+        // Triangle from 0 to 256 and back to 0
+        const uint32_t level = (j <= spp/2) ? j : (spp - j);
+        return rgb_mix(&black, &e->colors[0], (level << 9) / spp);
+    }
+
+    case RGB_EFFECT_BLINK:
+    {
+        // The end colour is the colour of the last bit
+        const uint32_t bit = (step < e->pattern_length) ? step : (step - 1);
+        return (e->pattern & (1UL << bit)) ? e->colors[0] : black;
+    }
+
+    case RGB_EFFECT_SEQUENCE:
+    default:
+    {
+        // The last colour fades to the first if the sequence repeats,
+        // otherwise it is held
+        if(step >= e->n)
+        {
+            return e->repeat ? e->colors[0] : e->colors[e->n - 1];
+        }
+
+        const uint32_t next = (step + 1 < e->n) ? step + 1 : (e->repeat ? 0 : step);
+        return rgb_mix(&e->colors[step], &e->colors[next], (phase << 8) / spp);
+    }
+    }
+}
+
+/*!
+ * \brief Interpolates between two PWM values
+ *
+ * \param[in]  a     First value
+ * \param[in]  b     Second value
+ * \param[in]  frac  Weight of b, 0 to 255
+ *
+ * \return Interpolated value
+ */
+static uint16_t rgb_lerp(const uint16_t a, const uint16_t b,
+                         const uint32_t frac)
+{
+    return (uint16_t)(a + ((((int32_t)b - (int32_t)a) * (int32_t)frac) >> 8));
+}
+
+void TPM2_IRQHandler(void)
+{
+    // Clear pending interrupt
+    NVIC_ClearPendingIRQ(TPM2_IRQn);
+
+    // Clear the flag
+    TPM2->STATUS = TPM_STATUS_TOF(1);
+
+    if(!running)
+    {
+        return;
+    }
+
+    const rgb_waveform_t *w = &waveform;
+    uint32_t i = (uint32_t)(position >> 32);
+    uint32_t frac = (uint32_t)(position >> 24) & 0xFF;
+    bool done = false;
+
+    // The position can pass the end of a short cycle more than once
+    while(i >= w->samples)
+    {
+        if(!w->repeat)
+        {
+            i = w->samples;
+            frac = 0;
+            done = true;
+            break;
+        }
+
+        position -= (uint64_t)w->samples << 32;
+        i -= w->samples;
+    }
+
+    // The sample after the last one of a repeating cycle is the first one
+    const uint32_t next = ((i + 1) < w->samples) ? (i + 1) : (w->repeat ? 0 : w->samples);
+    const uint16_t *a = w->pwm[i];
+    const uint16_t *b = done ? a : w->pwm[next];
+
+    if(!w->interpolate)
+    {
+        frac = 0;
+    }
+
+    // Set the channel compare values
+    if(w->channels & RGB_RED)
+    {
+        TPM2->CONTROLS[0].CnV = rgb_lerp(a[0], b[0], frac);
+    }
+
+    if(w->channels & RGB_GREEN)
+    {
+        TPM2->CONTROLS[1].CnV = rgb_lerp(a[1], b[1], frac);
+    }
+
+    if(w->channels & RGB_BLUE)
+    {
+        TPM0->CONTROLS[1].CnV = rgb_lerp(a[2], b[2], frac);
+    }
+
+    position += w->increment;
+
+    if(done)
+    {
+        rgb_effect_stop();
+    }
+}
@@ -35,6 +35,72 @@
 #include <MKL25Z4.h>
 #include <stdbool.h>
 
+/// Channel masks of the effects engine
+#define RGB_RED   (1 << 0)
+#define RGB_GREEN (1 << 1)
+#define RGB_BLUE  (1 << 2)
+
+/// Colour with a perceived brightness of 0 to 255 per channel. The effects
+/// engine converts it to PWM values with a gamma of 2.2.
+typedef struct
+{
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+} rgb_color_t;
+
+/// Types of effects
+typedef enum
+{
+    RGB_EFFECT_FADE = 0, ///< Fade from colors[0] to colors[1] in period_ms
+    RGB_EFFECT_BREATHE,  ///< Fade colors[0] in and out in period_ms
+    RGB_EFFECT_BLINK,    ///< colors[0] on for every 1 bit of pattern, one
+                         ///< bit per period_ms, LSB first
+    RGB_EFFECT_SEQUENCE, ///< Fade through the n colors, one per period_ms
+} rgb_effect_type_t;
+
+/*!
+ * \brief Effect of the effects engine
+ *
+ * The descriptor is converted to a waveform when the effect is started, so
+ * it doesn't have to remain valid while the effect is running.
+ */
+typedef struct
+{
+    rgb_effect_type_t type;     ///< Type of the effect
+    const rgb_color_t *colors;  ///< Colours of the effect
+    uint8_t n;                  ///< Number of colours
+    uint16_t period_ms;         ///< Period of a step of the effect in ms
+    uint32_t pattern;           ///< Blink pattern, LSB first
+    uint8_t pattern_length;     ///< Number of bits in the pattern, 1 to 32
+    bool repeat;                ///< Repeat the effect until it is stopped
+    uint8_t channels;           ///< Channels that are driven, RGB_RED,
+                                ///< RGB_GREEN and/or RGB_BLUE
+} rgb_effect_t;
+
+/// Maximum number of samples of a waveform. A sequence has at most this
+/// number of colours.
+#define RGB_WAVEFORM_SAMPLES (64)
+
+/*!
+ * \brief Waveform of an effect
+ *
+ * One cycle of the effect is sampled at start-up. The samples are
+ * gamma-corrected PWM values, so the TPM2 overflow interrupt only has to
+ * step through them.
+ */
+typedef struct
+{
+    uint16_t pwm[RGB_WAVEFORM_SAMPLES+1][3]; ///< PWM values of red, green and
+                                             ///< blue. The sample after the
+                                             ///< last is the end value.
+    uint32_t samples;           ///< Number of samples of one cycle
+    uint64_t increment;         ///< Samples per TPM2 overflow in Q32.32
+    bool interpolate;           ///< Interpolate between the samples
+    bool repeat;                ///< Repeat the cycle until it is stopped
+    uint8_t channels;           ///< Channels that are driven
+} rgb_waveform_t;
+
 void rgb_init(void);
 void rgb_on(const bool r, const bool g, const bool b);
 void rgb_pwmcontrol(const uint16_t r, const uint16_t g, const uint16_t b);
@@ -43,4 +109,9 @@ void rgb_red_on(const bool r);
 void rgb_green_on(const bool g);
 void rgb_blue_on(const bool b);
 
+bool rgb_waveform(const rgb_effect_t *e, rgb_waveform_t *w);
+bool rgb_effect_start(const rgb_effect_t *effect);
+void rgb_effect_stop(void);
+bool rgb_effect_running(void);
+
 #endif // RGB_H
@@ -0,0 +1,94 @@
+/*! ***************************************************************************
+ *
+ * \brief     Single-producer single-consumer ring
+ * \file      ring.h
+ *
+ * \copyright 2026 HAN University of Applied Sciences. All Rights Reserved.
+ *            \n\n
+ *            Permission is hereby granted, free of charge, to any person
+ *            obtaining a copy of this software and associated documentation
+ *            files (the "Software"), to deal in the Software without
+ *            restriction, including without limitation the rights to use,
+ *            copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *            copies of the Software, and to permit persons to whom the
+ *            Software is furnished to do so, subject to the following
+ *            conditions:
+ *            \n\n
+ *            The above copyright notice and this permission notice shall be
+ *            included in all copies or substantial portions of the Software.
+ *            \n\n
+ *            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *            OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef RING_H
+#define RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/// What a push does when the ring is full
+typedef enum
+{
+    RING_DROP_NEWEST = 0, ///< The new element is dropped (count-and-drop)
+    RING_DROP_OLDEST,     ///< The oldest element is overwritten, so the ring
+                          ///< holds the latest elements (latest-wins)
+} ring_policy_t;
+
+/*!
+ * \brief Ring of fixed size elements with a timestamp per element
+ *
+ * The ring has one producer, typically an interrupt handler, and one
+ * consumer task. With RING_DROP_NEWEST the producer only writes head and the
+ * consumer only writes tail, so the ring is lock-free: no critical sections
+ * or kernel objects are needed to move the data. With RING_DROP_OLDEST the
+ * producer also writes tail, so ring_pop() and ring_push() use a critical
+ * section. The indices run freely and are masked when the storage is
+ * accessed, so all length elements can be used.
+ *
+ * The consumer can be notified when the number of elements reaches a
+ * watermark, so it is woken once per batch instead of once per element.
+ * The members must only be accessed with the ring functions.
+ */
+typedef struct
+{
+    uint8_t *elements;          ///< Storage for length elements
+    TickType_t *timestamps;     ///< Storage for length timestamps
+    size_t element_size;        ///< Size of an element in bytes
+    uint32_t mask;              ///< length - 1
+    volatile uint32_t head;     ///< Elements pushed, written by the producer
+    volatile uint32_t tail;     ///< Elements popped, written by the consumer
+                                ///< and by a RING_DROP_OLDEST producer
+    volatile uint32_t overruns; ///< Elements dropped, written by the producer
+    ring_policy_t policy;       ///< Overrun policy
+    TaskHandle_t task;          ///< Task notified at the watermark, or NULL
+    uint32_t bits;              ///< Notification bits set in task
+    uint32_t watermark;         ///< Number of elements that notifies task
+} ring_t;
+
+// Function prototypes
+bool ring_init(ring_t *ring, void *elements, TickType_t timestamps[],
+               const size_t element_size, const uint32_t length);
+void ring_notify(ring_t *ring, TaskHandle_t task, const uint32_t bits,
+                 const uint32_t watermark);
+void ring_policy(ring_t *ring, const ring_policy_t policy);
+bool ring_push_from_isr(ring_t *ring, const void *element,
+                        const TickType_t timestamp,
+                        BaseType_t *pxHigherPriorityTaskWoken);
+bool ring_push(ring_t *ring, const void *element, const TickType_t timestamp);
+uint32_t ring_pop(ring_t *ring, void *elements, TickType_t timestamps[],
+                  const uint32_t n);
+uint32_t ring_count(const ring_t *ring);
+uint32_t ring_overruns(const ring_t *ring);
+
+#endif // RING_H
@@ -31,6 +31,7 @@
  *****************************************************************************/
 #include <MKL25Z4.h>
 #include <stdbool.h>
+#include <math.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -40,6 +41,7 @@
 #include "task.h"
 #include "timers.h"
 
+#include "filter.h"
 #include "leds.h"
 #include "mma8451.h"
 #include "rgb.h"
@@ -51,6 +53,19 @@
 /*----------------------------------------------------------------------------*/
 // Local defines
 /*----------------------------------------------------------------------------*/
+// The MMA8451 samples at 100 Hz and the callback is called every 5 samples
+#define ACC_ODR        (MMA8451_ODR_100HZ)
+#define ACC_WATERMARK  (5)
+
+// Set to 1 to compare the cycles of the fixed-point roll and pitch with the
+// previous floating-point version once after start-up
+#ifndef ROLLPITCH_BENCHMARK
+#define ROLLPITCH_BENCHMARK (0)
+#endif
+
+// Number of calls of each version in the benchmark
+#define BENCHMARK_CALLS (1000)
+
 typedef struct
 {
     int16_t x;
@@ -60,19 +75,34 @@ typedef struct
 /*----------------------------------------------------------------------------*/
 // Local function prototypes
 /*----------------------------------------------------------------------------*/
-static void vBlinkTask(void *pvParameters);
-static void vMma8451Task(void *pvParameters);
+static void vHeartbeatCallback(TimerHandle_t xTimer);
+static void vAccelerometerCallback(const mma8451_data_t data[], const uint32_t n);
+static int16_t sFilterAxis(filter_median_t *median, filter_iir_t *lowpass, q16_t block[],
+                           const uint32_t n);
 static void vOledTask(void *parameters);
 static void vDrawTask(void *parameters);
-static void vSwTask(void *parameters);
+static void vSwitchEvent(const sw_event_t *event);
+static void vCalibrated(const bool success);
 static void vADCTask(void *parameters);
+#if (ROLLPITCH_BENCHMARK == 1)
+static void vBenchmarkTask(void *parameters);
+#endif
 
 /*----------------------------------------------------------------------------*/
 // Local variables
 /*----------------------------------------------------------------------------*/
-TaskHandle_t xMma8451TaskHandler;
 static SemaphoreHandle_t xOledMutex;
 static QueueHandle_t xCircleQueue;
+static QueueHandle_t xSwQueue;
+
+// Filter stages for the x, y and z axes of the accelerometer. A median of
+// three removes spikes, followed by a low-pass filter.
+static filter_median_t xAccMedian[3];
+static filter_iir_t xAccLowpass[3];
+
+// Cursor that is moved by the accelerometer. The origin of the sprite is the
+// top-left pixel, so the center of the circle is at (x+2,y+2).
+static sprite_t cursor = {&sprite_circle, SSD1306_WIDTH/2-2, SSD1306_HEIGHT/2-2, false};
 
 /*----------------------------------------------------------------------------*/
 // Main application
@@ -82,16 +112,26 @@ int main(void)
     rgb_init();
     xSerialPortInit(921600, 128);
 
+    // Heartbeat: the LED on the shield flashes for 50 ms every two seconds.
+    // A one-shot timer switches the LED and restarts itself with the time
+    // until the next switch, so no task is needed.
+    led_init();
+    led_on();
+
+    TimerHandle_t xHeartbeatTimer = xTimerCreate("Heartbeat", pdMS_TO_TICKS(50),
+                                                 pdFALSE, NULL, vHeartbeatCallback);
+    xTimerStart(xHeartbeatTimer, 0);
+
     vSerialPutString("\r\nFRDM-KL25Z FreeRTOS demo Week 7 - Example 02\r\n");
     vSerialPutString("By Hugo Arends\r\n\r\n");
 
     // Create the tasks
-    xTaskCreate(vBlinkTask,   "Blink",   configMINIMAL_STACK_SIZE, NULL, 1, NULL);
-    xTaskCreate(vMma8451Task, "MMA4851", configMINIMAL_STACK_SIZE, NULL, 4, &xMma8451TaskHandler);
     xTaskCreate(vOledTask,    "Oled",    configMINIMAL_STACK_SIZE, NULL, 3, NULL);
     xTaskCreate(vDrawTask,    "Draw",    configMINIMAL_STACK_SIZE, NULL, 2, NULL);
-    xTaskCreate(vSwTask,      "Sw",      configMINIMAL_STACK_SIZE, NULL, 1, NULL);
     xTaskCreate(vADCTask,     "ADC",     configMINIMAL_STACK_SIZE, NULL, 2, &xADCTaskHandle);
+#if (ROLLPITCH_BENCHMARK == 1)
+    xTaskCreate(vBenchmarkTask, "Bench", configMINIMAL_STACK_SIZE*2, NULL, 1, NULL);
+#endif
 
     // Craeate mutex for accessing oled display
     xOledMutex = xSemaphoreCreateMutex();
@@ -101,6 +141,42 @@ int main(void)
     xCircleQueue = xQueueCreate(5, sizeof(point_t));
     vQueueAddToRegistry(xCircleQueue, "xCircleQueue");
 
+    // Create queue for the switch events, which are handled by vOledTask
+    xSwQueue = xQueueCreate(5, sizeof(sw_event_t));
+    vQueueAddToRegistry(xSwQueue, "xSwQueue");
+
+    sw_init();
+
+    if(!sw_start(xSwQueue))
+    {
+        vSerialPutString("switches start failed\r\n");
+    }
+
+    // Initialise the accelerometer filters
+    for(uint32_t i=0; i<3; i++)
+    {
+        filter_median_init(&xAccMedian[i], 3);
+        filter_iir_init(&xAccLowpass[i], Q16(0.25));
+    }
+
+    // Start the accelerometer driver, it calls the callback with every batch
+    // of samples. Motion detection at 0.19 g on the X or Y axis matches the
+    // dead-band of about 10 degrees, so the driver stops sending batches
+    // two seconds after the board has been put down flat.
+    static const mma8451_events_t xAccEvents =
+    {
+        .motion_threshold = 3,
+        .motion_count = 5,
+        .transient_threshold = 8,
+        .transient_count = 2,
+        .idle_ms = 2000,
+    };
+
+    if(!mma8451_start(ACC_ODR, ACC_WATERMARK, vAccelerometerCallback, &xAccEvents))
+    {
+        vSerialPutString("mma8451 start failed\r\n");
+    }
+
     /* Start the scheduler so the tasks start executing. */
     vTaskStartScheduler();
 
@@ -113,83 +189,98 @@ int main(void)
 
 /*----------------------------------------------------------------------------*/
 
-static void vBlinkTask( void *pvParameters )
+static void vHeartbeatCallback(TimerHandle_t xTimer)
 {
-    led_init();
+    // This function is called by the timer task
+    static bool on = true;
 
-    char str[32];
-    sprintf(str, "[%*s] started\r\n", 12, __func__);
-    vSerialPutString(str);
+    on = !on;
 
-    /* As per most tasks, this task is implemented within an infinite loop. */
-    for( ;; )
+    if(on)
     {
         led_on();
-        vTaskDelay(pdMS_TO_TICKS(50));
-
+    }
+    else
+    {
         led_off();
-        vTaskDelay(pdMS_TO_TICKS(1950));
     }
+
+    // Changing the period of a dormant timer also starts it
+    xTimerChangePeriod(xTimer, pdMS_TO_TICKS(on ? 50 : 1950), 0);
 }
 
 /*----------------------------------------------------------------------------*/
 
-static void vMma8451Task( void *pvParameters )
+static void vAccelerometerCallback(const mma8451_data_t data[], const uint32_t n)
 {
-    if(!mma8451_init())
+    // This function is called by the MMA8451 driver task
+    static q16_t x = Q16(SSD1306_WIDTH/2);
+    static q16_t y = Q16(SSD1306_HEIGHT/2);
+
+    // Static, because the stack of the driver task is too small
+    static q16_t block[MMA8451_FIFO_SIZE];
+
+    point_t point;
+    q16_t roll, pitch;
+
+    // Filter the batch per axis
+    mma8451_data_t filtered = data[n-1];
+
+    for(uint32_t i=0; i<n; i++)
     {
-        vSerialPutString("mma8451 init failed\r\n");
+        block[i] = MMA8451_TO_G(data[i].x);
     }
-    else
+    filtered.x = sFilterAxis(&xAccMedian[0], &xAccLowpass[0], block, n);
+
+    for(uint32_t i=0; i<n; i++)
     {
-        if(!mma8451_calibrate())
-        {
-            vSerialPutString("mma8451 calibrate failed\r\n");
-        }
+        block[i] = MMA8451_TO_G(data[i].y);
     }
+    filtered.y = sFilterAxis(&xAccMedian[1], &xAccLowpass[1], block, n);
 
-    point_t point = {64, 32};
-    float x = 64.0f;
-    float y = 32.0f;
+    for(uint32_t i=0; i<n; i++)
+    {
+        block[i] = MMA8451_TO_G(data[i].z);
+    }
+    filtered.z = sFilterAxis(&xAccMedian[2], &xAccLowpass[2], block, n);
 
-    char str[32];
-    sprintf(str, "[%*s] started\r\n", 12, __func__);
-    vSerialPutString(str);
+    // Roll and pitch of the most recent filtered sample
+    mma8451_rollpitch(&filtered, &roll, &pitch);
 
-    /* As per most tasks, this task is implemented within an infinite loop. */
-    for( ;; )
-    {
-        // Wait for notification
-        ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+    // Limit the inputs
+    roll  = ((roll >= Q16(-10)) && (roll <= Q16(10))) ? 0 : roll;
+    pitch = ((pitch >= Q16(-10)) && (pitch <= Q16(10))) ? 0 : pitch;
 
-        // These functions are NOT reentrent and should be called by a single
-        // task
-        mma8451_read();
-        mma8451_rollpitch();
+    // Calculate next center, the step is proportional to the number of
+    // samples in the batch
+    x = x + (roll / 100) * (q16_t)n;
+    y = y + (pitch / 100) * (q16_t)n;
 
-        // Limit the inputs
-        roll  = ((roll >= -10) && (roll <= 10)) ? 0 : roll;
-        pitch = ((pitch >= -10) && (pitch <= 10)) ? 0 : pitch;
+    // Limit the results
+    x = (x > Q16(SSD1306_WIDTH-1)) ? Q16(SSD1306_WIDTH-1) : x;
+    x = (x <   0) ?   0 : x;
 
-        // Calculate next center
-        x = x + (roll / 100);
-        y = y + (pitch / 100);
+    y = (y > Q16(SSD1306_HEIGHT-1)) ? Q16(SSD1306_HEIGHT-1) : y;
+    y = (y <  0) ?  0 : y;
 
-        // Limit the results
-        x = (x > 127) ? 127 : x;
-        x = (x <   0) ?   0 : x;
+    point.x = (int16_t)Q16_TO_INT(x);
+    point.y = (int16_t)Q16_TO_INT(y);
+    xQueueSend(xCircleQueue, &point, pdMS_TO_TICKS(10));
 
-        y = (y > 63) ? 63 : y;
-        y = (y <  0) ?  0 : y;
+//    char str[32];
+//    sprintf(str, "roll : %4ld\tpitch: %4ld\r", Q16_TO_INT(roll), Q16_TO_INT(pitch));
+//    vSerialPutString(str);
+}
 
-        point.x = (int16_t)x;
-        point.y = (int16_t)y;
-        xQueueSend(xCircleQueue, &point, pdMS_TO_TICKS(10));
+static int16_t sFilterAxis(filter_median_t *median, filter_iir_t *lowpass, q16_t block[],
+                           const uint32_t n)
+{
+    // The stages process the block in place
+    filter_median(median, block, block, n);
+    filter_iir(lowpass, block, block, n);
 
-//        char str[32];
-//        sprintf(str, "roll : %5.1f\tpitch: %5.1f\r", roll, pitch);
-//        vSerialPutString(str);
-    }
+    // Most recent filtered value in counts
+    return (int16_t)(block[n-1] / (Q16_ONE / COUNTS_PER_G));
 }
 
 /*----------------------------------------------------------------------------*/
@@ -197,7 +288,6 @@ static void vMma8451Task( void *pvParameters )
 static void vOledTask(void *parameters)
 {
     ssd1306_init();
-    ssd1306_setorientation(1);
     ssd1306_setfont(Monospaced_plain_12);
     ssd1306_clearscreen();
     ssd1306_putstring(0, 0, "FreeRTOS demo");
@@ -214,18 +304,33 @@ static void vOledTask(void *parameters)
     if(xSemaphoreTake(xOledMutex, pdMS_TO_TICKS(100)) == pdPASS)
     {
         ssd1306_clearscreen();
+        ssd1306_sprite_invalidate(&cursor);
+        ssd1306_sprite_show(&cursor);
         xSemaphoreGive(xOledMutex);
     }
 
     TickType_t xLastWakeTime = xTaskGetTickCount();
+    sw_event_t event;
 
     // As per most tasks, this task is implemented in an infinite loop.
     for( ;; )
     {
         ssd1306_update();
 
-        // Wait before updating the next time
-        vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(100));
+        // Handle the switch events while waiting before updating the next
+        // time
+        const TickType_t xNextWakeTime = xLastWakeTime + pdMS_TO_TICKS(100);
+        TickType_t xElapsed;
+
+        while((xElapsed = xTaskGetTickCount() - xLastWakeTime) < pdMS_TO_TICKS(100))
+        {
+            if(xQueueReceive(xSwQueue, &event, pdMS_TO_TICKS(100) - xElapsed) == pdPASS)
+            {
+                vSwitchEvent(&event);
+            }
+        }
+
+        xLastWakeTime = xNextWakeTime;
     }
 }
 
@@ -233,8 +338,7 @@ static void vOledTask(void *parameters)
 
 static void vDrawTask(void *parameters)
 {
-    point_t point1 = {64, 32};
-    point_t point2 = {64, 32};
+    point_t point = {SSD1306_WIDTH/2, SSD1306_HEIGHT/2};
 
     char str[32];
     sprintf(str, "[%*s] started\r\n", 12, __func__);
@@ -245,103 +349,74 @@ static void vDrawTask(void *parameters)
     {
         if(xSemaphoreTake(xOledMutex, pdMS_TO_TICKS(20)) == pdPASS)
         {
-            point2.x = (point2.x > 125) ? 125 : point2.x;
-            point2.x = (point2.x <   2) ?   2 : point2.x;
-
-            point2.y = (point2.y > 61) ? 61 : point2.y;
-            point2.y = (point2.y <  2) ?  2 : point2.y;
-
-            // Remove old circle
-            ssd1306_setpixel(point1.x-2, point1.y,   OFF);
-            ssd1306_setpixel(point1.x-2, point1.y-1, OFF);
-            ssd1306_setpixel(point1.x-2, point1.y+1, OFF);
-            ssd1306_setpixel(point1.x+2, point1.y,   OFF);
-            ssd1306_setpixel(point1.x+2, point1.y-1, OFF);
-            ssd1306_setpixel(point1.x+2, point1.y+1, OFF);
-            ssd1306_setpixel(point1.x,   point1.y-2, OFF);
-            ssd1306_setpixel(point1.x-1, point1.y-2, OFF);
-            ssd1306_setpixel(point1.x+1, point1.y-2, OFF);
-            ssd1306_setpixel(point1.x,   point1.y+2, OFF);
-            ssd1306_setpixel(point1.x-1, point1.y+2, OFF);
-            ssd1306_setpixel(point1.x+1, point1.y+2, OFF);
-
-            // Draw new circle
-            ssd1306_setpixel(point2.x-2, point2.y,   ON);
-            ssd1306_setpixel(point2.x-2, point2.y-1, ON);
-            ssd1306_setpixel(point2.x-2, point2.y+1, ON);
-            ssd1306_setpixel(point2.x+2, point2.y,   ON);
-            ssd1306_setpixel(point2.x+2, point2.y-1, ON);
-            ssd1306_setpixel(point2.x+2, point2.y+1, ON);
-            ssd1306_setpixel(point2.x,   point2.y-2, ON);
-            ssd1306_setpixel(point2.x-1, point2.y-2, ON);
-            ssd1306_setpixel(point2.x+1, point2.y-2, ON);
-            ssd1306_setpixel(point2.x,   point2.y+2, ON);
-            ssd1306_setpixel(point2.x-1, point2.y+2, ON);
-            ssd1306_setpixel(point2.x+1, point2.y+2, ON);
+            point.x = (point.x > (SSD1306_WIDTH-3)) ? (SSD1306_WIDTH-3) : point.x;
+            point.x = (point.x <   2) ?   2 : point.x;
+
+            point.y = (point.y > (SSD1306_HEIGHT-3)) ? (SSD1306_HEIGHT-3) : point.y;
+            point.y = (point.y <  2) ?  2 : point.y;
+
+            // Move the circle. The sprite is XORed into the framebuffer, so
+            // the background below the old location is restored and only the
+            // pages covered by the old and new location are updated.
+            ssd1306_sprite_move(&cursor, point.x-2, point.y-2);
+            ssd1306_sprite_show(&cursor);
 
             xSemaphoreGive(xOledMutex);
         }
 
-        point1 = point2;
-
         // Wait until a new circle must be drawn
-        xQueueReceive(xCircleQueue, &point2, portMAX_DELAY);
+        xQueueReceive(xCircleQueue, &point, portMAX_DELAY);
     }
 }
 
 /*----------------------------------------------------------------------------*/
 
-void vSwTask(void *pvParameters)
+static void vSwitchEvent(const sw_event_t *event)
 {
-    sw_init();
-
-    bool sw1_pressed = false;
-    bool sw2_pressed = false;
-
-    char str[32];
-    sprintf(str, "[%*s] started\r\n", 12, __func__);
-    vSerialPutString(str);
-
-    TickType_t xLastWakeTime = xTaskGetTickCount();
-
-    for( ;; )
+    // This function is called by vOledTask
+    if(event->type != SW_PRESS)
     {
-        // Check SW1
-        if(!sw1_pressed && sw_pressed(SW1))
-        {
-            sw1_pressed = true;
+        return;
+    }
 
-            if(xSemaphoreTake(xOledMutex, pdMS_TO_TICKS(20)) == pdPASS)
-            {
-                ssd1306_putstring(0, 25, " SW1 was pressed ");
-                xSemaphoreGive(xOledMutex);
-            }
-        }
+    // SW1 recalibrates the accelerometer with the board lying flat
+    if(event->sw == SW1)
+    {
+        mma8451_recalibrate(vCalibrated);
 
-        if(sw1_pressed && !sw_pressed(SW1))
+        if(xSemaphoreTake(xOledMutex, pdMS_TO_TICKS(20)) == pdPASS)
         {
-            sw1_pressed = false;
+            ssd1306_putstring(0, 25, "Calibrating ");
+            xSemaphoreGive(xOledMutex);
         }
+    }
 
-        // Check SW2
-        if(!sw2_pressed && sw_pressed(SW2))
+    // SW2 clears the screen
+    if(event->sw == SW2)
+    {
+        if(xSemaphoreTake(xOledMutex, pdMS_TO_TICKS(20)) == pdPASS)
         {
-            sw2_pressed = true;
-
-            if(xSemaphoreTake(xOledMutex, pdMS_TO_TICKS(20)) == pdPASS)
-            {
-                ssd1306_clearscreen();
-                xSemaphoreGive(xOledMutex);
-            }
+            ssd1306_clearscreen();
+            ssd1306_sprite_invalidate(&cursor);
+            ssd1306_sprite_show(&cursor);
+            xSemaphoreGive(xOledMutex);
         }
+    }
+}
 
-        if(sw2_pressed && !sw_pressed(SW2))
-        {
-            sw2_pressed = false;
-        }
+static void vCalibrated(const bool success)
+{
+    // This function is called by the MMA8451 driver task. The text is shown
+    // with the next update by vOledTask.
+    if(xSemaphoreTake(xOledMutex, pdMS_TO_TICKS(20)) == pdPASS)
+    {
+        ssd1306_putstring(0, 25, success ? " Calibrated " : "Cal. failed ");
+        xSemaphoreGive(xOledMutex);
+    }
 
-        // Wait before sampling the next time
-        vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(100));
+    if(!success)
+    {
+        vSerialPutString("mma8451 calibration failed, retrying\r\n");
     }
 }
 
@@ -352,29 +427,43 @@ static void vADCTask(void *parameters)
     tcrt5000_init();
 
     // Enable the second line to see what happens if this task is not notified
-    // within the expected timeout time
+    // within the expected timeout time. In threshold mode, the task is only
+    // notified when the level crosses the hysteresis band.
+#if (TCRT5000_MODE == TCRT5000_MODE_THRESHOLD)
+    const TickType_t xADCConversionTimeout = portMAX_DELAY;
+#else
     const TickType_t xADCConversionTimeout = pdMS_TO_TICKS(110);
+#endif
 
-    uint32_t ulADCResult;
+    uint32_t ulADCResults[8];
+    uint32_t ulADCResult = 0;
+    uint32_t ulNotifiedValue;
+    uint32_t ulOverruns = 0;
     BaseType_t xResult;
 
-    char str[32];
+    char str[64];
     sprintf(str, "[%*s] started\r\n", 12, __func__);
     vSerialPutString(str);
 
+    // Show the calibration of ADC0
+    adc_calibration_t calibration;
+    if(adc_calibration(&calibration))
+    {
+        sprintf(str, "[%*s] ADC PG=%04X MG=%04X OFS=%04X%s\r\n", 12, __func__,
+                calibration.pg, calibration.mg, calibration.ofs,
+                calibration.cached ? " (cached)" : "");
+        vSerialPutString(str);
+    }
+
     // As per most tasks, this task is implemented in an infinite loop.
     for( ;; )
     {
         // Wait for the next ADC conversion result
-        xResult = xTaskNotifyWait(0, // The new ADC value will overwrite the
-                                     // old value, so there is no need to clear
-                                     // any bits before waiting for the new
-                                     // notification value
-                                  0, // Future ADC values will overwrite the
-                                     // existing value, so there is no need to
-                                     // clear any bits before exiting
-                                     // xTaskNotifyWait()
-                                  &ulADCResult,
+        xResult = xTaskNotifyWait(0, // Don't clear any bits before waiting
+                                  TCRT5000_NOTIFY_BIT, // Clear the bit on
+                                                       // exit, the results
+                                                       // are in the ring
+                                  &ulNotifiedValue,
                                   xADCConversionTimeout);
 
         // Check the notification result
@@ -382,9 +471,26 @@ static void vADCTask(void *parameters)
         {
             // Notification received
 
+            // Drain the ring, only the most recent result is used
+            uint32_t n;
+            while((n = tcrt5000_read(ulADCResults, NULL, 8)) > 0)
+            {
+                ulADCResult = ulADCResults[n-1];
+            }
+
             // Process the ADC result
             rgb_green_on(ulADCResult < 2000);
             rgb_red_on(ulADCResult >= 2000);
+
+            // Report results that were dropped because this task didn't
+            // keep up, for example during a load spike in another task
+            if(tcrt5000_overruns() != ulOverruns)
+            {
+                ulOverruns = tcrt5000_overruns();
+                sprintf(str, "[%*s] %u results dropped\r\n", 12, __func__,
+                        (unsigned int)ulOverruns);
+                vSerialPutString(str);
+            }
         }
         else
         {
@@ -394,3 +500,105 @@ static void vADCTask(void *parameters)
         }
     }
 }
+
+/*----------------------------------------------------------------------------*/
+
+#if (ROLLPITCH_BENCHMARK == 1)
+
+// Previous floating-point version of mma8451_rollpitch(). The counts are
+// converted to g's and the double precision functions of the C library are
+// used.
+static void vRollPitchFloat(const mma8451_data_t *data, float *roll, float *pitch)
+{
+    float x = (float)data->x / COUNTS_PER_G;
+    float y = (float)data->y / COUNTS_PER_G;
+    float z = (float)data->z / COUNTS_PER_G;
+
+    *roll = atan2(y, z)*180/3.14159265f;
+    *pitch = atan2(x, sqrt(y*y + z*z))*180/3.14159265f;
+}
+
+// Core clock cycles between two readings of SysTick. SysTick counts down once
+// every core clock cycle and is reloaded every tick, so the measured interval
+// must be shorter than one tick.
+static uint32_t ulSysTickCycles(const uint32_t start, const uint32_t end)
+{
+    return (start >= end) ? (start - end) : (start + (SysTick->LOAD + 1) - end);
+}
+
+// Measures the average number of core clock cycles of the floating-point and
+// the fixed-point roll and pitch and reports them once. The Cortex-M0+ has no
+// DWT cycle counter, so the SysTick of the kernel is used. Every call is
+// measured with interrupts disabled and the cost of reading SysTick is
+// subtracted.
+static void vBenchmarkTask(void *parameters)
+{
+    // Flat, tilted and upside down, in counts
+    static const mma8451_data_t data[] =
+    {
+        {0,     0,     0,  4096},
+        {0,  1024,  -512,  3900},
+        {0, -2896,  2896,     0},
+        {0,   300,  -200, -4080},
+    };
+
+    volatile float froll;
+    volatile float fpitch;
+    volatile q16_t roll;
+    volatile q16_t pitch;
+    uint32_t ulFloat = 0;
+    uint32_t ulFixed = 0;
+    uint32_t ulOverhead;
+    uint32_t start;
+    uint32_t end;
+
+    // Wait for the other tasks to report they have started
+    vTaskDelay(pdMS_TO_TICKS(100));
+
+    taskENTER_CRITICAL();
+    start = SysTick->VAL;
+    end = SysTick->VAL;
+    taskEXIT_CRITICAL();
+    ulOverhead = ulSysTickCycles(start, end);
+
+    for(uint32_t i=0; i<BENCHMARK_CALLS; i++)
+    {
+        const mma8451_data_t *d = &data[i % (sizeof(data)/sizeof(data[0]))];
+        float fr, fp;
+        q16_t r, p;
+
+        taskENTER_CRITICAL();
+        start = SysTick->VAL;
+        vRollPitchFloat(d, &fr, &fp);
+        end = SysTick->VAL;
+        taskEXIT_CRITICAL();
+        ulFloat += ulSysTickCycles(start, end) - ulOverhead;
+
+        taskENTER_CRITICAL();
+        start = SysTick->VAL;
+        mma8451_rollpitch(d, &r, &p);
+        end = SysTick->VAL;
+        taskEXIT_CRITICAL();
+        ulFixed += ulSysTickCycles(start, end) - ulOverhead;
+
+        froll = fr;
+        fpitch = fp;
+        roll = r;
+        pitch = p;
+    }
+
+    (void)froll;
+    (void)fpitch;
+    (void)roll;
+    (void)pitch;
+
+    char str[64];
+    sprintf(str, "[%*s] rollpitch float %lu fixed %lu cycles\r\n", 12, __func__,
+            (unsigned long)(ulFloat / BENCHMARK_CALLS),
+            (unsigned long)(ulFixed / BENCHMARK_CALLS));
+    vSerialPutString(str);
+
+    vTaskDelete(NULL);
+}
+
+#endif
@@ -35,6 +35,22 @@ static PORT_Type * port_mapping[N_SWITCHES] = {PORTD, PORTD};
 static GPIO_Type * gpio_mapping[N_SWITCHES] = {PTD,   PTD};
 static uint8_t     pin_mapping[N_SWITCHES]  = {3,     5};
 
+// Queue that receives the events, see sw_start()
+static QueueHandle_t xSwQueue = NULL;
+
+// One-shot timers per switch
+static TimerHandle_t xDebounceTimer[N_SWITCHES];
+static TimerHandle_t xLongPressTimer[N_SWITCHES];
+
+// Debounced state of the switches
+static bool stable_pressed[N_SWITCHES];
+
+// Local function prototypes
+static void vSwDebounceCallback(TimerHandle_t xTimer);
+static void vSwLongPressCallback(TimerHandle_t xTimer);
+static void sw_send(const sw_t sw, const sw_event_type_t type);
+static void sw_irq_enable(const sw_t sw, const bool enable);
+
 /*!
  * \brief Initialises the switches on the shield
  *
@@ -80,3 +96,162 @@ bool sw_pressed(const sw_t sw)
     // If the key is pressed, the bit at that position will read logic 0
     return ((gpio_mapping[sw]->PDIR & (1<<pin_mapping[sw])) == 0);
 }
+
+/*!
+ * \brief Starts the interrupt driven switch events
+ *
+ * This functions enables an interrupt on both edges of the switches. The
+ * first edge disables the interrupt of the switch and starts its debounce
+ * timer, so a bouncing contact sends a single command to the timer task.
+ * SW_DEBOUNCE_MS later the interrupt is enabled again and the state of the
+ * switch is read. If it changed, a SW_PRESS or SW_RELEASE event is sent to
+ * the queue, and a SW_LONG_PRESS
+ * event if the switch is still pressed after SW_LONG_PRESS_MS. The timers
+ * run in the FreeRTOS timer task, so there is no task that polls the
+ * switches. sw_init() must be called first.
+ *
+ * \param[in]  queue  Queue for items of type ::sw_event_t
+ *
+ * \return False if the timers could not be created
+ */
+bool sw_start(QueueHandle_t queue)
+{
+    xSwQueue = queue;
+
+    for(int i=0; i<N_SWITCHES; i++)
+    {
+        xDebounceTimer[i] = xTimerCreate("Debounce", pdMS_TO_TICKS(SW_DEBOUNCE_MS),
+                                         pdFALSE, (void *)(uintptr_t)i, vSwDebounceCallback);
+        xLongPressTimer[i] = xTimerCreate("LongPress", pdMS_TO_TICKS(SW_LONG_PRESS_MS),
+                                          pdFALSE, (void *)(uintptr_t)i, vSwLongPressCallback);
+
+        if((xDebounceTimer[i] == NULL) || (xLongPressTimer[i] == NULL))
+        {
+            return false;
+        }
+
+        stable_pressed[i] = sw_pressed((sw_t)i);
+    }
+
+    for(int i=0; i<N_SWITCHES; i++)
+    {
+        sw_irq_enable((sw_t)i, true);
+    }
+
+    // Enable the interrupt in the NVIC
+    NVIC_SetPriority(PORTD_IRQn, 128);
+    NVIC_ClearPendingIRQ(PORTD_IRQn);
+    NVIC_EnableIRQ(PORTD_IRQn);
+
+    return true;
+}
+
+/*!
+ * \brief Enables or disables the interrupt of a switch
+ *
+ * The interrupt flag is cleared, so an edge while the interrupt was disabled
+ * doesn't cause an interrupt.
+ *
+ * - ISF = 1            : Clear the interrupt flag
+ * - IRQC[3:0] = 1011   : Interrupt on either edge
+ * - IRQC[3:0] = 0000   : Interrupt disabled
+ */
+static void sw_irq_enable(const sw_t sw, const bool enable)
+{
+    const uint32_t pcr = port_mapping[sw]->PCR[pin_mapping[sw]] &
+                         ~(PORT_PCR_ISF_MASK | PORT_PCR_IRQC_MASK);
+
+    port_mapping[sw]->PCR[pin_mapping[sw]] = pcr | PORT_PCR_ISF_MASK |
+                                             PORT_PCR_IRQC(enable ? 0xB : 0x0);
+}
+
+/*!
+ * \brief Sends an event to the queue
+ *
+ * Called from the timer task. If the queue is full the event is dropped,
+ * because the timer task must not block.
+ */
+static void sw_send(const sw_t sw, const sw_event_type_t type)
+{
+    sw_event_t event =
+    {
+        .sw = sw,
+        .type = type,
+        .timestamp = xTaskGetTickCount(),
+    };
+
+    xQueueSend(xSwQueue, &event, 0);
+}
+
+/*!
+ * \brief Called SW_DEBOUNCE_MS after the first edge of a switch
+ *
+ * The interrupt is enabled before the switch is read, so a change after the
+ * read starts a new debounce period.
+ */
+static void vSwDebounceCallback(TimerHandle_t xTimer)
+{
+    const sw_t sw = (sw_t)(uintptr_t)pvTimerGetTimerID(xTimer);
+
+    sw_irq_enable(sw, true);
+
+    const bool pressed = sw_pressed(sw);
+
+    if(pressed == stable_pressed[sw])
+    {
+        // A glitch, the state didn't change
+        return;
+    }
+
+    stable_pressed[sw] = pressed;
+
+    if(pressed)
+    {
+        sw_send(sw, SW_PRESS);
+        xTimerReset(xLongPressTimer[sw], 0);
+    }
+    else
+    {
+        xTimerStop(xLongPressTimer[sw], 0);
+        sw_send(sw, SW_RELEASE);
+    }
+}
+
+/*!
+ * \brief Called when a switch has been pressed for SW_LONG_PRESS_MS
+ */
+static void vSwLongPressCallback(TimerHandle_t xTimer)
+{
+    const sw_t sw = (sw_t)(uintptr_t)pvTimerGetTimerID(xTimer);
+
+    if(stable_pressed[sw])
+    {
+        sw_send(sw, SW_LONG_PRESS);
+    }
+}
+
+void PORTD_IRQHandler(void)
+{
+    // Clear pending interrupt
+    NVIC_ClearPendingIRQ(PORTD_IRQn);
+
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    for(int i=0; i<N_SWITCHES; i++)
+    {
+        if(port_mapping[i]->ISFR & (1<<pin_mapping[i]))
+        {
+            // Ignore the bounces until the debounce timer expires. If the
+            // timer command queue is full, the interrupt stays enabled and
+            // the next edge tries again.
+            sw_irq_enable((sw_t)i, false);
+
+            if(xTimerStartFromISR(xDebounceTimer[i], &xHigherPriorityTaskWoken) != pdPASS)
+            {
+                sw_irq_enable((sw_t)i, true);
+            }
+        }
+    }
+
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
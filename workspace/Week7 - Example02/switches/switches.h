@@ -35,9 +35,20 @@
 #include <MKL25Z4.h>
 #include <stdbool.h>
 
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "timers.h"
+
 /// The number of keys available on the shield
 #define N_SWITCHES (2)
 
+/// Time in ms after the first edge of a switch before its state is read.
+/// Further edges in this time are ignored.
+#define SW_DEBOUNCE_MS   (20)
+
+/// Time in ms that a switch must be held for a long press
+#define SW_LONG_PRESS_MS (1000)
+
 /// Defines the type for the keys
 typedef enum
 {
@@ -45,8 +56,25 @@ typedef enum
     SW2,
 } sw_t;
 
+/// Defines the type for the switch events
+typedef enum
+{
+    SW_PRESS = 0,    ///< Switch is pressed
+    SW_RELEASE,      ///< Switch is released
+    SW_LONG_PRESS,   ///< Switch is held for SW_LONG_PRESS_MS
+} sw_event_type_t;
+
+/// Switch event
+typedef struct
+{
+    sw_t sw;               ///< Switch
+    sw_event_type_t type;  ///< Type of the event
+    TickType_t timestamp;  ///< Tick count when the event was detected
+} sw_event_t;
+
 // Function prototypes
 void sw_init(void);
 bool sw_pressed(const sw_t sw); 
+bool sw_start(QueueHandle_t queue);
 
 #endif // SWITCHES_H
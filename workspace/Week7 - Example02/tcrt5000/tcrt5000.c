@@ -34,16 +34,107 @@
 
 TaskHandle_t xADCTaskHandle;
 
+// Results of the interrupt handler, read by tcrt5000_read()
+static uint32_t results[TCRT5000_RING_LENGTH];
+static TickType_t timestamps[TCRT5000_RING_LENGTH];
+static ring_t ring;
+
+// Combines differences into results
+static filter_decimate_t decimate;
+
+#if (TCRT5000_MODE == TCRT5000_MODE_THRESHOLD) && (TCRT5000_THRESHOLD_LOW > TCRT5000_THRESHOLD_HIGH)
+  #error TCRT5000_THRESHOLD_LOW must not exceed TCRT5000_THRESHOLD_HIGH
+#endif
+
+#if (TCRT5000_MODE == TCRT5000_MODE_DMA) && (TCRT5000_DECIMATION > TCRT5000_DMA_LENGTH / 4)
+  #error TCRT5000_DECIMATION must not exceed the differences in half a DMA buffer
+#endif
+
+#if (TCRT5000_MODE == TCRT5000_MODE_DMA)
+
+// DMA destination buffer. The DMA wraps the destination address within this
+// buffer, which requires the buffer to be aligned to its size.
+static volatile uint16_t conversions[TCRT5000_DMA_LENGTH]
+    __attribute__((aligned(TCRT5000_DMA_LENGTH * sizeof(uint16_t))));
+
+// Written to PTA->PTOR by the linked DMA channel to toggle the IR LED
+static const uint32_t ir_led_toggle = (1<<16);
+
+// Number of bytes in half of the DMA buffer
+#define HALF_BYTES (TCRT5000_DMA_LENGTH * sizeof(uint16_t) / 2)
+
+// Value of DMOD for the size of the DMA buffer. DMOD = 1 selects a 16 byte
+// buffer, every next value doubles the size.
+#define DMA_DMOD   (__builtin_ctz(TCRT5000_DMA_LENGTH * sizeof(uint16_t)) - 3)
+
+#elif (TCRT5000_MODE == TCRT5000_MODE_THRESHOLD)
+
+// Local function prototypes
+static void tcrt5000_crossing(BaseType_t *pxHigherPriorityTaskWoken);
+
+#else
+
+// Local function prototypes
+static void tcrt5000_conversion(const uint16_t result, const TickType_t timestamp,
+                                BaseType_t *pxHigherPriorityTaskWoken);
+
+// Channel 8 in the scan of the ADC library. There are two conversions per
+// result, one with the IR LED off and one with the IR LED on.
+static const adc_channel_t channel =
+{
+    .channel = 8,
+    .rate = TCRT5000_SAMPLE_RATE,
+    .average = TCRT5000_AVERAGE,
+    .ring = NULL,
+    .callback = tcrt5000_conversion,
+};
+
+#endif
+
 /*!
  * \brief Initializes the TCRT5000 on the shield
  *
  * This functions initializes the TCRT5000 on the shield.
  * - PTA16 is configured as an output pin
  * - PTB0 is configured as an analog input (ADC channel 8)
- * - TPM1 is configured to trigger an ADC conversion every 50 ms
+ * - In interrupt mode, channel 8 is added to the scan of the ADC library
+ *   with a rate of TCRT5000_SAMPLE_RATE conversions per second
+ * - In DMA and threshold mode, ADC0 is claimed and TPM1 is configured to
+ *   trigger an ADC conversion TCRT5000_SAMPLE_RATE times per second
+ * - Every conversion is the hardware average of TCRT5000_AVERAGE
+ *   conversions
+ * - In DMA mode, DMA channel 0 transfers the conversions into a circular
+ *   buffer and DMA channel 1, linked to channel 0, toggles the IR LED after
+ *   every conversion
+ * - In threshold mode, the IR LED is on and the compare function of the ADC
+ *   is enabled
+ *
+ * In interrupt and DMA mode, TCRT5000_DECIMATION differences (IR LED on
+ * minus off) are combined into one result. In threshold mode, the level at a
+ * crossing of the hysteresis band is the result. Every result is stored in
+ * a ring, and xADCTaskHandle is notified with TCRT5000_NOTIFY_BIT. In DMA
+ * mode, the task is notified once for the results of half a DMA buffer. The
+ * results are read with tcrt5000_read().
  */
 void tcrt5000_init(void)
 {
+    ring_init(&ring, results, timestamps, sizeof(results[0]), TCRT5000_RING_LENGTH);
+    ring_policy(&ring, TCRT5000_OVERRUN_POLICY);
+
+    // The shift of the sum is log2(TCRT5000_DECIMATION) - TCRT5000_EXTRA_BITS
+    filter_decimate_init(&decimate, TCRT5000_DECIMATION,
+                         __builtin_ctz(TCRT5000_DECIMATION) - TCRT5000_EXTRA_BITS);
+
+#if (TCRT5000_MODE == TCRT5000_MODE_DMA)
+    // Notify once per half of the DMA buffer, or when the ring is full if it
+    // is smaller
+    const uint32_t per_half = (TCRT5000_DMA_LENGTH / 4) / TCRT5000_DECIMATION;
+    ring_notify(&ring, xADCTaskHandle, TCRT5000_NOTIFY_BIT,
+                (per_half < TCRT5000_RING_LENGTH) ? per_half : TCRT5000_RING_LENGTH);
+#else
+    ring_notify(&ring, xADCTaskHandle, TCRT5000_NOTIFY_BIT, 1);
+#endif
+
     // ------------------------------------------------------------------------
 
     // Enable clock to PORTs
@@ -55,8 +146,13 @@ void tcrt5000_init(void)
     PORTA->PCR[16] |= PORT_PCR_MUX(1) | PORT_PCR_PE(1);
     PTA->PDDR |= (1<<16);
 
+#if (TCRT5000_MODE == TCRT5000_MODE_THRESHOLD)
+    // IR LED on
+    PTA->PCOR = (1<<16);
+#else
     // IR LED off
     PTA->PSOR = (1<<16);
+#endif
 
     // The output of the transistor is connected to PTB0. Configure the pin as
     // ADC input pin (channel 8).
@@ -64,19 +160,41 @@ void tcrt5000_init(void)
 
     // ------------------------------------------------------------------------
 
-    // Enable clock to ADC0
-    SIM->SCGC6 |= SIM_SCGC6_ADC0(1);
+#if (TCRT5000_MODE == TCRT5000_MODE_INTERRUPT)
+    // The scan converts the channel and calls tcrt5000_conversion() with
+    // every result
+    adc_scan_add(&channel);
+    adc_scan_start();
+#else
+#if (TCRT5000_MODE == TCRT5000_MODE_DMA)
+    // Conversions are handled by DMA
+    adc_claim(NULL);
+#else
+    adc_claim(tcrt5000_crossing);
+#endif
+
+    // Enable clock to ADC0 and select 16-bit single-ended conversions
+    adc_init();
 
-    // Configure ADC
-    // - ADLPC = 1        : Low-power configuration. The power is reduced at
-    //                      the expense of maximum clock speed.
-    // - ADIV[1:0] = 00   : The divide ratio is 1 and the clock rate is input
-    //                      clock.
-    // - ADLSMP = 1       : Long sample time.
-    // - MODE[1:0] = 11   : Single-ended 16-bit conversion
-    // - ADICLK[1:0] = 01 : (Bus clock)/2
-    ADC0->CFG1 = 0x9D;
+    // Hardware averaging
+    adc_average(TCRT5000_AVERAGE);
 
+#if (TCRT5000_MODE == TCRT5000_MODE_DMA)
+    // - ADTRG = 1   : Hardware trigger selected
+    // - ACFE  = 0   : Compare function disabled
+    // - DMAEN = 1   : DMA request on conversion complete
+    // - REFSEL = 00 : Default voltage reference pin pair
+    ADC0->SC2 = ADC_SC2_ADTRG(1) | ADC_SC2_DMAEN(1);
+
+    // - AIEN = 0     : Conversion complete interrupt is disabled
+    // - DIFF = 0     : Single-ended conversions and input channels are
+    //                  selected
+    // - ADCH = 01000 : Channel 8
+    ADC0->SC1[0] = ADC_SC1_ADCH(8);
+#else
+    // The compare function is enabled by tcrt5000_crossing() after the
+    // first conversion.
+    //
     // - ADTRG = 1   : Hardware trigger selected
     // - ACFE  = 0   : Compare function disabled
     // - DMAEN = 0   : DMA is disabled
@@ -88,6 +206,48 @@ void tcrt5000_init(void)
     //                  selected
     // - ADCH = 01000 : Channel 8
     ADC0->SC1[0] = ADC_SC1_AIEN(1) | ADC_SC1_ADCH(8);
+#endif
+
+#if (TCRT5000_MODE == TCRT5000_MODE_DMA)
+    // ------------------------------------------------------------------------
+
+    // Enable clock to DMA and DMAMUX
+    SIM->SCGC7 |= SIM_SCGC7_DMA(1);
+    SIM->SCGC6 |= SIM_SCGC6_DMAMUX(1);
+
+    // Channel 0 is requested by the ADC0 conversion complete (source 40)
+    DMAMUX0->CHCFG[0] = 0;
+    DMAMUX0->CHCFG[0] = DMAMUX_CHCFG_ENBL(1) | DMAMUX_CHCFG_SOURCE(40);
+
+    // Channel 0 copies ADC0->R[0] to the buffer, one half at a time
+    DMA0->DMA[0].SAR = (uint32_t)&ADC0->R[0];
+    DMA0->DMA[0].DAR = (uint32_t)conversions;
+    DMA0->DMA[0].DSR_BCR = DMA_DSR_BCR_BCR(HALF_BYTES);
+
+    // Channel 1 writes the toggle mask to PTA->PTOR. The byte count is
+    // restored by the interrupt handler, so it never runs out.
+    DMA0->DMA[1].SAR = (uint32_t)&ir_led_toggle;
+    DMA0->DMA[1].DAR = (uint32_t)&PTA->PTOR;
+    DMA0->DMA[1].DSR_BCR = DMA_DSR_BCR_BCR(TCRT5000_DMA_LENGTH * sizeof(uint32_t));
+
+    // - SSIZE = 00 : 32-bit source
+    // - DSIZE = 00 : 32-bit destination
+    // - CS = 1     : Single transfer per link
+    DMA0->DMA[1].DCR = DMA_DCR_CS(1) | DMA_DCR_SSIZE(0) | DMA_DCR_DSIZE(0);
+
+    // - EINT = 1     : Interrupt when a half is full
+    // - ERQ = 1      : Enable peripheral requests
+    // - CS = 1       : Single transfer per request
+    // - SSIZE = 10   : 16-bit source
+    // - DINC = 1     : Increment destination
+    // - DSIZE = 10   : 16-bit destination
+    // - DMOD         : Destination wraps within the buffer
+    // - LINKCC = 10  : Link to LCH1 after every transfer
+    // - LCH1 = 01    : Channel 1
+    DMA0->DMA[0].DCR = DMA_DCR_EINT(1) | DMA_DCR_ERQ(1) | DMA_DCR_CS(1) |
+        DMA_DCR_SSIZE(2) | DMA_DCR_DINC(1) | DMA_DCR_DSIZE(2) |
+        DMA_DCR_DMOD(DMA_DMOD) | DMA_DCR_LINKCC(2) | DMA_DCR_LCH1(1);
+#endif
 
     // ------------------------------------------------------------------------
 
@@ -97,8 +257,9 @@ void tcrt5000_init(void)
     // Divide by 128 Prescale Factor
     TPM1->SC |= TPM_SC_PS(0b111);
 
-    // (48 MHz / 128 ) / 20 Hz = 18750
-    TPM1->MOD = (18750-1);
+    // (48 MHz / 128 ) / 1000 Hz = 375
+    // (48 MHz / 128 ) / 2500 Hz = 150
+    TPM1->MOD = ((48000000 / 128) / TCRT5000_SAMPLE_RATE) - 1;
 
     // Counter increments on every LPTPM counter clock
     TPM1->SC |= TPM_SC_CMOD(1);
@@ -114,56 +275,196 @@ void tcrt5000_init(void)
     // ------------------------------------------------------------------------
 
     // Enable the interrupt in the NVIC
+#if (TCRT5000_MODE == TCRT5000_MODE_DMA)
+    NVIC_SetPriority(DMA0_IRQn, 128);
+    NVIC_ClearPendingIRQ(DMA0_IRQn);
+    NVIC_EnableIRQ(DMA0_IRQn);
+#else
     NVIC_SetPriority(ADC0_IRQn, 128);
     NVIC_ClearPendingIRQ(ADC0_IRQn);
     NVIC_EnableIRQ(ADC0_IRQn);
+#endif
+#endif
+}
+
+/*!
+ * \brief Reads the results, oldest first
+ *
+ * If the task doesn't keep up with the results, the ring fills up and
+ * results are dropped according to TCRT5000_OVERRUN_POLICY.
+ *
+ * \param[out] results     Storage for n results
+ * \param[out] timestamps  Storage for n timestamps, or NULL
+ * \param[in]  n           Maximum number of results
+ *
+ * \return Number of results read
+ */
+uint32_t tcrt5000_read(uint32_t results[], TickType_t timestamps[], const uint32_t n)
+{
+    return ring_pop(&ring, results, timestamps, n);
+}
+
+/*!
+ * \brief Returns the number of results dropped because the ring was full
+ *
+ * \return Number of results dropped since tcrt5000_init()
+ */
+uint32_t tcrt5000_overruns(void)
+{
+    return ring_overruns(&ring);
 }
 
-void ADC0_IRQHandler(void)
+#if (TCRT5000_MODE == TCRT5000_MODE_DMA)
+
+void DMA0_IRQHandler(void)
 {
     // Clear pending interrupt
-    NVIC_ClearPendingIRQ(ADC0_IRQn);
+    NVIC_ClearPendingIRQ(DMA0_IRQn);
+
+    // The conversion that completed the half was taken now. Get the time
+    // before the results are calculated.
+    const TickType_t now = xTaskGetTickCountFromISR();
 
-    // Clear the flag
-    TPM1->STATUS = TPM_STATUS_TOF(1);
+    // Clear the done flag and restart both channels for the next half. The
+    // next conversion is at least one sample period away.
+    DMA0->DMA[0].DSR_BCR = DMA_DSR_BCR_DONE(1);
+    DMA0->DMA[0].DSR_BCR = DMA_DSR_BCR_BCR(HALF_BYTES);
+    DMA0->DMA[1].DSR_BCR = DMA_DSR_BCR_DONE(1);
+    DMA0->DMA[1].DSR_BCR = DMA_DSR_BCR_BCR(TCRT5000_DMA_LENGTH * sizeof(uint32_t));
 
-    static volatile bool ir_led_is_on = false;
-    static volatile uint32_t on_brightness;
-    static volatile uint32_t off_brightness;
+    static uint32_t half = 0;
+    volatile uint16_t *p = &conversions[half * (TCRT5000_DMA_LENGTH / 2)];
+    half ^= 1;
 
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    BaseType_t xResult;
 
-    if(ir_led_is_on)
+    // The IR LED is off during the even conversions and on during the odd
+    // conversions, because the IR LED was off before the first conversion
+    // and is toggled after every conversion.
+    const uint32_t n = TCRT5000_DMA_LENGTH / 4;
+    int32_t differences[TCRT5000_DMA_LENGTH / 4];
+
+    for(uint32_t i=0; i<n; i++)
     {
-        // Get conversion and complement the result
-        on_brightness = 0xFFFF - ADC0->R[0];
+        // Complement the conversions and take the difference
+        uint32_t off_brightness = 0xFFFF - p[2*i];
+        uint32_t on_brightness = 0xFFFF - p[2*i+1];
+        differences[i] = (int32_t)(on_brightness - off_brightness);
+    }
 
+    // A half holds a whole number of groups, so result j ends with
+    // difference (j+1) * TCRT5000_DECIMATION - 1. The results are timestamped
+    // relative to the last result.
+    const uint32_t m = filter_decimate(&decimate, differences, differences, n);
+    const uint32_t period_us = (2000000 / TCRT5000_SAMPLE_RATE) * TCRT5000_DECIMATION;
+    const uint32_t tick_us = 1000000 / configTICK_RATE_HZ;
+
+    for(uint32_t j=0; j<m; j++)
+    {
+        uint32_t result = (uint32_t)differences[j];
+        TickType_t timestamp = now - ((m - 1 - j) * period_us) / tick_us;
+
+        ring_push_from_isr(&ring, &result, timestamp, &xHigherPriorityTaskWoken);
+    }
+
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+#elif (TCRT5000_MODE == TCRT5000_MODE_THRESHOLD)
+
+/*!
+ * \brief Handles a completed conversion, called from the ADC0 interrupt
+ *
+ * \param[out] pxHigherPriorityTaskWoken  Set if a task must be yielded to
+ */
+static void tcrt5000_crossing(BaseType_t *pxHigherPriorityTaskWoken)
+{
+    static bool first = true;
+    static bool above = false;
+
+    // Get conversion and complement the result
+    uint32_t brightness = 0xFFFF - ADC0->R[0];
+
+    // Apply the hysteresis. The first conversion is taken without the
+    // compare function and determines the initial level.
+    bool level = above;
+
+    if(brightness >= TCRT5000_THRESHOLD_HIGH)
+    {
+        level = true;
+    }
+    else if(brightness < TCRT5000_THRESHOLD_LOW)
+    {
+        level = false;
+    }
+
+    if(first || (level != above))
+    {
+        ring_push_from_isr(&ring, &brightness, xTaskGetTickCountFromISR(),
+                           pxHigherPriorityTaskWoken);
+    }
+
+    first = false;
+    above = level;
+
+    // Only complete the next conversion when the level crosses the other
+    // side of the band. The result register holds the complemented level.
+    if(above)
+    {
+        // brightness < TCRT5000_THRESHOLD_LOW
+        adc_compare(ADC_COMPARE_GREATER_EQUAL, 0x10000 - TCRT5000_THRESHOLD_LOW);
+    }
+    else
+    {
+        // brightness >= TCRT5000_THRESHOLD_HIGH
+        adc_compare(ADC_COMPARE_LESS, 0x10000 - TCRT5000_THRESHOLD_HIGH);
+    }
+}
+
+#else
+
+/*!
+ * \brief Handles a conversion of the scan, called from the ADC0 interrupt
+ *
+ * \param[in]  result                     Conversion
+ * \param[in]  timestamp                  Tick count of the conversion
+ * \param[out] pxHigherPriorityTaskWoken  Set if a task must be yielded to
+ */
+static void tcrt5000_conversion(const uint16_t result, const TickType_t timestamp,
+                                BaseType_t *pxHigherPriorityTaskWoken)
+{
+    static bool ir_led_is_on = false;
+    static uint32_t off_brightness;
+
+    // Complement the result
+    uint32_t brightness = 0xFFFF - result;
+
+    if(ir_led_is_on)
+    {
         // IR LED off
         PTA->PSOR = (1<<16);
         ir_led_is_on = false;
 
-        // Send a notification, and the ADC conversion result, directly to
-        // vADCTask()
-        xResult = xTaskNotifyFromISR(xADCTaskHandle,
-                                     on_brightness - off_brightness,
-                                     eSetValueWithoutOverwrite,
-                                     &xHigherPriorityTaskWoken );
-
-        // If the call to xTaskNotifyFromISR() doesn't return pdPASS then the
-        // vADCTask is not keeping up with the rate at which ADC values are
-        // being generated
-        configASSERT(xResult == pdPASS);
+        // Store the result and notify vADCTask(). If the ring is full, the
+        // task is not keeping up with the rate at which ADC values are being
+        // generated and a result is dropped.
+        int32_t difference = (int32_t)(brightness - off_brightness);
+        int32_t decimated;
 
-        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+        if(filter_decimate(&decimate, &difference, &decimated, 1) == 1)
+        {
+            ring_push_from_isr(&ring, &decimated, timestamp,
+                               pxHigherPriorityTaskWoken);
+        }
     }
     else
     {
-        // Get conversion and complement the result
-        off_brightness = 0xFFFF - ADC0->R[0];
+        off_brightness = brightness;
 
         // IR LED on
         PTA->PCOR = (1<<16);
         ir_led_is_on = true;
     }
 }
+
+#endif
@@ -36,9 +36,108 @@
 #include "FreeRTOS.h"
 #include "semphr.h"
 
+#include "adc.h"
+#include "filter.h"
+#include "ring.h"
+
+// Modes of the driver
+// - TCRT5000_MODE_INTERRUPT: every conversion is handled in the ADC interrupt.
+//                            The channel is part of the scan of the ADC
+//                            library, so ADC0 can be shared with other
+//                            sensors. TCRT5000_SAMPLE_RATE must divide
+//                            ADC_SCAN_CLOCK.
+// - TCRT5000_MODE_DMA:       conversions are transferred to a buffer by DMA,
+//                            so the interrupt rate doesn't grow with the
+//                            sample rate
+// - TCRT5000_MODE_THRESHOLD: the IR LED is on continuously and the ADC
+//                            compare function only completes a conversion
+//                            when the level crosses the hysteresis band, so
+//                            there is one interrupt and result per crossing.
+//                            Ambient light is not subtracted in this mode.
+// In DMA and threshold mode the driver claims ADC0 and TPM1 exclusively, so
+// no other driver can use the scan of the ADC library.
+#define TCRT5000_MODE_INTERRUPT (0)
+#define TCRT5000_MODE_DMA       (1)
+#define TCRT5000_MODE_THRESHOLD (2)
+
+#ifndef TCRT5000_MODE
+#define TCRT5000_MODE        (TCRT5000_MODE_DMA)
+#endif
+
+// Number of conversions per second. In interrupt and DMA mode, every result
+// takes two conversions, one with the IR LED off and one with the IR LED on.
+#ifndef TCRT5000_SAMPLE_RATE
+#if (TCRT5000_MODE == TCRT5000_MODE_DMA)
+#define TCRT5000_SAMPLE_RATE (2500)
+#elif (TCRT5000_MODE == TCRT5000_MODE_THRESHOLD)
+#define TCRT5000_SAMPLE_RATE (1000)
+#else
+#define TCRT5000_SAMPLE_RATE (20)
+#endif
+#endif
+
+// Hysteresis band of the threshold mode. A result is delivered when the
+// level rises to TCRT5000_THRESHOLD_HIGH or more, and when it falls below
+// TCRT5000_THRESHOLD_LOW.
+#ifndef TCRT5000_THRESHOLD_LOW
+#define TCRT5000_THRESHOLD_LOW  (1800)
+#endif
+
+#ifndef TCRT5000_THRESHOLD_HIGH
+#define TCRT5000_THRESHOLD_HIGH (2200)
+#endif
+
+// Number of conversions that ADC0 averages in hardware after every trigger
+#ifndef TCRT5000_AVERAGE
+#define TCRT5000_AVERAGE     (ADC_AVERAGE_4)
+#endif
+
+// Number of differences that the decimation stage combines into one result,
+// in interrupt and DMA mode. TCRT5000_EXTRA_BITS is the number of bits that
+// the results gain, at most log2(TCRT5000_DECIMATION) / 2. With 0 the result
+// is the mean and has the scale of a single difference.
+#ifndef TCRT5000_DECIMATION
+#if (TCRT5000_MODE == TCRT5000_MODE_DMA)
+#define TCRT5000_DECIMATION  (4)
+#else
+#define TCRT5000_DECIMATION  (1)
+#endif
+#endif
+
+#ifndef TCRT5000_EXTRA_BITS
+#define TCRT5000_EXTRA_BITS  (0)
+#endif
+
+// Number of conversions in the DMA buffer, a power of two from 8 to 64. The
+// DMA interrupt occurs when either half of the buffer is full.
+#define TCRT5000_DMA_LENGTH  (64)
+
+// Number of results the ring can hold, a power of two. The default can hold
+// the results of both halves of the DMA buffer.
+#ifndef TCRT5000_RING_LENGTH
+#define TCRT5000_RING_LENGTH (32)
+#endif
+
+// What happens to a result when the ring is full, because vADCTask() doesn't
+// keep up
+// - RING_DROP_OLDEST: the oldest result is overwritten, so the task reads the
+//                     latest results when it catches up. With
+//                     TCRT5000_RING_LENGTH 1 only the latest result is kept.
+// - RING_DROP_NEWEST: the new result is dropped, so the task reads the
+//                     results from before the overrun
+// Either way the dropped results are counted, see tcrt5000_overruns().
+#ifndef TCRT5000_OVERRUN_POLICY
+#define TCRT5000_OVERRUN_POLICY (RING_DROP_OLDEST)
+#endif
+
+// Notification bit that is set in xADCTaskHandle when a result is available
+#define TCRT5000_NOTIFY_BIT  (1 << 0)
+
 extern TaskHandle_t xADCTaskHandle;
 
 // Function prototypes
 void tcrt5000_init(void);
+uint32_t tcrt5000_read(uint32_t results[], TickType_t timestamps[], const uint32_t n);
+uint32_t tcrt5000_overruns(void);
 
 #endif // TCRT5000_H